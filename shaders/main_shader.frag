@@ -32,6 +32,7 @@ out uint fs_edgeable_id;
     in vec2 vs_tex_coords;
     #if EDGEABLE_IDS
         flat in uint vs_edgeable_id;
+        flat in vec3 vs_normal;		//normal of the surface, stored in the vertices of the edgeable entities (e.g. roofs)
     #endif
 #endif
 
@@ -45,7 +46,8 @@ out uint fs_edgeable_id;
 
 // Position of the light source
 uniform vec3 u_light_position;
-// Indicate the normal of the surface, useful to compute the diffuse lighting (it's only used with roofs now).
+// Indicate the normal of the surface, useful to compute the diffuse lighting. It's ignored by the edgeable entities, whose normal
+// is a vertex attribute.
 uniform vec3 u_frag_normal;
 
 
@@ -66,7 +68,11 @@ vec4 show_LOD(vec4 color);
 void main()
 {
     float ambient_lighting = 0.2;
-    float diffuse_lighting = dot( normalize(u_frag_normal), normalize(u_light_position) );
+    #if EDGEABLE_IDS && !TILE_SHADER
+        float diffuse_lighting = dot( normalize(vs_normal), normalize(u_light_position) );
+    #else
+        float diffuse_lighting = dot( normalize(u_frag_normal), normalize(u_light_position) );
+    #endif
 
     #if TILE_SHADER && GSET_TILESET_TEXARRAY
         fs_textured_frag_color = texture(u_texture, vec3(vs_tex_coords, vs_layer));
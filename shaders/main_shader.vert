@@ -14,6 +14,7 @@
     layout(location = 2) in uint VAO_entity_id;
     #if EDGEABLE_IDS
         layout(location = 3) in uint VAO_edgeable_id;
+        layout(location = 4) in vec3 VAO_normal;
     #endif
 #endif
 
@@ -27,6 +28,7 @@
     out vec2 vs_tex_coords;
     #if EDGEABLE_IDS
         flat out uint vs_edgeable_id;
+        flat out vec3 vs_normal;
     #endif
 #endif
 
@@ -46,5 +48,6 @@ void main()
 
     #if EDGEABLE_IDS
         vs_edgeable_id = VAO_edgeable_id;
+        vs_normal = VAO_normal;
     #endif
 }
\ No newline at end of file
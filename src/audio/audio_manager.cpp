@@ -62,8 +62,10 @@ void AudioDevice::start()
     }
 }
 
-AudioManager::AudioManager()
+AudioManager::AudioManager(bool const enabled)
 {
+    if (!enabled) { return; }
+
     auto result = ma_engine_init(NULL, &m_engine);
     if (result != MA_SUCCESS) 
     {
@@ -85,6 +87,8 @@ AudioManager::~AudioManager()
 
 void AudioManager::reproduce_sound(char const* filename)
 {
+    if (!m_is_engine_init) { return; }
+
     if (ma_engine_play_sound(&m_engine, filename, NULL) != MA_SUCCESS)
     {
         g_log << "Failed to reproduce a sound - File address: " << filename << std::endl;
@@ -107,6 +111,8 @@ static void data_callback(ma_device* pDevice, void* pOutput, const void* pInput,
 
 void AudioManager::reproduce_sound_loop(char const* filename)
 {
+    if (!m_is_engine_init) { return; }
+
     m_decoders.emplace_back(filename);
     auto & decoder = m_decoders.back();
     
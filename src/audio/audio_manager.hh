@@ -48,7 +48,10 @@ class AudioDevice
 class AudioManager
 {
     public:
-        AudioManager();
+        ////
+        //	@enabled: If false, no audio device is opened and every sound is discarded (e.g. for the headless simulation runs).
+        ////
+        explicit AudioManager(bool const enabled = true);
         AudioManager(AudioManager const&) = delete;
         AudioManager& operator=(AudioManager const&) = delete;
         ~AudioManager();
@@ -0,0 +1,84 @@
+#ifndef GM_CHANGED_SLOT_RANGES_HH
+#define GM_CHANGED_SLOT_RANGES_HH
+
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "data_strctures/slot_manager.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//
+//	Record the slots of a SlotManager-based container that changed since the last flush, so that only those slots are uploaded
+//	to the GPU. Consecutive changes usually hit consecutive slots (e.g. the triangles of a new polygon), so they are stored as ranges.
+//
+////
+class ChangedSlotRanges
+{
+    public:
+        using SlotRange = std::pair<SlotId, SlotId>;	//range of slots [first, second)
+
+        bool empty() const noexcept { return m_ranges.empty(); }
+
+        void clear() noexcept { m_ranges.clear(); }
+
+        void mark(SlotId const slot)
+        {
+            if (!m_ranges.empty())
+            {
+                auto & last = m_ranges.back();
+
+                if (slot >= last.first && slot <= last.second)
+                {
+                    last.second = std::max(last.second, slot + 1);
+                    return;
+                }
+            }
+
+            m_ranges.push_back({ slot, slot + 1 });
+        }
+
+        ////
+        //	@max_gap: Two ranges separated by less than @max_gap slots are merged. Uploading a few unchanged slots is cheaper than
+        //			  issuing a further glBufferSubData call.
+        //
+        //	@return: The changed ranges, sorted and without overlaps.
+        ////
+        auto merged(SlotId const max_gap) const -> std::vector<SlotRange>
+        {
+            auto sorted_ranges = m_ranges;
+            std::sort(sorted_ranges.begin(), sorted_ranges.end());
+
+            auto merged_ranges = std::vector<SlotRange>{};
+            for (auto const& range : sorted_ranges)
+            {
+                if (!merged_ranges.empty() && range.first <= merged_ranges.back().second + max_gap)
+                {
+                    merged_ranges.back().second = std::max(merged_ranges.back().second, range.second);
+                }
+                else
+                {
+                    merged_ranges.push_back(range);
+                }
+            }
+
+            return merged_ranges;
+        }
+
+    private:
+        std::vector<SlotRange> m_ranges;		//in order of change
+};
+
+
+
+} // namespace tgm
+
+
+#endif //GM_CHANGED_SLOT_RANGES_HH
\ No newline at end of file
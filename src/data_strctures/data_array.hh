@@ -2,16 +2,21 @@
 #define GM_DATA_ARRAY_HH
 
 
+#include <algorithm>
 #include <cstdint>
 #include <fstream>
 #include <limits>
 #include <memory>
 #include <iomanip>
 #include <iterator>
+#include <optional>
 #include <sstream>
 #include <type_traits>
+#include <unordered_set>
 #include <vector>
 
+#include "data_strctures/occupancy_bitmap.hh"
+#include "data_strctures/paged_vector.hh"
 #include "io/std/vector_io.hh"
 #include "settings/debug/debug_settings.hh"
 
@@ -42,6 +47,18 @@ using DataArrayConstIterator = DataArrayIterImpl<T, Resizable, true>;
 
 namespace detail
 {
+    ////
+    //	Detect whether T records its own changes (i.e. it has begin_transaction(), commit_transaction() and rollback_transaction()).
+    ////
+    template<typename T, typename = void>
+    struct has_transactions : std::false_type {};
+
+    template<typename T>
+    struct has_transactions<T, std::void_t<decltype(std::declval<T &>().begin_transaction()), 
+                                           decltype(std::declval<T &>().commit_transaction()), 
+                                           decltype(std::declval<T &>().rollback_transaction())>> : std::true_type {};
+
+
     template<typename T>
     class DataArrayEl
     {
@@ -137,10 +154,45 @@ namespace tgm
 
 
 
+////
+//	Map the ids of the elements moved by DataArray::compact() to their new ids.
+////
+class DataArrayRemap
+{
+    public:
+        ////
+        //	@return: The new id of the element identified by @old_id, or @old_id itself if the element wasn't moved.
+        ////
+        auto operator()(DataArrayId const old_id) const -> DataArrayId
+        {
+            auto const it = std::lower_bound(m_moves.cbegin(), m_moves.cend(), old_id, [](auto const& move, DataArrayId const id) { return move.first < id; });
+
+            return it != m_moves.cend() && it->first == old_id ? it->second : old_id;
+        }
+
+        ////
+        //	Indicate whether no element has been moved (i.e. all the ids are still valid).
+        ////
+        bool empty() const noexcept { return m_moves.empty(); }
+        auto moved_count() const noexcept { return m_moves.size(); }
+
+        auto moves() const noexcept -> std::vector<std::pair<DataArrayId, DataArrayId>> const& { return m_moves; }
+
+
+    private:
+        std::vector<std::pair<DataArrayId, DataArrayId>> m_moves;	//pairs (old id, new id) sorted by old id
+
+    template <typename T, bool Resizable>
+    friend class DataArray;
+};
+
+
+
 ////
 //	@T: must be copy-constructible and copy-assignable.
 //	@Resizable: Indicate whether the DataArray is allowed to automatically increase the allocated memory when the initial
-//				size is reached.
+//				size is reached. A Resizable DataArray stores its elements in pages (see PagedVector), so growing never moves
+//				the elements: the references returned by create() and get() stay valid until the element is destroyed.
 ////
 template<typename T, bool Resizable = false>
 class DataArray
@@ -148,17 +200,23 @@ class DataArray
     public:
         using size_type = uint32_t;
         using DataArrayEl = detail::DataArrayEl<T>;
+        using Storage = std::conditional_t<Resizable, PagedVector<DataArrayEl>, std::vector<DataArrayEl>>;
         
         ////
         //	@max_size: The maximum number of elements that this DataArray can hold. If the DataArray is Resizable,
         //			   then it represents only the initial allocated memory, but the maximum size is automatically 
-        //			   increased if needed.
+        //			   increased if needed (one page of @max_size elements at a time).
         ////
         DataArray(size_type const max_size)
         {
             static_assert(std::is_copy_constructible_v<T>, "DataArray requires T to be copy-constructible.");
             static_assert(std::is_copy_assignable_v<T>, "DataArray requires T to be copy-assignable.");
 
+            if constexpr (Resizable)
+            {
+                m_vec = Storage{ max_size };
+            }
+
             set_maxSize(max_size);
         }
 
@@ -190,9 +248,10 @@ class DataArray
                 ++m_max_used;
                 DataArrayId new_id = m_max_used - 1; //conversion from size_type to DataArrayId
                 new_id |= UINT64_C(0x0000000080000000); //version is set to 1
-                m_vec.emplace_back(new_id, std::forward<Ts>(args)...);
+                el = &m_vec.emplace_back(new_id, std::forward<Ts>(args)...);
+                m_occupancy.set(m_max_used - 1);
 
-                el = &m_vec.back();
+                if (m_transaction) { log_change(UndoType::appended, m_max_used - 1); }
             }
             else
             {
@@ -201,9 +260,12 @@ class DataArray
 
                 el = &m_vec[free_slot];
 
+                if (m_transaction) { log_change(UndoType::recycled, free_slot); }
+
                 // nullify leftmost bit (that indicate a free state)  ---  id version was already changed in DataArray::destroy
                 el->m_id = el->m_id & UINT64_C(0x7FFFFFFFFFFFFFFF);
                 el->value = T{ std::forward<Ts>(args)... };
+                m_occupancy.set(free_slot);
             }
 
             ++m_count;
@@ -219,6 +281,8 @@ class DataArray
                 assert_idValidity(id);
             #endif
 
+            if (m_transaction) { log_modification(slot(id)); }
+
             return m_vec[slot(id)].value;
         }
 
@@ -247,6 +311,8 @@ class DataArray
 
             if (el.m_id == id)  // Compare free status, version and slot. To be precise one should also verify that !is_free(el.id), 
             {				  // but if the version match that would be a rare case.
+                if (m_transaction) { log_modification(slot(id)); }
+
                 return &el.value;
             }
             else
@@ -286,6 +352,8 @@ class DataArray
 
             if (el.m_id == id)  // Compare free status, version and slot. To be precise one should also verify that !is_free(el.id), 
             {				    // but if the version match that would be a rare case.
+                if (m_transaction) { log_modification(slot(id)); }
+
                 return el.value;
             }
             else
@@ -338,15 +406,145 @@ class DataArray
             }
             #pragma warning(default: 4702)
 
+            if (m_transaction) { log_change(UndoType::destroyed, slot(id)); }
+
             el.m_id = setFree_and_increaseVersion(el.m_id);
 
             m_free.push_back(slot(id));
+            m_occupancy.reset(slot(id));
 
             --m_count;
 
             return true;
         }
 
+        ////
+        //	Move the active elements into the lowest slots, so that they are stored in a dense prefix. The moved elements change id:
+        //	their old ids expire and the returned remap must be applied to every copy of them held elsewhere.
+        //	The freed slots keep their versions (the expired ids can't become valid again), so no memory is released.
+        //	Note: It invalidates the references to the moved elements.
+        ////
+        auto compact() -> DataArrayRemap
+        {
+            if (m_transaction) { throw std::runtime_error("A DataArray cannot be compacted during a transaction."); }
+
+            auto remap = DataArrayRemap{};
+
+            auto dst = m_occupancy.next_free(0, m_max_used);
+            auto src = m_occupancy.prev_occupied(m_max_used);
+
+            while (src != m_max_used && dst < src)
+            {
+                auto & dst_el = m_vec[dst];
+                auto & src_el = m_vec[src];
+
+                // The destination slot is recycled like in create(): its version was already increased by destroy().
+                auto const new_id = dst_el.m_id & UINT64_C(0x7FFFFFFFFFFFFFFF);
+
+                remap.m_moves.push_back({ src_el.m_id, new_id });
+
+                dst_el.m_id = new_id;
+                dst_el.value = std::move(src_el.value);
+                m_occupancy.set(dst);
+
+                src_el.m_id = setFree_and_increaseVersion(src_el.m_id);
+                m_occupancy.reset(src);
+
+                dst = m_occupancy.next_free(dst + 1, m_max_used);
+                src = m_occupancy.prev_occupied(src);
+            }
+
+            //--- Rebuild the free list so that the lowest slots are recycled first
+            m_free.clear();
+            for (auto s = m_max_used; s > m_count; --s)
+            {
+                m_free.push_back(s - 1);
+            }
+
+            std::sort(remap.m_moves.begin(), remap.m_moves.end());
+
+            return remap;
+        }
+
+        ////
+        //	Start recording the changes in an undo log, so that rollback_transaction() can revert them in a time proportional to the
+        //	number of elements touched. An element is copied the first time it's accessed through a non-const method (get(), weak_get(),
+        //	get_or_throw() or a non-const iterator), so the references obtained before the transaction mustn't be used to modify it.
+        //	If T has its own transactions, the element isn't copied: a transaction of the element is started instead, and it's committed
+        //	or rolled back together with this one.
+        ////
+        void begin_transaction()
+        {
+            #if DYNAMIC_ASSERTS
+                if (m_transaction) { throw std::runtime_error("The DataArray is already in a transaction."); }
+            #endif
+
+            m_transaction = true;
+        }
+
+        ////
+        //	Keep the changes made since begin_transaction().
+        ////
+        void commit_transaction() noexcept
+        {
+            if constexpr (detail::has_transactions<T>::value)
+            {
+                for (auto const& entry : m_undo_log)
+                {
+                    if (entry.type == UndoType::modified) { m_vec[entry.slot].value.commit_transaction(); }
+                }
+            }
+
+            m_transaction = false;
+            m_undo_log.clear();
+            m_logged_slots.clear();
+        }
+
+        ////
+        //	Revert the changes made since begin_transaction(): the DataArray gets back to the same state, ids and versions included.
+        ////
+        void rollback_transaction()
+        {
+            for (auto it = m_undo_log.rbegin(); it != m_undo_log.rend(); ++it)
+            {
+                auto & el = m_vec[it->slot];
+
+                switch (it->type)
+                {
+                    case UndoType::appended:
+                        m_vec.pop_back();
+                        --m_max_used;
+                        m_occupancy.reset(it->slot);
+                        --m_count;
+                        break;
+
+                    case UndoType::recycled:
+                        el.m_id = it->id;
+                        if (it->value) { el.value = std::move(*it->value); }
+                        m_free.push_back(it->slot);
+                        m_occupancy.reset(it->slot);
+                        --m_count;
+                        break;
+
+                    case UndoType::destroyed:
+                        el.m_id = it->id;
+                        m_free.pop_back();	// The slot was pushed by destroy(), the later pushes have already been reverted
+                        m_occupancy.set(it->slot);
+                        ++m_count;
+                        break;
+
+                    case UndoType::modified:
+                        if constexpr (detail::has_transactions<T>::value) { el.value.rollback_transaction(); }
+                        else { el.value = std::move(*it->value); }
+                        break;
+                }
+            }
+
+            commit_transaction();
+        }
+
+        bool in_transaction() const noexcept { return m_transaction; }
+
         auto begin() noexcept -> DataArrayIterator<T, Resizable>;
         auto end() noexcept -> DataArrayIterator<T, Resizable>;
         auto begin() const noexcept -> DataArrayConstIterator<T, Resizable>;
@@ -368,7 +566,7 @@ class DataArray
         bool empty() const noexcept { return m_count == 0; }
         auto max_size() const noexcept -> size_type { return m_max_size; }
 
-        auto debug_internalVec() -> std::vector<DataArrayEl>& { return m_vec; }
+        auto debug_internalVec() -> Storage & { return m_vec; }
         auto debug_vecSize() { return m_vec.size(); }
         void debug_setVersion(DataArrayId & id, size_type new_version)
         {
@@ -386,13 +584,59 @@ class DataArray
 
 
     private:
-        std::vector<DataArrayEl> m_vec;
+        Storage m_vec;
         std::vector<size_type> m_free;
+        OccupancyBitmap m_occupancy;	//set bits correspond to active elements
 
         size_type m_max_size = 0;	//max possible number of elements 
         size_type m_max_used = 0;	//max number of memory blocks ever used
         size_type m_count = 0;		//active elements
 
+        enum class UndoType { appended, recycled, destroyed, modified };
+
+        struct UndoEntry
+        {
+            UndoType type;
+            size_type slot;
+            DataArrayId id;				// Id of the slot before the change
+            std::optional<T> value;		// Value of the slot before the change, if it has to be restored
+        };
+
+        bool m_transaction = false;
+        std::vector<UndoEntry> m_undo_log;
+        std::unordered_set<size_type> m_logged_slots;	// Slots whose value before the transaction is already in the undo log (or doesn't matter)
+
+
+        ////
+        //	Save the value of the element in @s (or start its own transaction) the first time it can be modified during the transaction.
+        ////
+        void log_modification(size_type const s)
+        {
+            if (m_logged_slots.insert(s).second)
+            {
+                if constexpr (detail::has_transactions<T>::value)
+                {
+                    m_vec[s].value.begin_transaction();
+                    m_undo_log.push_back({ UndoType::modified, s, m_vec[s].m_id, std::nullopt });
+                }
+                else
+                {
+                    m_undo_log.push_back({ UndoType::modified, s, m_vec[s].m_id, m_vec[s].value });
+                }
+            }
+        }
+
+        void log_change(UndoType const type, size_type const s)
+        {
+            auto & el = m_vec[s];
+
+            // A recycled slot holds a meaningful value only if it was destroyed during the transaction.
+            auto const save_value = type == UndoType::recycled && m_logged_slots.find(s) != m_logged_slots.end();
+            m_undo_log.push_back({ type, s, el.m_id, save_value ? std::optional<T>{ el.value } : std::nullopt });
+
+            m_logged_slots.insert(s);
+        }
+
 
 
         void set_maxSize(size_type const max_size)
@@ -404,8 +648,9 @@ class DataArray
 
             try
             {
-                m_vec.reserve(max_size);
-                m_free.reserve(max_size); //TODO: PERFORMANCE: m_free is hardly as big as m_vec, so a smaller initial value can be assigned
+                m_vec.reserve(max_size); //a PagedVector only allocates the missing pages
+                m_occupancy.resize(max_size);
+                //m_free isn't reserved: it only grows as much as the number of slots destroyed at the same time
             }
             catch (std::exception const& e)
             {
@@ -484,6 +729,7 @@ class DataArrayIterImpl
 {
     private:
         using DataArrayPointer = typename std::conditional_t< IsConst, DataArray<T, Resizable> const*, DataArray<T, Resizable> * >;
+        using SizeType = typename DataArray<T, Resizable>::size_type;
         using DataArrayElPointer = typename std::conditional_t< IsConst, detail::DataArrayEl<T> const*, detail::DataArrayEl<T> * >;
         using DataArrayElReference = typename std::conditional_t< IsConst, detail::DataArrayEl<T> const&, detail::DataArrayEl<T> & >;
 
@@ -510,19 +756,19 @@ class DataArrayIterImpl
             #endif
 
 
-            m_current_el = data_array->m_vec.data() + starting_slot;
+            m_current_slot = static_cast<SizeType>(starting_slot);
             go_to_firstValidElement();
         }
 
         auto operator++() -> DataArrayIterImpl&
         {
             #if DYNAMIC_ASSERTS
-                if (m_current_el == get_pastendEl())
+                if (m_current_slot == m_data_array->m_max_used)
                     throw std::runtime_error("Out-of-range: incremented beyond the one-past-the-end position.");
             #endif
 
 
-            ++m_current_el;
+            ++m_current_slot;
             go_to_firstValidElement();
 
             return *this;
@@ -534,11 +780,13 @@ class DataArrayIterImpl
         auto operator*() const -> DataArrayElReference
         {
             #if DYNAMIC_ASSERTS
-                if (DataArray<T, Resizable>::is_free(m_current_el->id()))
+                if (DataArray<T, Resizable>::is_free(current_el().id()))
                     throw std::runtime_error("Invalid slot: dereferencing a freed slot.");
             #endif
 
-            return *m_current_el;
+            log_access();
+
+            return current_el();
         }
         
         ////
@@ -547,27 +795,36 @@ class DataArrayIterImpl
         auto operator->() const -> DataArrayElPointer
         {
             #if DYNAMIC_ASSERTS
-                if (DataArray<T, Resizable>::is_free(m_current_el->id()))
+                if (DataArray<T, Resizable>::is_free(current_el().id()))
                     throw std::runtime_error("Invalid slot: dereferencing a freed slot.");
             #endif
 
-            return m_current_el;
+            log_access();
+
+            return &current_el();
         }
 
     private:
         DataArrayPointer m_data_array = nullptr;
-        DataArrayElPointer m_current_el = nullptr;
+        SizeType m_current_slot = 0;		//elements are addressed by slot, since the storage of a Resizable DataArray isn't contiguous
+
+        auto current_el() const -> DataArrayElReference { return m_data_array->m_vec[m_current_slot]; }
+
+        void log_access() const
+        {
+            if constexpr (!IsConst)
+            {
+                if (m_data_array->m_transaction) { m_data_array->log_modification(m_current_slot); }
+            }
+        }
 
         ////
         //	Browse the DataArray up to a valid element or to the past-the-end position.
         ////
         void go_to_firstValidElement() 
         { 
-            auto pastend_el = get_pastendEl();
-            while (m_current_el != pastend_el && DataArray<T, Resizable>::is_free(m_current_el->id()))
-                ++m_current_el; 
+            m_current_slot = m_data_array->m_occupancy.next_occupied(m_current_slot, m_data_array->m_max_used);
         }
-        auto get_pastendEl() -> DataArrayElPointer { return m_data_array->m_vec.data() + m_data_array->m_max_used; }
 
 
     friend bool operator==<T, Resizable, IsConst>(DataArrayIterImpl<T, Resizable, IsConst> const& lhs, DataArrayIterImpl<T, Resizable, IsConst> const& rhs); //friend of the full-specialization of operator==
@@ -577,7 +834,7 @@ template <typename T, bool Resizable, bool IsConst>
 bool operator==(DataArrayIterImpl<T, Resizable, IsConst> const& lhs, DataArrayIterImpl<T, Resizable, IsConst> const& rhs)
 {
     //true if both they are the iterators of the same DataArray and they are currently pointing the same element.
-    return lhs.m_data_array == rhs.m_data_array && lhs.m_current_el == rhs.m_current_el;
+    return lhs.m_data_array == rhs.m_data_array && lhs.m_current_slot == rhs.m_current_slot;
 }
 
 template <typename T, bool Resizable, bool IsConst>
@@ -699,6 +956,14 @@ auto operator>>(std::ifstream & ifs, DataArray<T_, Resizable_> & da) -> std::ifs
     ifs >> da.m_count;
 
     if (!ifs) { throw std::runtime_error("Error while reading DataArray members."); };
+
+    da.m_occupancy.clear();
+    da.m_occupancy.resize(da.m_max_size);
+    for (auto s = typename DataArray<T_, Resizable_>::size_type{ 0 }; s < da.m_max_used; ++s)
+    {
+        if (!DataArray<T_, Resizable_>::is_free(da.m_vec[s].id())) { da.m_occupancy.set(s); }
+    }
+
     return ifs;
 }
 
@@ -712,8 +977,8 @@ auto operator<<(Logger & lgr, DataArray<T_, Resizable_> const& da) -> Logger &
         << Logger::nltb << "m_vec.vertices_count(): " << da.m_vec.size()
         << Logger::nltb << "m_max_size: " << da.m_max_size;
 
-    for (auto e : da.m_vec)
-        lgr << "\n\n" << Logger::nltb << e << ",";
+    for (auto i = typename DataArray<T_, Resizable_>::Storage::size_type{ 0 }; i < da.m_vec.size(); ++i)
+        lgr << "\n\n" << Logger::nltb << da.m_vec[i] << ",";
 
     lgr << Logger::remt
         << Logger::nltb << "}";
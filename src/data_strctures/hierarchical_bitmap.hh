@@ -0,0 +1,125 @@
+#ifndef GM_HIERARCHICAL_BITMAP_HH
+#define GM_HIERARCHICAL_BITMAP_HH
+
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "data_strctures/occupancy_bitmap.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//	One bit per slot, plus a summary with one bit per word that is set when the word has at least a set bit. Looking for the next
+//	set bit skips 64 empty words (4096 slots) with a single summary word, so it stays fast even when the set bits are few and sparse.
+//	The bitmap only grows when resize() is called, so its memory follows the number of slots actually used.
+////
+class HierarchicalBitmap
+{
+    public:
+        using size_type = uint32_t;
+        static size_type constexpr npos = std::numeric_limits<size_type>::max();
+
+        ////
+        //	Make room for @slot_count slots. The new slots are unset. The bitmap can't shrink.
+        ////
+        void resize(size_type const slot_count)
+        {
+            auto const word_count = (static_cast<std::size_t>(slot_count) + 63u) / 64u;
+
+            if (word_count > m_words.size())
+            {
+                m_words.resize(word_count, 0u);
+                m_summary.resize((word_count + 63u) / 64u, 0u);
+            }
+        }
+
+        void clear() noexcept { m_words.clear(); m_summary.clear(); m_count = 0u; }
+
+        void set(size_type const slot) noexcept
+        {
+            auto const w = slot / 64u;
+            auto const bit = UINT64_C(1) << (slot % 64u);
+
+            m_count += (m_words[w] & bit) ? 0u : 1u;
+            m_words[w] |= bit;
+            m_summary[w / 64u] |= UINT64_C(1) << (w % 64u);
+        }
+
+        void reset(size_type const slot) noexcept
+        {
+            auto const w = slot / 64u;
+            auto const bit = UINT64_C(1) << (slot % 64u);
+
+            m_count -= (m_words[w] & bit) ? 1u : 0u;
+            m_words[w] &= ~bit;
+
+            if (m_words[w] == 0u)
+            {
+                m_summary[w / 64u] &= ~(UINT64_C(1) << (w % 64u));
+            }
+        }
+
+        bool test(size_type const slot) const noexcept { return (m_words[slot / 64u] >> (slot % 64u)) & UINT64_C(1); }
+
+        ////
+        //	Number of set bits.
+        ////
+        auto count() const noexcept { return m_count; }
+
+        ////
+        //	@return: The first set slot, or npos if there isn't any.
+        ////
+        auto find_first() const noexcept -> size_type { return find_next(0u); }
+
+        ////
+        //	@return: The first set slot not lower than @slot, or npos if there isn't any.
+        ////
+        auto find_next(size_type const slot) const noexcept -> size_type
+        {
+            auto const w = slot / 64u;
+            if (w >= m_words.size()) { return npos; }
+
+            auto const word = m_words[w] & (~UINT64_C(0) << (slot % 64u));	//ignore the bits before @slot
+            if (word != 0u)
+            {
+                return static_cast<size_type>(w * 64u + count_trailingZeros(word));
+            }
+
+            // Look for the next non-empty word through the summary.
+            auto const next_w = w + 1u;
+            if (next_w >= m_words.size()) { return npos; }
+
+            auto s = next_w / 64u;
+            auto summary_word = m_summary[s] & (~UINT64_C(0) << (next_w % 64u));
+
+            while (summary_word == 0u)
+            {
+                if (++s == m_summary.size()) { return npos; }
+
+                summary_word = m_summary[s];
+            }
+
+            auto const found_w = s * 64u + count_trailingZeros(summary_word);
+
+            return static_cast<size_type>(found_w * 64u + count_trailingZeros(m_words[found_w]));
+        }
+
+
+    private:
+        std::vector<uint64_t> m_words;
+        std::vector<uint64_t> m_summary;	//bit "i" is set when m_words[i] isn't zero
+        size_type m_count = 0u;
+};
+
+
+
+} //namespace tgm
+
+
+#endif //GM_HIERARCHICAL_BITMAP_HH
\ No newline at end of file
@@ -0,0 +1,214 @@
+#ifndef GM_MPSC_RING_BUFFER_HH
+#define GM_MPSC_RING_BUFFER_HH
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "settings/debug/debug_settings.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//	Bounded lock-free queue with many producers and a single consumer. The capacity is fixed at construction, so a push never
+//	allocates: when the ring is full the push fails and the overflow is counted.
+//	Each cell holds a sequence number telling whether it's ready to be written (== position) or to be read (== position + 1).
+//	Producers reserve a position with a CAS on the tail and publish the element by storing the sequence number of the cell; the
+//	consumer owns the head, so it doesn't need any atomic read-modify-write.
+////
+template <typename T>
+class MpscRingBuffer
+{
+    public:
+        using size_type = std::size_t;
+
+        ////
+        //	@capacity: Maximum number of elements waiting in the ring. It's rounded up to the next power of two.
+        ////
+        explicit MpscRingBuffer(size_type const capacity)
+        {
+            auto cell_count = size_type{ 2u };
+            while (cell_count < capacity)
+            {
+                cell_count *= 2u;
+            }
+
+            m_mask = cell_count - 1u;
+            m_cells = std::make_unique<Cell[]>(cell_count);
+
+            for (auto i = size_type{ 0u }; i < cell_count; ++i)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscRingBuffer(MpscRingBuffer const&) = delete;
+        auto operator=(MpscRingBuffer const&) -> MpscRingBuffer & = delete;
+
+        ~MpscRingBuffer()
+        {
+            while (!empty())
+            {
+                pop();
+            }
+        }
+
+
+        ////
+        //	Can be called by any thread.
+        //	@return: False if the ring is full (the element isn't constructed).
+        ////
+        template <typename ...Us>
+        bool try_emplace(Us&&... args)
+        {
+            auto pos = m_tail.load(std::memory_order_relaxed);
+            Cell * cell = nullptr;
+
+            while (true)
+            {
+                cell = &m_cells[pos & m_mask];
+                auto const seq = cell->sequence.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+                if (diff == 0)
+                {
+                    if (m_tail.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) { break; }
+                }
+                else if (diff < 0)
+                {
+                    m_overflows.fetch_add(1u, std::memory_order_relaxed);
+                    return false;
+                }
+                else
+                {
+                    pos = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+
+            new (&cell->storage) T(std::forward<Us>(args)...);
+            cell->sequence.store(pos + 1u, std::memory_order_release);
+
+            m_pushed.fetch_add(1u, std::memory_order_relaxed);
+
+            // The consumer may have already popped this element (and the following ones) in the meantime.
+            auto const head = m_head.load(std::memory_order_relaxed);
+            update_highWater(head <= pos + 1u ? pos + 1u - head : 0u);
+
+            return true;
+        }
+
+
+        //The following functions can be called only by the consumer thread.
+
+        ////
+        //	An element whose push is still in progress isn't visible yet, even if a later push has already completed.
+        ////
+        bool empty() const noexcept
+        {
+            auto const head = m_head.load(std::memory_order_relaxed);
+
+            return m_cells[head & m_mask].sequence.load(std::memory_order_acquire) != head + 1u;
+        }
+
+        auto front() -> T &
+        {
+            #if DYNAMIC_ASSERTS
+                if (empty()) { throw std::runtime_error("Trying to read the front of an empty MpscRingBuffer."); }
+            #endif
+
+            return *std::launder(reinterpret_cast<T *>(&m_cells[m_head.load(std::memory_order_relaxed) & m_mask].storage));
+        }
+
+        void pop()
+        {
+            auto & el = front();
+            el.~T();
+
+            auto const head = m_head.load(std::memory_order_relaxed);
+
+            m_cells[head & m_mask].sequence.store(head + m_mask + 1u, std::memory_order_release);
+            m_head.store(head + 1u, std::memory_order_relaxed);
+        }
+
+        ////
+        //	Number of elements waiting. It's exact only when no producer is pushing.
+        ////
+        auto size() const noexcept -> size_type { return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_relaxed); }
+
+        ////
+        //	Call @fn on each element that is ready and pop it.
+        //	@return: The number of elements consumed.
+        ////
+        template <typename F>
+        auto drain(F && fn) -> size_type
+        {
+            auto count = size_type{ 0u };
+
+            while (!empty())
+            {
+                fn(front());
+                pop();
+                ++count;
+            }
+
+            return count;
+        }
+
+
+        auto capacity() const noexcept -> size_type { return m_mask + 1u; }
+        auto pushed_count() const noexcept -> uint64_t { return m_pushed.load(std::memory_order_relaxed); }
+        auto overflow_count() const noexcept -> uint64_t { return m_overflows.load(std::memory_order_relaxed); }
+
+        ////
+        //	Maximum number of elements seen waiting right after a push. A producer may read a stale head, so it can overestimate the
+        //	real maximum, but never beyond the capacity.
+        ////
+        auto high_water() const noexcept -> size_type { return m_high_water.load(std::memory_order_relaxed); }
+
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_type> sequence{ 0u };
+            std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+        };
+
+        static size_type constexpr cache_line = 64u;
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_type m_mask = 0u;
+
+        alignas(cache_line) std::atomic<size_type> m_tail{ 0u };		//next position to write (shared by the producers)
+        alignas(cache_line) std::atomic<size_type> m_head{ 0u };		//next position to read (written only by the consumer)
+
+        alignas(cache_line) std::atomic<uint64_t> m_pushed{ 0u };
+        std::atomic<uint64_t> m_overflows{ 0u };
+        std::atomic<size_type> m_high_water{ 0u };
+
+
+        void update_highWater(size_type const waiting) noexcept
+        {
+            auto const clamped = std::min(waiting, capacity());
+            auto current = m_high_water.load(std::memory_order_relaxed);
+
+            while (current < clamped && !m_high_water.compare_exchange_weak(current, clamped, std::memory_order_relaxed)) {}
+        }
+};
+
+
+
+} //namespace tgm
+
+
+#endif //GM_MPSC_RING_BUFFER_HH
\ No newline at end of file
@@ -0,0 +1,124 @@
+#ifndef GM_OCCUPANCY_BITMAP_HH
+#define GM_OCCUPANCY_BITMAP_HH
+
+
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+
+namespace tgm
+{
+
+
+
+////
+//	@word: Must be different from zero.
+//	@return: Index of the lowest set bit of @word.
+////
+inline auto count_trailingZeros(uint64_t const word) noexcept -> unsigned
+{
+    #if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward64(&index, word);
+        return static_cast<unsigned>(index);
+    #else
+        return static_cast<unsigned>(__builtin_ctzll(word));
+    #endif
+}
+
+
+////
+//	One bit per slot, set when the slot is occupied. It allows to jump over runs of free slots 64 at a time.
+////
+class OccupancyBitmap
+{
+    public:
+        using size_type = uint32_t;
+
+        ////
+        //	Make room for @slot_count slots. The new slots are free.
+        ////
+        void resize(size_type const slot_count) { m_words.resize((static_cast<std::size_t>(slot_count) + 63u) / 64u, 0u); }
+
+        void clear() noexcept { m_words.clear(); }
+
+        void set(size_type const slot)   noexcept { m_words[slot / 64u] |=  (UINT64_C(1) << (slot % 64u)); }
+        void reset(size_type const slot) noexcept { m_words[slot / 64u] &= ~(UINT64_C(1) << (slot % 64u)); }
+        bool test(size_type const slot) const noexcept { return (m_words[slot / 64u] >> (slot % 64u)) & UINT64_C(1); }
+
+        ////
+        //	@return: The first occupied slot in [@slot, @end), or @end if there isn't any.
+        ////
+        auto next_occupied(size_type const slot, size_type const end) const noexcept -> size_type
+        {
+            return next(slot, end, UINT64_C(0));
+        }
+
+        ////
+        //	@return: The first free slot in [@slot, @end), or @end if there isn't any.
+        ////
+        auto next_free(size_type const slot, size_type const end) const noexcept -> size_type
+        {
+            return next(slot, end, ~UINT64_C(0));
+        }
+
+        ////
+        //	@return: The last occupied slot in [0, @end), or @end if there isn't any.
+        ////
+        auto prev_occupied(size_type const end) const noexcept -> size_type
+        {
+            for (auto slot = end; slot > 0u; --slot)
+            {
+                // Skip a whole word at a time when it's empty and @slot is aligned to its end.
+                if ((slot % 64u) == 0u && m_words[slot / 64u - 1u] == 0u)
+                {
+                    slot -= 63u;
+                    continue;
+                }
+
+                if (test(slot - 1u)) { return slot - 1u; }
+            }
+
+            return end;
+        }
+
+
+    private:
+        std::vector<uint64_t> m_words;
+
+
+        ////
+        //	@flip: Mask XORed with each word, so that the same scan finds either set bits (zero) or unset bits (all ones).
+        ////
+        auto next(size_type const slot, size_type const end, uint64_t const flip) const noexcept -> size_type
+        {
+            if (slot >= end) { return end; }
+
+            auto w = slot / 64u;
+            auto word = (m_words[w] ^ flip) & (~UINT64_C(0) << (slot % 64u));	//ignore the bits before @slot
+
+            auto const last_word = (end - 1u) / 64u;
+            while (word == 0u)
+            {
+                if (w == last_word) { return end; }
+
+                ++w;
+                word = m_words[w] ^ flip;
+            }
+
+            auto const found = static_cast<size_type>(w * 64u + count_trailingZeros(word));
+
+            return found < end ? found : end;
+        }
+};
+
+
+
+} //namespace tgm
+
+
+#endif //GM_OCCUPANCY_BITMAP_HH
\ No newline at end of file
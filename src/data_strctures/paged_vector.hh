@@ -0,0 +1,217 @@
+#ifndef GM_PAGED_VECTOR_HH
+#define GM_PAGED_VECTOR_HH
+
+
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "settings/debug/debug_settings.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//	A sequence of elements stored in fixed-size pages. The pages are never moved, so growing the container allocates a new page
+//	without copying any element, and pointers and references to the elements stay valid until the element is destroyed.
+//	The page of an element is found in O(1), because the page size is a power of two.
+////
+template <typename T>
+class PagedVector
+{
+    public:
+        using size_type = std::size_t;
+
+        ////
+        //	@page_size: Number of elements in each page. It's rounded up to the next power of two.
+        ////
+        explicit PagedVector(size_type const page_size = 1u)
+        {
+            while ((size_type{ 1u } << m_page_shift) < page_size)
+            {
+                ++m_page_shift;
+            }
+        }
+
+        PagedVector(PagedVector const& other) : m_page_shift(other.m_page_shift)
+        {
+            reserve(other.m_size);
+
+            for (auto i = size_type{ 0u }; i < other.m_size; ++i)
+            {
+                emplace_back(other[i]);
+            }
+        }
+
+        PagedVector(PagedVector && other) noexcept :
+            m_pages(std::move(other.m_pages)), m_page_shift(other.m_page_shift), m_size(other.m_size)
+        {
+            other.m_size = 0u;
+        }
+
+        auto operator=(PagedVector const& other) -> PagedVector &
+        {
+            if (this != &other)
+            {
+                auto copy = PagedVector{ other };
+                *this = std::move(copy);
+            }
+
+            return *this;
+        }
+
+        auto operator=(PagedVector && other) noexcept -> PagedVector &
+        {
+            if (this != &other)
+            {
+                clear();
+
+                m_pages = std::move(other.m_pages);
+                m_page_shift = other.m_page_shift;
+                m_size = other.m_size;
+
+                other.m_size = 0u;
+            }
+
+            return *this;
+        }
+
+        ~PagedVector() { clear(); }
+
+
+        auto size() const noexcept -> size_type { return m_size; }
+        bool empty() const noexcept { return m_size == 0u; }
+        auto capacity() const noexcept -> size_type { return m_pages.size() << m_page_shift; }
+        auto max_size() const noexcept -> size_type { return std::numeric_limits<size_type>::max() / sizeof(T); }
+        auto page_size() const noexcept -> size_type { return size_type{ 1u } << m_page_shift; }
+
+        ////
+        //	Allocate the pages needed to hold @new_capacity elements. The elements already stored aren't moved.
+        ////
+        void reserve(size_type const new_capacity)
+        {
+            while (capacity() < new_capacity)
+            {
+                m_pages.push_back(std::make_unique<Storage[]>(page_size()));
+            }
+        }
+
+        template <typename ...Ts>
+        auto emplace_back(Ts&&... args) -> T &
+        {
+            reserve(m_size + 1u);
+
+            auto const el = new (address(m_size)) T(std::forward<Ts>(args)...);
+            ++m_size;
+
+            return *el;
+        }
+
+        ////
+        //	Destroy the last element. Its page isn't deallocated.
+        ////
+        void pop_back() noexcept
+        {
+            --m_size;
+            (*this)[m_size].~T();
+        }
+
+        ////
+        //	Destroy all the elements. The pages aren't deallocated.
+        ////
+        void clear() noexcept
+        {
+            for (auto i = size_type{ 0u }; i < m_size; ++i)
+            {
+                (*this)[i].~T();
+            }
+
+            m_size = 0u;
+        }
+
+        auto operator[](size_type const i) -> T & { return *std::launder(reinterpret_cast<T *>(address(i))); }
+        auto operator[](size_type const i) const -> T const& { return *std::launder(reinterpret_cast<T const*>(address(i))); }
+
+        auto back() -> T & { return (*this)[m_size - 1u]; }
+        auto back() const -> T const& { return (*this)[m_size - 1u]; }
+
+
+    private:
+        using Storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+        std::vector<std::unique_ptr<Storage[]>> m_pages;
+        size_type m_page_shift = 0u;	//log2 of the page size
+        size_type m_size = 0u;
+
+
+        auto address(size_type const i) const -> Storage *
+        {
+            #if DYNAMIC_ASSERTS
+                if (i >= capacity()) { throw std::runtime_error("Out-of-range: the PagedVector index exceeds the allocated pages."); }
+            #endif
+
+            return &m_pages[i >> m_page_shift][i & (page_size() - 1u)];
+        }
+};
+
+
+template<typename T>
+auto operator<<(std::ofstream & ofs, PagedVector<T> const& v) -> std::ofstream &
+{
+    ofs << v.size();
+
+    for (auto i = typename PagedVector<T>::size_type{ 0u }; i < v.size(); ++i)
+    {
+        ofs << '\n'; //it returns the base class, so I can't append another operator<< after it
+        ofs << v[i];
+    }
+
+    return ofs;
+}
+
+
+////
+//	Read the same format of the std::vector operator>>, so that a PagedVector can read data saved by a std::vector (and vice versa).
+////
+template<typename T>
+auto operator>>(std::ifstream & ifs, PagedVector<T> & v) -> std::ifstream &
+{
+    auto size = typename PagedVector<T>::size_type{ 0 };
+    ifs >> size;
+
+    v.clear();
+
+    try
+    {
+        v.reserve(size);
+    }
+    catch (std::exception const& e)
+    {
+        std::ostringstream oss;	oss << "Not enough space in RAM for this vector (~" << (size * sizeof(T) / (1024*1024)) << " MB required). " << e.what();
+        throw std::runtime_error(oss.str());
+    }
+
+    for (auto i = decltype(size){ 0 }; i < size; ++i)
+    {
+        ifs >> v.emplace_back();
+    }
+
+    return ifs;
+}
+
+
+
+} //namespace tgm
+
+
+#endif //GM_PAGED_VECTOR_HH
\ No newline at end of file
@@ -16,18 +16,18 @@ SlotManager::SlotManager(size_type const capacity)
         throw std::runtime_error("Such a big capacity is not allowed.");
             
     m_capacity = capacity;
+}
 
 
-    try
-    {
-        m_ids.reserve(m_capacity);
-        m_free.reserve(m_capacity); //TODO: PERFORMANCE: m_free is hardly as big as m_ids, so a smaller initial value can be assigned
-    }
-    catch (std::exception const& e)
-    {
-        std::ostringstream oss; oss << "No space in RAM for such a big slot count. " << e.what();
-        throw std::runtime_error(oss.str());
-    }
+void SlotManager::set_capacity(size_type const new_capacity)
+{
+    if (new_capacity > max_capacity)
+        throw std::runtime_error("Such a big capacity is not allowed.");
+
+    if (new_capacity < m_capacity)
+        throw std::runtime_error("The capacity of a SlotManager can't be reduced.");
+
+    m_capacity = new_capacity;
 }
 
 
@@ -37,19 +37,29 @@ auto SlotManager::create_id() -> std::tuple<bool, CompleteId, SlotId>
     auto & [recycling, new_id, slot_id] = ret;
     new_id = 0;
 
-    if (m_free.empty())
+    if (m_free.count() == 0u)
     {
         if(m_ids.size() >= m_capacity)
             throw std::runtime_error("Overflow: All the slots are full.");
 
         recycling = false;
 
-        ++m_max_used;
-        new_id = m_max_used - 1; //conversion from size_type to SlotId
+        new_id = m_max_used; //conversion from size_type to SlotId
         new_id |= UINT64_C(0x0000000080000000); //version is set to 1
-                
-        m_ids.push_back(new_id);
 
+        try
+        {
+            m_live.resize(m_max_used + 1);
+            m_free.resize(m_max_used + 1);
+            m_ids.push_back(new_id);
+        }
+        catch (std::exception const& e)
+        {
+            std::ostringstream oss; oss << "No space in RAM for such a big slot count. " << e.what();
+            throw std::runtime_error(oss.str());
+        }
+
+        ++m_max_used;
 
         slot_id = slot(new_id);
     }
@@ -57,8 +67,8 @@ auto SlotManager::create_id() -> std::tuple<bool, CompleteId, SlotId>
     {
         recycling = true;
 
-        auto free_slot = m_free.back();
-        m_free.pop_back();
+        auto free_slot = m_free.find_first();
+        m_free.reset(free_slot);
                 
         // nullify the leftmost bit (that indicate a free state)  ---  id version was already changed in DataArray::destroy
         m_ids[free_slot] &= UINT64_C(0x7FFFFFFFFFFFFFFF);
@@ -68,6 +78,7 @@ auto SlotManager::create_id() -> std::tuple<bool, CompleteId, SlotId>
         slot_id = free_slot;
     }
 
+    m_live.set(slot_id);
     ++m_count;
 
     return ret;
@@ -113,7 +124,8 @@ auto SlotManager::destroy_id(CompleteId const id) -> std::optional<SlotId>
     {
         m_ids[id_slot] = setFree_and_increaseVersion(current_id);
 
-        m_free.push_back(id_slot);
+        m_live.reset(id_slot);
+        m_free.set(id_slot);
 
         --m_count;
 
@@ -148,7 +160,7 @@ auto operator<<(Logger & lgr, SlotManager const& sm) -> Logger &
     lgr << Logger::nltb << "SlotManager {"
         << Logger::addt
         << Logger::nltb << "max_used: " << sm.m_max_used
-        << Logger::nltb << "m_free.vertices_count(): " << sm.m_free.size()
+        << Logger::nltb << "free slots: " << sm.m_free.count()
         << Logger::nltb << "m_capacity: " << sm.m_capacity;
 
     for (auto id : sm.m_ids)
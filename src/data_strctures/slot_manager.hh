@@ -9,6 +9,8 @@
 
 #include "settings/debug/debug_settings.hh"
 
+#include "data_strctures/hierarchical_bitmap.hh"
+
 #include "debug/logger/logger.hh"
 
 
@@ -21,6 +23,12 @@ using CompleteId = uint64_t;
 using SlotId = uint32_t;
 
 
+////
+//	Assign to each object a slot and a versioned id. The live slots and the free slots are tracked by two hierarchical bitmaps, so
+//	looking for the first live slot and for a free slot to recycle skip 64 slots at a time (4096 when whole words are empty).
+//	Nothing is reserved up front: the ids and the bitmaps grow with the number of slots actually used, not with the capacity.
+//	A recycled slot is always the lowest free one, which keeps the used slots packed at the beginning.
+////
 class SlotManager
 {
     public:
@@ -37,21 +45,40 @@ class SlotManager
 
         auto destroy_id(CompleteId const id) -> std::optional<SlotId>;
 
+        ////
+        //	Maximum number of slots allowed.
+        ////
+        auto capacity() const noexcept { return m_capacity; }
+
+        ////
+        //	Indicate whether all the slots are in use, so that create_id() would throw.
+        ////
+        auto full() const noexcept { return m_free.count() == 0u && m_ids.size() >= m_capacity; }
+
+        ////
+        //	Increase the maximum number of slots allowed. The ids already created stay valid.
+        ////
+        void set_capacity(size_type const new_capacity);
+
+
+        ////
+        //	@return: The id of the lowest non-free slot, or 0 if all the slots are free.
+        ////
+        auto first_nonFreeId() const noexcept -> CompleteId { return next_nonFreeId(0u); }
 
-        auto first_nonFreeId() -> CompleteId
+        ////
+        //	@return: The id of the lowest non-free slot not lower than @slot_id, or 0 if there isn't any.
+        ////
+        auto next_nonFreeId(SlotId const slot_id) const noexcept -> CompleteId
         {
-            for (auto id : m_ids)
-            {
-                if (!is_free(id))
-                    return id;
-            }
+            auto const found = m_live.find_next(slot_id);
 
-            return 0;
+            return found == HierarchicalBitmap::npos ? CompleteId{ 0 } : m_ids[found];
         }
 
 
         auto debug_idsVecSize() { return m_ids.size(); }
-        auto debug_freeListSize() { return m_free.size(); }
+        auto debug_freeListSize() { return m_free.count(); }
 
         void debug_setVersion(CompleteId & id, size_type const new_version)
         {
@@ -78,7 +105,8 @@ class SlotManager
         size_type m_count = 0;								//number of non-free slots
 
         std::vector<CompleteId> m_ids;						//complete id (free | version | slot) of each sprite slot
-        std::vector<size_type> m_free;						//index of free slots
+        HierarchicalBitmap m_live;							//non-free slots
+        HierarchicalBitmap m_free;							//free slots among the ones already used
 
 
 
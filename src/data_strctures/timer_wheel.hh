@@ -0,0 +1,125 @@
+#ifndef GM_TIMER_WHEEL_HH
+#define GM_TIMER_WHEEL_HH
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace tgm
+{
+
+
+
+////
+//
+//	Hierarchical timer wheel counting discrete ticks. Level 0 has a slot for each of the next 64 ticks, and each upper level has 64 slots
+//	covering 64 times the span of a slot of the level below. When the lower level wraps around, the next slot of the upper level is
+//	cascaded down, so each timer is moved at most once per level and a tick costs O(1) plus the timers that expire in it, no matter how
+//	many timers are pending. Timers can't be cancelled: the owner has to ignore the expired timers that are no longer relevant.
+//
+////
+template <typename T>
+class TimerWheel
+{
+    public:
+        using tick_type = std::uint64_t;
+
+        static constexpr std::size_t slot_bits = 6u;
+        static constexpr std::size_t slot_count = std::size_t{ 1u } << slot_bits;
+        static constexpr std::size_t level_count = 4u;
+        static constexpr tick_type max_delay = (tick_type{ 1u } << (slot_bits * level_count)) - 1u;
+
+        auto now() const noexcept -> tick_type { return m_now; }
+        auto size() const noexcept -> std::size_t { return m_size; }
+
+        ////
+        //	Schedule @value to expire @delay ticks from now (at least one, at most max_delay).
+        //	@return: The tick at which it will expire.
+        ////
+        auto schedule(T const& value, tick_type const delay) -> tick_type
+        {
+            auto const deadline = m_now + std::clamp<tick_type>(delay, 1u, max_delay);
+
+            insert({ deadline, value });
+            ++m_size;
+
+            return deadline;
+        }
+
+        ////
+        //	Move to the next tick and call @f(value) for each timer expiring in it. @f can schedule new timers.
+        ////
+        template <typename F>
+        void advance(F && f)
+        {
+            ++m_now;
+
+            // Cascade from the highest level that wrapped around, so that the timers moved down can be cascaded again in the same tick
+            auto level = std::size_t{ 0u };
+            while (level + 1u < level_count && slot_index(m_now, level) == 0u)
+            {
+                ++level;
+            }
+            for (; level > 0u; --level)
+            {
+                m_expiring.clear();
+                m_expiring.swap(m_levels[level][slot_index(m_now, level)]);
+
+                for (auto const& timer : m_expiring)
+                {
+                    insert(timer);
+                }
+            }
+
+            m_expiring.clear();
+            m_expiring.swap(m_levels[0][slot_index(m_now, 0u)]);
+            m_size -= m_expiring.size();
+
+            for (auto const& timer : m_expiring)
+            {
+                f(timer.value);
+            }
+        }
+
+    private:
+        struct Timer
+        {
+            tick_type deadline;
+            T value;
+        };
+
+        std::array<std::array<std::vector<Timer>, slot_count>, level_count> m_levels;
+        std::vector<Timer> m_expiring;		// Reused by advance(), so that a tick doesn't allocate once the wheel has warmed up
+        tick_type m_now = 0u;
+        std::size_t m_size = 0u;
+
+
+        static auto slot_index(tick_type const tick, std::size_t const level) noexcept -> std::size_t
+        {
+            return static_cast<std::size_t>(tick >> (slot_bits * level)) & (slot_count - 1u);
+        }
+
+        void insert(Timer const& timer)
+        {
+            auto const delta = timer.deadline - m_now;
+
+            auto level = std::size_t{ 0u };
+            while (level + 1u < level_count && delta >= (tick_type{ 1u } << (slot_bits * (level + 1u))))
+            {
+                ++level;
+            }
+
+            m_levels[level][slot_index(timer.deadline, level)].push_back(timer);
+        }
+};
+
+
+
+} // namespace tgm
+
+
+#endif //GM_TIMER_WHEEL_HH
\ No newline at end of file
@@ -61,7 +61,8 @@ void GuiManager::update()
 }
 
 void GuiManager::generate_layout(GameMap const& map, Camera const& camera, CameraController const& camera_controller,
-                                 TimedCounter const& fps_counter, TimedCounter const& ups_counter, MainLoopData const& mainLoop_data, TimedCounter const& input_counter)
+                                 TimedCounter const& fps_counter, TimedCounter const& ups_counter, MainLoopData const& mainLoop_data, TimedCounter const& input_counter,
+                                 FrustumCullingStats const& tileCulling_stats)
 {
     if (!m_hide)
     {
@@ -70,7 +71,7 @@ void GuiManager::generate_layout(GameMap const& map, Camera const& camera, Camer
         tile_gui.generate_layout();
         cityBlock_gui.generate_layout();
         mainMenu_gui.generate_layout(m_fbo_size);
-        mainLoopAnalyzer_gui.generate_layout(fps_counter, ups_counter, mainLoop_data);
+        mainLoopAnalyzer_gui.generate_layout(fps_counter, ups_counter, mainLoop_data, tileCulling_stats, map.door_eventStats(), map.input_eventStats());
         control_gui.generate_layout(m_fbo_size);
         tutorial_panel.generate_layout(m_fbo_size);
         on_screen_message_panel.generate_layout(m_fbo_size, m_custom_font);
@@ -193,7 +194,7 @@ void TileGui::generate_layout()
         }
         if (ImGui::Selectable("CityBlock:")) 
         { 
-            m_gui_events.push<RetrieveCityBlockEv>(true, m_t->block()); 
+            push_guiEvent<RetrieveCityBlockEv>(m_gui_events, true, m_t->block()); 
         }
                                     ImGui::SameLine(offset); ImGui::Text("%s", oss8.str().data());
         ImGui::Text("Door:");		ImGui::SameLine(offset); ImGui::Text("%s", oss4.str().data());
@@ -245,7 +246,7 @@ void CityBlockGui::generate_layout()
 
         if (open)
         {
-            m_gui_events.push<RetrieveCityBlockEv>(false, cbid);
+            push_guiEvent<RetrieveCityBlockEv>(m_gui_events, false, cbid);
         }
     }
 }
@@ -107,7 +107,8 @@ class GuiManager
         //	Generate the panel layouts in ImGui metadata.
         ////
         void generate_layout(GameMap const& map, Camera const& camera, CameraController const& camera_controller,
-                             TimedCounter const& fps_counter, TimedCounter const& ups_counter, MainLoopData const& mainLoop_data, TimedCounter const& input_counter);
+                             TimedCounter const& fps_counter, TimedCounter const& ups_counter, MainLoopData const& mainLoop_data, TimedCounter const& input_counter,
+                             FrustumCullingStats const& tileCulling_stats);
 
     private:
         bool m_hide = false;
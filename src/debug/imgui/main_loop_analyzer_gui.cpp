@@ -13,7 +13,8 @@ namespace tgm
 
 
 
-void MainLoopAnalyzerGui::generate_layout(TimedCounter const& fps_counter, TimedCounter const& ups_counter, MainLoopData const& mainLoop_data)
+void MainLoopAnalyzerGui::generate_layout(TimedCounter const& fps_counter, TimedCounter const& ups_counter, MainLoopData const& mainLoop_data,
+                                          FrustumCullingStats const& tileCulling_stats, EventQueueStats const& door_stats, EventQueueStats const& input_stats)
 {
     if (m_open)
     {
@@ -80,6 +81,37 @@ void MainLoopAnalyzerGui::generate_layout(TimedCounter const& fps_counter, Timed
         ImGui::PlotHistogram("Swap time history (mcs)",		 swapT_history.data(),		static_cast<int>(swapT_history.size()),		 0, "", 0.f, m_max, graph_size);
         ImGui::PlotHistogram("Input time history (mcs)",	 inputT_history.data(),		static_cast<int>(inputT_history.size()),	 0, "", 0.f, m_max, graph_size);
         
+        if (tileCulling_stats.total_cells > 0u)
+        {
+            auto cells_oss = std::ostringstream{}; cells_oss << tileCulling_stats.visible_cells << " / " << tileCulling_stats.total_cells 
+                                                             << " (tested: " << tileCulling_stats.tested_cells << ")";
+            auto vertices_oss = std::ostringstream{}; vertices_oss << tileCulling_stats.visible_vertices << " / " << tileCulling_stats.total_vertices;
+            auto commands_oss = std::ostringstream{}; commands_oss << tileCulling_stats.draw_commands;
+            auto time_oss = std::ostringstream{}; time_oss << tileCulling_stats.culling_time << " mcs";
+
+            auto const offset = 160.f * GSet::imgui_scale();
+
+            ImGui::Text("Tile frustum culling");
+            ImGui::Text("Visible cells:");	  ImGui::SameLine(offset); ImGui::Text("%s", cells_oss.str().data());
+            ImGui::Text("Visible vertices:"); ImGui::SameLine(offset); ImGui::Text("%s", vertices_oss.str().data());
+            ImGui::Text("Draw commands:");	  ImGui::SameLine(offset); ImGui::Text("%s", commands_oss.str().data());
+            ImGui::Text("Culling time:");	  ImGui::SameLine(offset); ImGui::Text("%s", time_oss.str().data());
+        }
+
+        {
+            auto const format = [](EventQueueStats const& s) -> std::string {
+                auto oss = std::ostringstream{}; 
+                oss << "pushed " << s.pushed << ", dropped " << s.overflows << ", high water " << s.high_water << " / " << s.capacity;
+                return oss.str();
+            };
+
+            auto const offset = 160.f * GSet::imgui_scale();
+
+            ImGui::Text("Event queues");
+            ImGui::Text("Door openings:");	  ImGui::SameLine(offset); ImGui::Text("%s", format(door_stats).data());
+            ImGui::Text("Player movements:"); ImGui::SameLine(offset); ImGui::Text("%s", format(input_stats).data());
+        }
+
         auto const button_dim = ImVec2{ (m_frozen ? 65.f : 50.f) * GSet::imgui_scale(), 30.f * GSet::imgui_scale() };
         if (ImGui::Button(m_frozen ? "Unfreeze" : "Freeze", button_dim)) { m_frozen = !m_frozen; }
 
@@ -2,6 +2,8 @@
 #define GM_MAIN_LOOP_ANALYZER_GUI_HH
 
 
+#include "graphics/culling/tile_frustum_culler.hh"
+#include "mediators/queues/concurrent_event_queues_impl.hh"
 #include "settings/graphics_settings.hh"
 #include "utilities/timed_counter.hh"
 #include "utilities/main_loop_data.hh"
@@ -17,7 +19,8 @@ namespace tgm
 class MainLoopAnalyzerGui : public BaseGui
 {
     public:
-        void generate_layout(TimedCounter const& fps_counter, TimedCounter const& ups_counter, MainLoopData const& mainLoop_data);
+        void generate_layout(TimedCounter const& fps_counter, TimedCounter const& ups_counter, MainLoopData const& mainLoop_data,
+                             FrustumCullingStats const& tileCulling_stats, EventQueueStats const& door_stats, EventQueueStats const& input_stats);
 
     private:
         bool m_frozen = false;
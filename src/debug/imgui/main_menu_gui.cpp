@@ -45,7 +45,7 @@ void MainMenuGui::generate_layout(Vector2i const framebuffer_size)
 
         if (ImGui::Button("Controls", button_dim)) 
         {
-            m_gui_events.push<ControlPanelEv>();
+            push_guiEvent<ControlPanelEv>(m_gui_events);
             ImGui::CloseCurrentPopup(); 
             switch_state();
         }
@@ -59,7 +59,7 @@ void MainMenuGui::generate_layout(Vector2i const framebuffer_size)
         ImGui::NewLine(); 
         ImGui::NewLine(); ImGui::SameLine(offset); 
 
-        if (ImGui::Button("Exit", button_dim)) { m_gui_events.push<ExitEv>(); }
+        if (ImGui::Button("Exit", button_dim)) { push_guiEvent<ExitEv>(m_gui_events); }
 
 
         ImGui::End();
@@ -111,7 +111,7 @@ void MainMenuGui::generate_saveModal_layout()
             auto const target = std::regex{ "(" + GStateSet::saves_ext + ")|[^a-zA-Z0-9]" };
             auto const fn_trimmed = std::regex_replace(fn, target, "");
 
-            m_gui_events.push<SaveWorldEv>(fn_trimmed);
+            push_guiEvent<SaveWorldEv>(m_gui_events, fn_trimmed);
             ImGui::CloseCurrentPopup();
             for (auto i = 0; i < max_inputSize; ++i) { filename_input[i] = 0; }		//erase the selected string
         }
@@ -164,7 +164,7 @@ void MainMenuGui::generate_loadModal_layout()
             auto const target = std::regex{ "(" + GStateSet::saves_ext + ")" };
             auto const fn_trimmed = std::regex_replace(fn, target, "");
 
-            m_gui_events.push<LoadWorldEv>(fn_trimmed);
+            push_guiEvent<LoadWorldEv>(m_gui_events, fn_trimmed);
             ImGui::CloseCurrentPopup(); 
             selected_file.erase();
         }
@@ -187,14 +187,14 @@ void MainMenuGui::generate_optionModal_layout()
             
         if (ImGui::Button("Main loop Analyzer")) 
         {
-            m_gui_events.push<MainLoopAnalyzerEv>();
+            push_guiEvent<MainLoopAnalyzerEv>(m_gui_events);
             ImGui::CloseCurrentPopup(); 
             switch_state();
         }
 
         if (ImGui::Button("Movement Analyzer")) 
         {
-            m_gui_events.push<MovementAnalyzerEv>();
+            push_guiEvent<MovementAnalyzerEv>(m_gui_events);
             ImGui::CloseCurrentPopup(); 
             switch_state();
         }
@@ -0,0 +1,306 @@
+#include "async_log.hh"
+
+
+#include <algorithm>
+#include <iostream>
+
+#include "utilities/filesystem_utilities.hh"
+
+
+namespace tgm
+{
+
+
+
+namespace
+{
+    // File of each channel, in the order of LogChannel.
+    char const* const channel_paths[] = {
+        "_logs/log.txt",
+        "_debug/debuglogs/building_expansion/BElog.txt",
+        "_debug/debuglogs/player_movement/PMlog.txt",
+        "_debug/debuglogs/visual_debug/VDlog.txt"
+    };
+
+    static_assert(std::size(channel_paths) == static_cast<std::size_t>(LogChannel::count), "A LogChannel has no file.");
+
+    // Set when the RingHandle of the thread is destroyed: its records are discarded from then on. Trivially destructible, so that it can
+    // still be read by the thread_local destructors that log after the handle is gone.
+    thread_local bool ring_handle_destroyed = false;
+}
+
+
+AsyncLog::AsyncLog()
+{
+    for (auto & e : m_enabled)
+    {
+        e.store(true, std::memory_order_relaxed);
+    }
+}
+
+
+AsyncLog::~AsyncLog()
+{
+    m_stop.store(true, std::memory_order_release);
+    wake_writer();
+
+    if (m_writer.joinable())
+    {
+        m_writer.join();
+    }
+}
+
+
+void AsyncLog::log_text(LogChannel const channel, std::string text)
+{
+    if (!is_enabled(channel)) { return; }
+
+    auto record = LogRecord{};
+    record.channel = channel;
+    record.text = std::move(text);
+
+    push(std::move(record));
+}
+
+
+void AsyncLog::flush()
+{
+    {
+        auto lock = std::scoped_lock{ m_rings_mutex };
+        if (!m_writer.joinable()) { return; }	// Nothing has ever been logged, so the writer hasn't been started
+    }
+
+    auto lock = std::unique_lock{ m_flush_mutex };
+    auto const target = ++m_flush_requested;
+
+    wake_writer();
+    m_flush_cv.wait(lock, [this, target] { return m_flush_done >= target; });
+}
+
+
+auto AsyncLog::dropped_count() const -> uint64_t
+{
+    auto lock = std::scoped_lock{ m_rings_mutex };
+
+    auto count = m_retired_dropped;
+    for (auto const& tr : m_rings)
+    {
+        count += tr->ring.overflow_count();
+    }
+
+    return count;
+}
+
+
+void AsyncLog::push(LogRecord && record)
+{
+    auto const ring = thread_ring();
+    if (!ring) { return; }
+
+    if (!ring->try_emplace(std::move(record))) { return; }	// A failure is counted by the ring itself
+
+    // Pairs with the fence in wait_records(): either the writer sees the record or this thread sees the writer idle.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_writer_idle.load(std::memory_order_relaxed))
+    {
+        wake_writer();
+    }
+}
+
+
+void AsyncLog::wake_writer()
+{
+    {
+        auto lock = std::scoped_lock{ m_wake_mutex };
+        m_wake_requested = true;
+    }
+    m_wake_cv.notify_one();
+}
+
+
+auto AsyncLog::thread_ring() -> Ring *
+{
+    // Checked before the handle is named, since it may be already destroyed.
+    if (ring_handle_destroyed) { return nullptr; }
+
+    // The owner is stored too, in case there is more than one AsyncLog.
+    thread_local RingHandle handle;
+
+    if (handle.owner != this)
+    {
+        handle.retire();
+
+        auto lock = std::scoped_lock{ m_rings_mutex };
+
+        handle.ring = m_rings.emplace_back(std::make_shared<ThreadRing>());
+        handle.owner = this;
+
+        if (!m_writer.joinable())
+        {
+            m_writer = std::thread{ [this] { run_writer(); } };
+        }
+    }
+
+    return &handle.ring->ring;
+}
+
+
+AsyncLog::RingHandle::~RingHandle()
+{
+    // The AsyncLogBuffers of this thread may be destroyed after the handle, so their text is handed over now.
+    for (auto c = std::size_t{ 0u }; c < static_cast<std::size_t>(LogChannel::count); ++c)
+    {
+        if (auto const buffer = thread_buffer(static_cast<LogChannel>(c))) { buffer->pubsync(); }
+    }
+
+    ring_handle_destroyed = true;
+    retire();
+}
+
+
+void AsyncLog::RingHandle::retire() noexcept
+{
+    if (ring)
+    {
+        // Release: the writer that sees the flag sees all the records pushed before it.
+        ring->retired.store(true, std::memory_order_release);
+        ring.reset();
+    }
+
+    owner = nullptr;
+}
+
+
+void AsyncLog::run_writer()
+{
+    while (true)
+    {
+        auto const stopping = m_stop.load(std::memory_order_acquire);
+
+        auto flush_target = uint64_t{ 0u };
+        auto flush_pending = false;
+        {
+            auto lock = std::scoped_lock{ m_flush_mutex };
+            flush_target = m_flush_requested;
+            flush_pending = m_flush_requested > m_flush_done;
+        }
+
+        auto const written = write_pending();
+
+        if (stopping || flush_pending)
+        {
+            for (auto & f : m_files)
+            {
+                if (f.is_open()) { f.flush(); }
+            }
+            std::cout.flush();
+
+            {
+                auto lock = std::scoped_lock{ m_flush_mutex };
+                m_flush_done = flush_target;
+            }
+            m_flush_cv.notify_all();
+        }
+
+        if (stopping) { return; }
+
+        if (written == 0u)
+        {
+            wait_records();
+        }
+    }
+}
+
+
+void AsyncLog::wait_records()
+{
+    auto lock = std::unique_lock{ m_wake_mutex };
+
+    m_writer_idle.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // A record pushed before the writer was marked idle hasn't woken it, so it must be seen here.
+    if (!has_pending())
+    {
+        m_wake_cv.wait(lock, [this] { return m_wake_requested; });
+    }
+
+    m_wake_requested = false;
+    m_writer_idle.store(false, std::memory_order_relaxed);
+}
+
+
+auto AsyncLog::write_pending() -> std::size_t
+{
+    auto lock = std::scoped_lock{ m_rings_mutex };
+
+    auto count = std::size_t{ 0u };
+    for (auto & tr : m_rings)
+    {
+        // Read the flag before draining, so that a retired ring is empty once drained.
+        auto const retired = tr->retired.load(std::memory_order_acquire);
+
+        count += tr->ring.drain([this](LogRecord & record) { write(record); });
+
+        if (retired)
+        {
+            m_retired_dropped += tr->ring.overflow_count();
+            tr.reset();
+        }
+    }
+
+    m_rings.erase(std::remove(m_rings.begin(), m_rings.end(), nullptr), m_rings.end());
+
+    return count;
+}
+
+
+bool AsyncLog::has_pending() const
+{
+    auto lock = std::scoped_lock{ m_rings_mutex };
+
+    for (auto const& tr : m_rings)
+    {
+        if (!tr->ring.empty()) { return true; }
+    }
+
+    return false;
+}
+
+
+void AsyncLog::write(LogRecord & record)
+{
+    if (record.format)
+    {
+        auto oss = std::ostringstream{};
+        auto lgr = Logger{ oss };
+        record.decode(lgr, record.format->format, record.args.data());
+        oss << '\n';
+
+        record.text = oss.str();
+    }
+
+    file(record.channel) << record.text;
+
+    if (record.channel == LogChannel::general)
+    {
+        std::cout << record.text;
+    }
+}
+
+
+auto AsyncLog::file(LogChannel const channel) -> std::ofstream &
+{
+    auto & f = m_files[index(channel)];
+
+    if (!f.is_open())
+    {
+        f = FsUtil::create_unique(channel_paths[index(channel)], channel == LogChannel::general);
+    }
+
+    return f;
+}
+
+
+
+} // namespace tgm
\ No newline at end of file
@@ -0,0 +1,340 @@
+#ifndef GM_ASYNC_LOG_HH
+#define GM_ASYNC_LOG_HH
+
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "data_strctures/mpsc_ring_buffer.hh"
+#include "debug/logger/logger.hh"
+
+
+namespace tgm
+{
+
+
+
+enum class LogChannel : uint8_t
+{
+    general,
+    building_expansion,
+    player_movement,
+    visual_debug,
+
+    count
+};
+
+
+////
+//	The format of a record. Each "{}" is replaced by the next argument. Its address is the id of the format, so it must have static
+//	storage duration (the ASYNC_LOG macro takes care of it).
+////
+struct LogFormat
+{
+    char const* format;
+};
+
+
+////
+//
+//	Logging backend that keeps the formatting and the file I/O away from the logging threads.
+//	A thread logging a record only copies the id of the format and the raw bytes of the arguments into its own lock-free ring; a
+//	background thread decodes the records, formats them and writes them on the file of their channel (the general channel, used
+//	by g_log, is echoed on the console too). The background thread sleeps while all the rings are empty.
+//	Each channel can be enabled or disabled at runtime; the records of a disabled channel are discarded before being copied.
+//	The records of the same thread are written in order, together with the text of its AsyncLogBuffer on the same channel, which is
+//	handed over before each formatted record; the records of different threads can be interleaved.
+//
+////
+class AsyncLog
+{
+    public:
+        static std::size_t constexpr max_argsSize = 96u;			// Bytes available for the raw arguments of a record
+        static std::size_t constexpr ring_capacity = 1024u;		// Records that each thread can have waiting to be written
+
+        AsyncLog();
+        AsyncLog(AsyncLog const&) = delete;
+        auto operator=(AsyncLog const&) -> AsyncLog & = delete;
+
+        ////
+        //	Write all the records still waiting and stop the background thread.
+        ////
+        ~AsyncLog();
+
+
+        void enable(LogChannel const channel, bool const enabled) noexcept { m_enabled[index(channel)].store(enabled, std::memory_order_relaxed); }
+
+        bool is_enabled(LogChannel const channel) const noexcept { return m_enabled[index(channel)].load(std::memory_order_relaxed); }
+
+        ////
+        //	Flag that a Logger can check to skip the formatting of a disabled channel.
+        ////
+        auto enabled_flag(LogChannel const channel) const noexcept -> std::atomic<bool> const& { return m_enabled[index(channel)]; }
+
+        ////
+        //	Record @args to be formatted later following @format. The arguments are copied byte by byte, so they must be trivially
+        //	copyable and they mustn't be pointers (the pointed data could be gone before the record is written).
+        ////
+        template <typename ...Ts>
+        void log(LogChannel const channel, LogFormat const& format, Ts const&... args)
+        {
+            static_assert((std::is_trivially_copyable_v<Ts> && ...), "The arguments of an async log record must be trivially copyable.");
+            static_assert(!(std::is_pointer_v<Ts> || ...), "The arguments of an async log record can't be pointers.");
+            static_assert((sizeof(Ts) + ... + 0u) <= max_argsSize, "The arguments of the async log record are too big.");
+
+            if (!is_enabled(channel)) { return; }
+
+            // The text already streamed in the AsyncLogBuffer of this thread precedes the record.
+            if (auto const buffer = thread_buffer(channel)) { buffer->pubsync(); }
+
+            auto record = LogRecord{};
+            record.channel = channel;
+            record.format = &format;
+            record.decode = &decode<Ts...>;
+
+            auto offset = std::size_t{ 0u };
+            ((std::memcpy(record.args.data() + offset, &args, sizeof(Ts)), offset += sizeof(Ts)), ...);
+
+            push(std::move(record));
+        }
+
+        ////
+        //	Record a text already formatted. It's the fallback for the data that can't be copied byte by byte (e.g. containers).
+        ////
+        void log_text(LogChannel const channel, std::string text);
+
+        ////
+        //	Block until all the records pushed so far by any thread have been written on file.
+        ////
+        void flush();
+
+        ////
+        //	Number of records discarded because the ring of their thread was full.
+        ////
+        auto dropped_count() const -> uint64_t;
+
+
+    private:
+        friend class AsyncLogBuffer;
+
+        using DecodeFn = void (*)(Logger & lgr, char const* format, std::byte const* args);
+
+        struct LogRecord
+        {
+            LogChannel channel = LogChannel::general;
+            LogFormat const* format = nullptr;			// nullptr for the text records
+            DecodeFn decode = nullptr;
+            std::array<std::byte, max_argsSize> args;
+            std::string text;
+        };
+
+        using Ring = MpscRingBuffer<LogRecord>;
+
+        ////
+        //	The ring of a thread. It's shared with the thread, so that the thread can retire it on exit even if the log is already gone.
+        ////
+        struct ThreadRing
+        {
+            Ring ring{ ring_capacity };
+            std::atomic<bool> retired{ false };		// Set when the thread exits: nothing else will be pushed
+        };
+
+        ////
+        //	Thread-local owner of the ring of a thread. Its destructor hands over the text still waiting in the AsyncLogBuffers of the
+        //	thread and retires the ring, so that the writer frees it once drained.
+        ////
+        struct RingHandle
+        {
+            AsyncLog const* owner = nullptr;
+            std::shared_ptr<ThreadRing> ring;
+
+            ~RingHandle();
+
+            void retire() noexcept;
+        };
+
+        std::array<std::atomic<bool>, static_cast<std::size_t>(LogChannel::count)> m_enabled;
+
+        mutable std::mutex m_rings_mutex;
+        std::vector<std::shared_ptr<ThreadRing>> m_rings;	// One for each living thread that has logged something
+        uint64_t m_retired_dropped = 0u;					// Records dropped by the rings already freed (guarded by m_rings_mutex)
+
+        std::array<std::ofstream, static_cast<std::size_t>(LogChannel::count)> m_files;	// Only accessed by the writer thread
+
+        std::thread m_writer;
+        std::atomic<bool> m_stop{ false };
+
+        std::mutex m_wake_mutex;
+        std::condition_variable m_wake_cv;
+        bool m_wake_requested = false;				// Guarded by m_wake_mutex
+        std::atomic<bool> m_writer_idle{ false };	// The writer is (or is about to be) waiting on m_wake_cv
+
+        std::mutex m_flush_mutex;
+        std::condition_variable m_flush_cv;
+        uint64_t m_flush_requested = 0u;
+        uint64_t m_flush_done = 0u;
+
+
+        static auto index(LogChannel const channel) noexcept -> std::size_t { return static_cast<std::size_t>(channel); }
+
+        void push(LogRecord && record);
+
+        ////
+        //	Wake the writer thread if it's waiting for new records.
+        ////
+        void wake_writer();
+
+        ////
+        //	The AsyncLogBuffer of the calling thread for @channel, or nullptr if the thread hasn't got one.
+        ////
+        static auto thread_buffer(LogChannel const channel) noexcept -> std::streambuf * &
+        {
+            thread_local std::array<std::streambuf *, static_cast<std::size_t>(LogChannel::count)> buffers{};
+
+            return buffers[index(channel)];
+        }
+
+        ////
+        //	@return: The ring of the calling thread (created and registered on its first call), or nullptr if the thread is exiting.
+        ////
+        auto thread_ring() -> Ring *;
+
+        void run_writer();
+
+        ////
+        //	Block the writer thread until a record is pushed, a flush is requested or the log is stopped.
+        ////
+        void wait_records();
+
+        ////
+        //	Write the records waiting in all the rings and free the rings retired by their threads.
+        //	@return: The number of records written.
+        ////
+        auto write_pending() -> std::size_t;
+
+        bool has_pending() const;
+
+        void write(LogRecord & record);
+
+        auto file(LogChannel const channel) -> std::ofstream &;
+
+
+        template <typename ...Ts>
+        static void decode(Logger & lgr, char const* format, std::byte const* args)
+        {
+            auto offset = std::size_t{ 0u };
+
+            // Each argument is rebuilt in a local copy, because the bytes in the record aren't aligned.
+            ((format = print_argument<Ts>(lgr, format, args, offset)), ...);
+
+            print_text(lgr, format);
+        }
+
+        template <typename T>
+        static auto print_argument(Logger & lgr, char const* format, std::byte const* args, std::size_t & offset) -> char const*
+        {
+            auto const placeholder = std::strstr(format, "{}");
+            if (!placeholder)
+            {
+                print_text(lgr, format);
+                return format + std::strlen(format);
+            }
+
+            lgr << std::string(format, placeholder);
+
+            std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+            std::memcpy(&storage, args + offset, sizeof(T));
+            offset += sizeof(T);
+
+            lgr << *std::launder(reinterpret_cast<T const*>(&storage));
+
+            return placeholder + 2;
+        }
+
+        static void print_text(Logger & lgr, char const* text) { lgr << std::string{ text }; }
+};
+
+
+inline auto g_async_log = AsyncLog{};
+
+
+////
+//	A string buffer that hands its content to g_async_log each time it's synchronized (e.g. by std::endl), when it grows over
+//	flush_threshold or when its thread logs a formatted record on the same channel, so that a Logger built on it never writes on 
+//	file by itself. There should be at most one for each channel in each thread (see log_streams.hh).
+////
+class AsyncLogBuffer : public std::stringbuf
+{
+    public:
+        static std::size_t constexpr flush_threshold = 4096u;
+
+        AsyncLogBuffer(LogChannel const channel) : m_channel{ channel } 
+        { 
+            AsyncLog::thread_buffer(m_channel) = this; 
+        }
+
+        ~AsyncLogBuffer() override 
+        { 
+            sync(); 
+
+            if (AsyncLog::thread_buffer(m_channel) == this) { AsyncLog::thread_buffer(m_channel) = nullptr; }
+        }
+
+        int sync() override
+        {
+            if (pptr() != pbase())
+            {
+                g_async_log.log_text(m_channel, this->str());
+
+                this->str({});
+            }
+
+            return 0;
+        }
+
+    protected:
+        auto overflow(int_type const ch) -> int_type override
+        {
+            if (static_cast<std::size_t>(pptr() - pbase()) >= flush_threshold)
+            {
+                sync();
+            }
+
+            return std::stringbuf::overflow(ch);
+        }
+
+    private:
+        LogChannel m_channel;
+};
+
+
+
+} // namespace tgm
+
+
+////
+//	Record an async log on @channel (a LogChannel enumerator). The format string gets its own static LogFormat, whose address is the id
+//	of the format.
+////
+#define ASYNC_LOG(channel, format_literal, ...)											\
+    do																					\
+    {																					\
+        static ::tgm::LogFormat const async_log_format{ format_literal };				\
+        ::tgm::g_async_log.log(::tgm::LogChannel::channel, async_log_format, ##__VA_ARGS__);	\
+    } while (false)
+
+
+#endif //GM_ASYNC_LOG_HH
\ No newline at end of file
@@ -7,8 +7,8 @@
 #include <sstream>
 
 // This file will be included in almost all headers. So keep its dependencies at the minimum to avoid circular dependencies.
+#include "debug/logger/async_log.hh"
 #include "debug/logger/debug_printers.hh"
-#include "debug/logger/log_buffer.hh"
 #include "debug/logger/logger.hh"
 #include "settings/debug/debug_settings.hh"
 
@@ -18,22 +18,32 @@ namespace tgm
 
 
 
-inline auto g_log = std::ostream{ &g_log_buffer };
+// Thread-local, so that the simulations running on different threads can log without any data race. The text is written on the 
+// console and on file by the writer thread of g_async_log (general channel).
+inline thread_local auto g_log_buffer = AsyncLogBuffer{ LogChannel::general };
+inline thread_local auto g_log = std::ostream{ &g_log_buffer };
 
 
 #if DEBUGLOG
+    // These loggers format their messages in the calling thread (each thread has its own), but the file I/O is done by the writer
+    // thread of g_async_log. Their channels can be muted at runtime through g_async_log.enable().
+
     #if BUILDEXP_DEBUGLOG
-        auto create_building_expansion_log_stream() -> std::ofstream;
-        inline auto g_be_log_stream = create_building_expansion_log_stream();
-        inline Logger BElog{ g_be_log_stream };
+        inline thread_local auto g_be_log_buffer = AsyncLogBuffer{ LogChannel::building_expansion };
+        inline thread_local auto g_be_log_stream = std::ostream{ &g_be_log_buffer };
+        inline thread_local Logger BElog{ g_be_log_stream, g_async_log.enabled_flag(LogChannel::building_expansion) };
     #endif
 
     #if PLAYERMOVEMENT_DEBUGLOG
-        inline Logger PMlog{ g_log };
+        inline thread_local auto g_pm_log_buffer = AsyncLogBuffer{ LogChannel::player_movement };
+        inline thread_local auto g_pm_log_stream = std::ostream{ &g_pm_log_buffer };
+        inline thread_local Logger PMlog{ g_pm_log_stream, g_async_log.enabled_flag(LogChannel::player_movement) };
     #endif
 
     #if VISUALDEBUG_DEBUGLOG
-        inline Logger VDlog{ g_log };
+        inline thread_local auto g_vd_log_buffer = AsyncLogBuffer{ LogChannel::visual_debug };
+        inline thread_local auto g_vd_log_stream = std::ostream{ &g_vd_log_buffer };
+        inline thread_local Logger VDlog{ g_vd_log_stream, g_async_log.enabled_flag(LogChannel::visual_debug) };
     #endif
 #endif //DEBUGLOG
 
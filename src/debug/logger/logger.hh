@@ -2,6 +2,7 @@
 #define GM_LOGGER_HH
 
 
+#include <atomic>
 #include <functional>
 #include <ostream>
 #include <string>
@@ -19,12 +20,21 @@ class Logger
         Logger(std::ostream & output_stream) :
             out(output_stream) { }
 
+        ////
+        //	@enabled: While it's false, the messages are discarded without being formatted.
+        ////
+        Logger(std::ostream & output_stream, std::atomic<bool> const& enabled) :
+            out(output_stream), m_enabled(&enabled) { }
+
         Logger(Logger const&) = delete;
         Logger& operator=(Logger const&) = delete;
 
+        bool muted() const noexcept { return m_enabled && !m_enabled->load(std::memory_order_relaxed); }
+
         template<typename T>
         void print_byVal(T message)
         {
+            if (muted()) { return; }
             if (!out) { throw std::runtime_error("Cannot record a message: the stream is in an error state."); }
 
             out << message;
@@ -33,6 +43,7 @@ class Logger
         template<typename T>
         void print_byRef(T const& message)
         {
+            if (muted()) { return; }
             if (!out) { throw std::runtime_error("Cannot record a message: the stream is in an error state."); }
 
             out << message;
@@ -41,6 +52,7 @@ class Logger
         using ostreamManipulator = std::ostream& (*)(std::ostream&);//std::add_pointer_t<std::ostream& (std::ostream&)>;
         void apply_ostreamManipulator(ostreamManipulator manip)
         {
+            if (muted()) { return; }
             if (!out) { throw std::runtime_error("Cannot apply a manip: the stream is in an error state."); }
 
             manip(out);
@@ -49,6 +61,8 @@ class Logger
 
         static auto tabs(Logger& logger) -> Logger&
         {
+            if (logger.muted()) { return logger; }
+
             for (unsigned i = 0; i < logger.indent_count; ++i)
                 logger.out << '\t';
 
@@ -59,6 +73,8 @@ class Logger
         ////
         static auto nltb(Logger& logger) -> Logger&
         {
+            if (logger.muted()) { return logger; }
+
             logger.out << "\n";
 
             tabs(logger);
@@ -93,6 +109,7 @@ class Logger
     private:
         unsigned indent_count = 0;
         std::ostream & out;
+        std::atomic<bool> const* m_enabled = nullptr;	//nullptr if the Logger can't be muted
 };
 
 
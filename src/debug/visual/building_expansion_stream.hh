@@ -11,7 +11,9 @@
 namespace tgm
 {
 
-inline BuildingExpansionVisualDebug BEdeb;
+// Each thread running a simulation has its own instance, which is started and stopped by the BuildingManager of that simulation.
+// So a thread can run only one GameMap at a time.
+inline thread_local BuildingExpansionVisualDebug BEdeb;
 
 }
 
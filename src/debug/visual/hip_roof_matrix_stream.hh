@@ -12,7 +12,8 @@
 namespace tgm
 {
 
-inline HipRoofMatrixVisualDebug HRMdeb;
+// Thread-local for the same reason of BEdeb.
+inline thread_local HipRoofMatrixVisualDebug HRMdeb;
 
 }
 
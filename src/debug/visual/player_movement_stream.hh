@@ -11,7 +11,8 @@
 namespace tgm
 {
 
-inline PlayerMovementVisualDebug PMdeb;
+// Thread-local for the same reason of BEdeb (it's started and stopped by the GameMap).
+inline thread_local PlayerMovementVisualDebug PMdeb;
 
 }
 
@@ -17,7 +17,7 @@ Game::Game()
     , m_graphics_manager{ m_main_window.fbo_size(), m_main_window.window_size(), m_tile_vertices, &m_dynamic_vertices, m_roof_vertices, m_camera }
     , m_dynamic_manager{ &m_camera, m_dynamic_vertices }
     //TODO: NOW: Vorrei che la constness delle varie dipendenze rifletta il fatto che vengano modificate o meno dal dipendente (usa tecnica puntatori vista su Stackoverflow)
-    , m_map{ sim_settings.test_seed, m_dynamic_manager, m_camera, m_tile_graphics_mediator, m_roof_graphics_mediator, m_audio_manager, m_gui_events }
+    , m_map{ m_sim_context, m_sim_context.settings.test_seed, m_dynamic_manager, m_camera, m_tile_graphics_mediator, m_roof_graphics_mediator, m_audio_manager, m_gui_events }
     , m_tile_graphics_manager{ m_tile_graphics_mediator, m_tile_vertices }
     , m_roof_graphics_manager{ m_roof_graphics_mediator, m_roof_vertices }
     , m_demo_tutorial{ m_audio_manager }
@@ -157,7 +157,7 @@ void Game::tick_rendering()
 
 #if ENABLE_IMGUI
     m_main_window.activate_imguiCanvas();
-    m_gui_manager.generate_layout(m_map, m_camera, m_camera_controller, m_fps_counter, m_ups_counter, m_main_loop_data, inputCounter);
+    m_gui_manager.generate_layout(m_map, m_camera, m_camera_controller, m_fps_counter, m_ups_counter, m_main_loop_data, inputCounter, m_graphics_manager.tileCulling_stats());
 #endif //ENABLE_IMGUI
 
     m_main_window.display(m_main_loop_data);
@@ -169,6 +169,7 @@ void Game::tick_input()
     m_main_loop_data.input_begin();
 
     m_main_window.poll_events();
+    MainWindow::resolve_tilePickings(m_main_window_objects);
     m_camera_controller.update_camera(m_input_clock.getElapsedTime().asSeconds(), m_camera);
     m_input_clock.restart();
     m_main_loop_data.input_end();
@@ -50,7 +50,8 @@ class Game
 
         TileVertices m_tile_vertices{};
         DynamicVertices m_dynamic_vertices;
-        RoofVertices m_roof_vertices{};
+        SlotManager m_edgeable_ids = FreeTriangleVertices::create_edgeableIds();
+        RoofVertices m_roof_vertices{ m_edgeable_ids };
 
         Camera m_camera{};
 
@@ -60,7 +61,8 @@ class Game
         TileGraphicsMediator m_tile_graphics_mediator{};
         RoofGraphicsMediator m_roof_graphics_mediator{};
         GuiEventQueues m_gui_events{};
-    
+
+        SimulationContext m_sim_context{};
         GameMap m_map;
 
         TileGraphicsManager m_tile_graphics_manager;
@@ -480,7 +480,7 @@ namespace HipRoofAlgorithm
     #pragma warning(disable: 4702)
     void oldTest_roofPerimeterTileType_specialCases(GameMap & map, RoofVertices & roof_vertices)
     {
-        if (sim_settings.map.generate_roofs) { throw std::runtime_error("Cannot perform the test if roof generation is active."); }
+        if (map.simulation_context().settings.map.generate_roofs) { throw std::runtime_error("Cannot perform the test if roof generation is active."); }
 
         if (map.tiles().length() < 100 || map.tiles().width() < 150 || map.tiles().height() < 1)
         {
@@ -594,27 +594,27 @@ namespace HipRoofAlgorithm
 
         roof_vertices.clear();
 
-        auto const roofable_poss = RoofAlgorithm::compute_roofablePositions_fromArea({ last_bid, random_aid }, map.debug_get_buildings(), map.tiles());
+        auto const roofable_poss = RoofAlgorithm::compute_roofablePositions_fromArea({ last_bid, random_aid }, map.debug_get_buildings(), map.tiles(), map.simulation_context().settings.map.roof_every_area);
         auto const polygons = HipRoofAlgorithm::generate_hipRoof({ roofable_poss.cbegin(), roofable_poss.cend() }, sim_settings.map.ground_floor, map.tiles().length(), map.tiles().width());
             
         for (auto const& p : polygons.south)
         {
-            roof_vertices.south_roof.create_polygon(p);
+            roof_vertices.create_polygon(p, RoofOrientation::South);
         }
 
         for (auto const& p : polygons.west)
         {
-            roof_vertices.west_roof.create_polygon(p);
+            roof_vertices.create_polygon(p, RoofOrientation::West);
         }
 
         for (auto const& p : polygons.north)
         {
-            roof_vertices.north_roof.create_polygon(p);
+            roof_vertices.create_polygon(p, RoofOrientation::North);
         }
 
         for (auto const& p : polygons.east)
         {
-            roof_vertices.east_roof.create_polygon(p);
+            roof_vertices.create_polygon(p, RoofOrientation::East);
         }
 
         #if BUILDEXP_VISUALDEBUG
@@ -743,7 +743,7 @@ namespace HipRoofAlgorithm
 #pragma warning(disable: 4702)
     void test_polygons_specialCases(GameMap & map, RoofVertices & roof_vertices)
     {
-        if (sim_settings.map.generate_roofs) { throw std::runtime_error("Cannot perform the test if roof generation is active."); }
+        if (map.simulation_context().settings.map.generate_roofs) { throw std::runtime_error("Cannot perform the test if roof generation is active."); }
             
         if (map.tiles().length() < 100 || map.tiles().width() < 150 || map.tiles().height() < 1)
         {
@@ -816,27 +816,27 @@ namespace HipRoofAlgorithm
 
         roof_vertices.clear();
 
-        auto const roofable_poss = RoofAlgorithm::compute_roofablePositions_fromArea({ last_bid, random_aid }, map.debug_get_buildings(), map.tiles());
+        auto const roofable_poss = RoofAlgorithm::compute_roofablePositions_fromArea({ last_bid, random_aid }, map.debug_get_buildings(), map.tiles(), map.simulation_context().settings.map.roof_every_area);
         auto const polygons = HipRoofAlgorithm::generate_hipRoof({ roofable_poss.cbegin(), roofable_poss.cend() }, sim_settings.map.ground_floor, map.tiles().length(), map.tiles().width());
                     
         for (auto const& p : polygons.south)
         {
-            roof_vertices.south_roof.create_polygon(p);
+            roof_vertices.create_polygon(p, RoofOrientation::South);
         }
 
         for (auto const& p : polygons.west)
         {
-            roof_vertices.west_roof.create_polygon(p);
+            roof_vertices.create_polygon(p, RoofOrientation::West);
         }
 
         for (auto const& p : polygons.north)
         {
-            roof_vertices.north_roof.create_polygon(p);
+            roof_vertices.create_polygon(p, RoofOrientation::North);
         }
 
         for (auto const& p : polygons.east)
         {
-            roof_vertices.east_roof.create_polygon(p);
+            roof_vertices.create_polygon(p, RoofOrientation::East);
         }
 
 
@@ -856,7 +856,7 @@ namespace HipRoofAlgorithm
     //TODO: 01: Fai partire questi test automatici (anche provando diverse dimensioni della mappa)
     void automatically_test_building_expansion(GameMap & map)
     {
-        if (!sim_settings.map.generate_roofs) { throw std::runtime_error("Switch on 'MapSettings::generate_roofs' before launching this test."); }
+        if (!map.simulation_context().settings.map.generate_roofs) { throw std::runtime_error("Switch on 'MapSettings::generate_roofs' before launching this test."); }
 
         #if HIPROOFMATRIX_VISUALDEBUG
             throw std::runtime_error("Switch off HIPROOFMATRIX_VISUALDEBUG before launching this test.");
@@ -0,0 +1,146 @@
+#include "tile_frustum_culler.hh"
+
+
+#include <algorithm>
+#include <limits>
+
+#include "graphics/culling/view_frustum.hh"
+#include "system/clock.hh"
+
+
+namespace tgm
+{
+
+
+
+void TileFrustumCuller::reset(TileVertices const& tile_vertices)
+{
+    m_cells.clear();
+    m_rows.clear();
+    m_commands.clear();
+    m_stats = FrustumCullingStats{};
+
+    auto const vertices = tile_vertices.get_ptr();
+    auto const tile_vertCount = static_cast<GLuint>(TileVertices::tile_verticesCount());
+
+    auto const row_tileCount = static_cast<GLuint>(tile_vertices.map_length());
+    auto const row_count = static_cast<GLuint>(tile_vertices.map_width()) * static_cast<GLuint>(tile_vertices.map_height());
+    auto const cell_tileCount = static_cast<GLuint>(GSet::frustumCullingCell_inTiles);
+
+    m_rows.reserve(row_count);
+    m_cells.reserve(static_cast<std::vector<CullingCell>::size_type>(row_count) * ((row_tileCount + cell_tileCount - 1) / cell_tileCount));
+
+    for (auto r = 0u; r < row_count; ++r)
+    {
+        auto const row_first = r * row_tileCount * tile_vertCount;
+        auto const first_cell = m_cells.size();
+
+        for (auto t = 0u; t < row_tileCount; t += cell_tileCount)
+        {
+            auto const first = row_first + t * tile_vertCount;
+            auto const count = std::min(cell_tileCount, row_tileCount - t) * tile_vertCount;
+
+            m_cells.push_back({ compute_box(vertices + first, count), first, count });
+        }
+
+        auto row_box = m_cells[first_cell].box;
+        for (auto c = first_cell + 1; c < m_cells.size(); ++c)
+        {
+            row_box = merge_boxes(row_box, m_cells[c].box);
+        }
+
+        m_rows.push_back({ row_box, first_cell, m_cells.size() - first_cell });
+    }
+
+    m_commands.reserve(m_cells.size());
+
+    m_stats.total_cells = static_cast<unsigned>(m_cells.size());
+    m_stats.total_vertices = tile_vertices.vertices_count();
+}
+
+
+auto TileFrustumCuller::cull(glm::mat4 const& view_projection) -> std::vector<DrawArraysIndirectCommand> const&
+{
+    auto clock = Clock{};
+
+    m_commands.clear();
+    m_stats.tested_cells = 0u;
+    m_stats.visible_cells = 0u;
+    m_stats.visible_vertices = 0;
+
+    auto const frustum = ViewFrustum{ view_projection };
+
+    for (auto const& row : m_rows)
+    {
+        if (!frustum.intersects(row.box)) { continue; }
+
+        auto const cells_end = row.first_cell + row.cell_count;
+        for (auto c = row.first_cell; c < cells_end; ++c)
+        {
+            ++m_stats.tested_cells;
+
+            auto const& cell = m_cells[c];
+            if (frustum.intersects(cell.box))
+            {
+                push_cell(cell);
+            }
+        }
+    }
+
+    m_stats.draw_commands = static_cast<unsigned>(m_commands.size());
+    m_stats.culling_time = clock.getElapsedTime().asMicroseconds();
+
+    return m_commands;
+}
+
+
+void TileFrustumCuller::push_cell(CullingCell const& cell)
+{
+    ++m_stats.visible_cells;
+    m_stats.visible_vertices += cell.count;
+
+    if (!m_commands.empty())
+    {
+        auto & last = m_commands.back();
+        if (last.first + last.count == cell.first)
+        {
+            last.count += cell.count;
+            return;
+        }
+    }
+
+    m_commands.push_back({ cell.count, 1u, cell.first, 0u });
+}
+
+
+auto TileFrustumCuller::compute_box(TilesetVertexData const* first, GLuint const count) -> WorldParallelepiped
+{
+    auto min = glm::vec3{ std::numeric_limits<float>::max() };
+    auto max = glm::vec3{ std::numeric_limits<float>::lowest() };
+
+    for (auto v = first; v != first + count; ++v)
+    {
+        auto const pos = glm::vec3{ v->world_pos[0], v->world_pos[1], v->world_pos[2] };
+        min = glm::min(min, pos);
+        max = glm::max(max, pos);
+    }
+
+    return { min.x, min.y, min.z, max.x - min.x, max.y - min.y, max.z - min.z };
+}
+
+
+auto TileFrustumCuller::merge_boxes(WorldParallelepiped const& lhs, WorldParallelepiped const& rhs) -> WorldParallelepiped
+{
+    auto const left  = std::min(lhs.left,  rhs.left);
+    auto const front = std::min(lhs.front, rhs.front);
+    auto const down  = std::min(lhs.down,  rhs.down);
+
+    return { left, front, down,
+             std::max(lhs.right(),  rhs.right())  - left,
+             std::max(lhs.behind(), rhs.behind()) - front,
+             std::max(lhs.up(),     rhs.up())     - down };
+}
+
+
+
+} // namespace tgm
\ No newline at end of file
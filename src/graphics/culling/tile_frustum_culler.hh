@@ -0,0 +1,104 @@
+#ifndef GM_TILE_FRUSTUM_CULLER_HH
+#define GM_TILE_FRUSTUM_CULLER_HH
+
+
+#include <vector>
+
+#include <glad/glad.h>
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+
+#include "graphics/opengl/draw_arrays_indirect_command.hh"
+#include "graphics/tile_vertices.hh"
+#include "graphics/world_parallelepiped.hh"
+
+
+namespace tgm
+{
+
+
+
+struct FrustumCullingStats
+{
+    unsigned total_cells = 0u;			// Cells in which the tile buffer is split
+    unsigned tested_cells = 0u;			// Cells tested against the frustum (the cells of a row outside the frustum aren't tested one by one)
+    unsigned visible_cells = 0u;		// Cells intersecting the frustum
+    unsigned draw_commands = 0u;		// Commands of the last multi-draw call (adjacent visible cells are merged in a single command)
+    long long visible_vertices = 0;
+    long long total_vertices = 0;
+    long long culling_time = 0;			// Time spent by the last culling (in microseconds)
+};
+
+
+////
+//
+//	Split the buffer of TileVertices in cells of contiguous vertices and, each frame, select the cells intersecting the view frustum.
+//	A cell is a run of GSet::frustumCullingCell_inTiles tiles on the same row of the map, so that it's both contiguous in the buffer and
+//	compact in the world space. The cells are also grouped by row, so that a whole row outside the frustum is discarded with a single test.
+//
+////
+class TileFrustumCuller
+{
+    public:
+        ////
+        //	Compute the bounding boxes of the cells. It must be called every time the TileVertices are reset (the positions of the
+        //	vertices never change afterwards, only their texture coordinates do).
+        ////
+        void reset(TileVertices const& tile_vertices);
+
+        ////
+        //	@view_projection: "projection * view" matrix used to draw the scene.
+        //
+        //	@return: The draw commands covering only the visible ranges of the tile buffer, sorted by their first vertex.
+        ////
+        auto cull(glm::mat4 const& view_projection) -> std::vector<DrawArraysIndirectCommand> const&;
+
+        ////
+        //	Maximum number of commands that cull() can ever return.
+        ////
+        auto max_commandCount() const noexcept { return m_cells.size(); }
+
+        auto stats() const noexcept -> FrustumCullingStats const& { return m_stats; }
+
+    private:
+        struct CullingCell
+        {
+            WorldParallelepiped box;
+            GLuint first;		// First vertex of the cell
+            GLuint count;		// Number of vertices of the cell
+        };
+
+        struct CullingRow
+        {
+            WorldParallelepiped box;
+            std::vector<CullingCell>::size_type first_cell;
+            std::vector<CullingCell>::size_type cell_count;
+        };
+
+        std::vector<CullingCell> m_cells;
+        std::vector<CullingRow> m_rows;
+
+        std::vector<DrawArraysIndirectCommand> m_commands;
+
+        FrustumCullingStats m_stats{};
+
+
+        ////
+        //	Append the vertices of @cell to the last command, or start a new command if they aren't adjacent.
+        ////
+        void push_cell(CullingCell const& cell);
+
+        ////
+        //	@return: The bounding box of the vertices in [@first, @first + @count).
+        ////
+        static auto compute_box(TilesetVertexData const* first, GLuint const count) -> WorldParallelepiped;
+
+        static auto merge_boxes(WorldParallelepiped const& lhs, WorldParallelepiped const& rhs) -> WorldParallelepiped;
+};
+
+
+
+} // namespace tgm
+
+
+#endif //GM_TILE_FRUSTUM_CULLER_HH
\ No newline at end of file
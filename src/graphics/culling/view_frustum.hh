@@ -0,0 +1,79 @@
+#ifndef GM_VIEW_FRUSTUM_HH
+#define GM_VIEW_FRUSTUM_HH
+
+
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+
+#include "graphics/world_parallelepiped.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//
+//	The six planes bounding the volume framed by the camera (OpenGL world space reference system).
+//
+////
+class ViewFrustum
+{
+    public:
+        ////
+        //	Extract the planes from the combined matrix, following the Gribb-Hartmann method. It works both for perspective and for
+        //	orthogonal projections.
+        //	@view_projection: "projection * view" matrix (the same one applied to the vertices in the vertex shader).
+        ////
+        explicit ViewFrustum(glm::mat4 const& view_projection)
+        {
+            // glm matrices are column-major, so "m[c][r]" is the element in column "c" and row "r".
+            auto const& m = view_projection;
+            auto const row = [&m](int const r) { return glm::vec4{ m[0][r], m[1][r], m[2][r], m[3][r] }; };
+
+            auto const r0 = row(0);
+            auto const r1 = row(1);
+            auto const r2 = row(2);
+            auto const r3 = row(3);
+
+            m_planes[0] = r3 + r0;	// left
+            m_planes[1] = r3 - r0;	// right
+            m_planes[2] = r3 + r1;	// bottom
+            m_planes[3] = r3 - r1;	// top
+            m_planes[4] = r3 + r2;	// near
+            m_planes[5] = r3 - r2;	// far
+        }
+
+        ////
+        //	@return: False only if @box lies completely outside the frustum. The test is conservative: a box near a corner of the frustum
+        //			 could be reported as intersecting even if it isn't.
+        ////
+        bool intersects(WorldParallelepiped const& box) const noexcept
+        {
+            for (auto const& p : m_planes)
+            {
+                // The vertex of the box that lies farthest along the normal of the plane (the "positive vertex").
+                auto const px = p.x >= 0.f ? box.right()  : box.left;
+                auto const py = p.y >= 0.f ? box.behind() : box.front;
+                auto const pz = p.z >= 0.f ? box.up()     : box.down;
+
+                if (p.x * px + p.y * py + p.z * pz + p.w < 0.f)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        glm::vec4 m_planes[6];
+};
+
+
+
+} // namespace tgm
+
+
+#endif //GM_VIEW_FRUSTUM_HH
\ No newline at end of file
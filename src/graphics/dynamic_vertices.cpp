@@ -47,6 +47,8 @@ auto DynamicVertices::create_sprite(WorldParallelepiped const volume, TextureSub
         internal_setSprite(&m_attributes[attribute0_id], volume, subimage);
     }
 
+    m_changed_slots.mark(slot);
+
     return new_id;
 }
 
@@ -60,6 +62,8 @@ void DynamicVertices::set_sprite(SpriteId const id, WorldParallelepiped const vo
         auto const attribute0_id = static_cast<decltype(m_attributes)::size_type>(*slot) * aps;  // id of the first attribute of the slot
 
         internal_setSprite(&m_attributes[attribute0_id], volume, subimage);
+
+        m_changed_slots.mark(*slot);
     }
 }
 
@@ -73,10 +77,33 @@ void DynamicVertices::destroy(SpriteId const id)
         auto const attribute0_id = static_cast<decltype(m_attributes)::size_type>(*slot) * aps;  // id of the first attribute of the slot
 
         internal_setSprite(&m_attributes[attribute0_id], { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f }, { 0.f, 0.f, 0.f, 0.f, default_texture_dynamics });
+
+        m_changed_slots.mark(*slot);
     }
 }
 
 
+auto DynamicVertices::get_changes() const -> std::vector<AttributesChange>
+{
+    auto const merged_slots = m_changed_slots.merged(max_mergedGap);
+
+    auto changes = std::vector<AttributesChange>{};
+    changes.reserve(merged_slots.size());
+
+    for (auto const& [first, last] : merged_slots)
+    {
+        auto const attribute0_id = static_cast<decltype(m_attributes)::size_type>(first) * aps;
+        auto const attribute_count = static_cast<decltype(m_attributes)::size_type>(last - first) * aps;
+
+        changes.push_back({ static_cast<GLintptr>(attribute0_id * sizeof(float)),
+                            static_cast<GLsizeiptr>(attribute_count * sizeof(float)),
+                            &m_attributes[attribute0_id] });
+    }
+
+    return changes;
+}
+
+
 //TODO: Update this old system to the new system where each dynamic sprite consists of two sprites (one oblique and one parallel to the floor), that way the competition
 //		among sprites would become perfect.
 void DynamicVertices::internal_setSprite(float *const a, WorldParallelepiped const volume, TextureSubimage const& subimage)
@@ -7,6 +7,9 @@
 #include <iostream>
 #include <vector>
 
+#include <glad/glad.h>
+
+#include "data_strctures/changed_slot_ranges.hh"
 #include "data_strctures/slot_manager.hh"
 #include "graphics/world_parallelepiped.hh"
 #include "graphics/dynamic_subimage.hh"
@@ -31,6 +34,17 @@ class DynamicVertices
     public:
         using size_type = uint32_t;
 
+        ////
+        //	A range of attributes that changed since the last flush, ready to be passed to glBufferSubData.
+        ////
+        struct AttributesChange
+        {
+            GLintptr offset;				//offset of the range from the start of the buffer (in bytes)
+            GLsizeiptr byte_size;
+            float const* ptr;				//pointer to the first attribute of the range
+        };
+
+
         DynamicVertices(size_type const max_size);
 
         DynamicVertices(DynamicVertices const&) = delete;
@@ -39,6 +53,31 @@ class DynamicVertices
         auto attribute_count() const { return m_attributes.size(); }
         auto vertices_count() const { return static_cast<int>(m_attributes.size() / 5); } //conversion needed because OpenGL require it to be a GLsizei
         auto get_ptr() const { return m_attributes.data(); }
+
+        ////
+        //	Size of the buffer (in bytes).
+        ////
+        auto buffer_byteSize() const { return static_cast<GLsizeiptr>(m_attributes.size() * sizeof(float)); }
+        ////
+        //	Size of the buffer (in bytes) when all the sprite slots are in use. The VBO is allocated with this size, so that it never 
+        //	needs to be reallocated when sprites are added.
+        ////
+        auto capacity_byteSize() const { return static_cast<GLsizeiptr>(m_slot_mgr.capacity()) * aps * sizeof(float); }
+
+        ////
+        //	Indicate whether any sprite has been created, modified or destroyed since the last flush.
+        ////
+        bool has_changed() const { return !m_changed_slots.empty(); }
+
+        ////
+        //	@return: The ranges of attributes changed since the last flush, sorted by offset.
+        ////
+        auto get_changes() const -> std::vector<AttributesChange>;
+
+        ////
+        //	Make DynamicVertices aware that the changed attributes have been loaded in the GPU memory.
+        ////
+        void flushed() { m_changed_slots.clear(); }
         
         ////
         //	Create a sprite that starting from the base of the front volume raise diagonally for an height that depends on the dimension of the subimage.
@@ -65,11 +104,15 @@ class DynamicVertices
 
         SlotManager m_slot_mgr;
 
+        ChangedSlotRanges m_changed_slots;					//ranges of sprite slots changed since the last flush
+
 
         static int constexpr triangles_per_sprite = 2;
         static int constexpr vertices_per_triangle = 3;
         static int constexpr attributes_per_vertex = 5;
         static int constexpr aps = triangles_per_sprite * vertices_per_triangle * attributes_per_vertex;
+
+        static constexpr SlotId max_mergedGap = 4u; //see ChangedSlotRanges::merged()
         
         
         ////
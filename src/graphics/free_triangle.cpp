@@ -17,6 +17,7 @@ auto operator<<(Logger & lgr, FreeTriangle const& ft) -> Logger &
         << Logger::nltb << "v0: " << ft.m_v0
         << Logger::nltb << "v1: " << ft.m_v1
         << Logger::nltb << "v2: " << ft.m_v2
+        << Logger::nltb << "normal: " << ft.m_normal
         << Logger::nltb << "entity_id: " << ft.m_entity_id
         << Logger::nltb << "edgeable_id: " << ft.m_edgeable_id
         << Logger::remt
@@ -25,15 +25,18 @@ class FreeTriangle
         ////
         //	@pos: Position of the triangle in the map (in units -- map reference system).
         //  @v0: Relative position of the vertex from @pos (in units). 
+        //	@normal: Normal of the surface the triangle belongs to (OpenGL world space RS), used to compute the diffuse lighting.
         //  Note: The position of each vertex is split in two components because only @pos will be shifted according to the world floor rules. 
         //		  The vertices are freely positioned.
         ////
         FreeTriangle(Vector3f const pos,
                      FreeVertex const v0, FreeVertex const v1, FreeVertex const v2,
+                     Vector3f const normal,
                      GLuint const entity_id,
                      GLuint const edgeable_id) noexcept :
             m_pos{pos},
             m_v0{v0}, m_v1{v1}, m_v2{v2},
+            m_normal{normal},
             m_entity_id{entity_id},
             m_edgeable_id{edgeable_id}
         {}
@@ -44,6 +47,8 @@ class FreeTriangle
         auto v1() const noexcept -> FreeVertex { return m_v1; }
         auto v2() const noexcept -> FreeVertex { return m_v2; }
 
+        auto normal() const noexcept -> Vector3f { return m_normal; }
+
         auto entity_id() const noexcept -> GLuint { return m_entity_id; }
         auto edgeable_id() const noexcept -> GLuint { return m_edgeable_id; }
 
@@ -56,6 +61,8 @@ class FreeTriangle
         FreeVertex m_v1;
         FreeVertex m_v2;
 
+        Vector3f m_normal;
+
         GLuint m_entity_id = 0u;	//id used in the occlusion culling to decide whether this triangle have to be drawn or not
 
         GLuint m_edgeable_id = 0u;	//id used in the edge-detection filter to identify triangles that belongs to the same surface (between them no edge must be drawn)
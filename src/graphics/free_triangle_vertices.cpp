@@ -1,5 +1,6 @@
 #include "free_triangle_vertices.hh"
 
+#include <algorithm>
 #include <array>
 #include "mapbox/earcut.hpp"
 
@@ -12,7 +13,8 @@ namespace tgm
 auto operator<<(Logger & lgr, EdgeableVertexData const& evd) -> Logger &
 {
     lgr << "EdgeableVertexData{ (" << std::setw(5) << evd.world_pos[0] << ", " << std::setw(5) << evd.world_pos[1] << ", " << std::setw(5) << evd.world_pos[2] << "), ("
-        << std::setprecision(6) << std::setw(8) <<  evd.tex_coords[0] << ", " << std::setprecision(6) << std::setw(8) << evd.tex_coords[1] << "), "
+        << std::setprecision(6) << std::setw(8) <<  evd.tex_coords[0] << ", " << std::setprecision(6) << std::setw(8) << evd.tex_coords[1] << "), ("
+        << std::setw(5) << evd.normal[0] << ", " << std::setw(5) << evd.normal[1] << ", " << std::setw(5) << evd.normal[2] << "), "
         << std::setw(6) << evd.entity_id << ", " << std::setw(6) << evd.edgeable_id << " }";
 
     return lgr;
@@ -21,8 +23,8 @@ auto operator<<(Logger & lgr, EdgeableVertexData const& evd) -> Logger &
 
 
 
-FreeTriangleVertices::FreeTriangleVertices(size_type const max_size, Texture2D & texture) 
-    : m_slot_mgr(max_size), m_poly_to_triangles(max_size / 2), m_texture(texture)
+FreeTriangleVertices::FreeTriangleVertices(size_type const max_size, Texture2D & texture, SlotManager & edgeable_ids, bool const resizable) 
+    : m_resizable(resizable), m_slot_mgr(max_size), m_texture(texture), m_poly_to_triangles(max_size / 2), m_edgeable_ids(edgeable_ids)
 {
     auto const max_vertexSize = static_cast<decltype(m_vertices)::size_type>(max_size) * vpt;
 
@@ -42,13 +44,18 @@ FreeTriangleVertices::FreeTriangleVertices(size_type const max_size, Texture2D &
 }
 
 
-auto FreeTriangleVertices::create_polygon(FreePolygon const& polygon) -> DataArrayId
+auto FreeTriangleVertices::create_polygon(FreePolygon const& polygon, Vector3f const normal) -> DataArrayId
 {
 
+    if (m_resizable && m_edgeable_ids.full())
+    {
+        grow_edgeableIds();
+    }
+
     auto & el = m_poly_to_triangles.create();
     auto & triangle_set = el.value.triangle_ids;
 
-    auto const& [recycling, complete_edgId, slot_edgId] = edgeable_ids.create_id();
+    auto const& [recycling, complete_edgId, slot_edgId] = m_edgeable_ids.create_id();
     el.value.edgeable_id = complete_edgId;
 
 
@@ -78,7 +85,7 @@ auto FreeTriangleVertices::create_polygon(FreePolygon const& polygon) -> DataArr
         auto const tv1 = poly_vertices[earcut_indices[current + 1]];
         auto const tv2 = poly_vertices[earcut_indices[current + 2]];
 
-        triangle_set.push_back(create_triangle(FreeTriangle{ polygon.pos(), tv0, tv1, tv2, 0u, slot_edgId }));
+        triangle_set.push_back(create_triangle(FreeTriangle{ polygon.pos(), tv0, tv1, tv2, normal, 0u, slot_edgId }));
     }
 
     return el.id();
@@ -86,6 +93,11 @@ auto FreeTriangleVertices::create_polygon(FreePolygon const& polygon) -> DataArr
 
 auto FreeTriangleVertices::create_triangle(FreeTriangle const triangle) -> FreeTriangleId
 {
+    if (m_resizable && m_slot_mgr.full())
+    {
+        grow();
+    }
+
     auto [recycling, new_id, slot] = m_slot_mgr.create_id();
 
     if (recycling)
@@ -94,12 +106,12 @@ auto FreeTriangleVertices::create_triangle(FreeTriangle const triangle) -> FreeT
     }
     else
     {
-        m_vertices.insert(m_vertices.end(), vpt, {{0.f, 0.f, 0.f}, {0.f, 0.f}, 0u, 0u});
+        m_vertices.insert(m_vertices.end(), vpt, {{0.f, 0.f, 0.f}, {0.f, 0.f}, {0.f, 0.f, 0.f}, 0u, 0u});
 
         internal_setTriangle(slot, triangle);
     }
 
-    m_changed = true;
+    m_changed_slots.mark(slot);
 
     return new_id;
 }
@@ -113,7 +125,7 @@ void FreeTriangleVertices::set_triangle(FreeTriangleId const id, FreeTriangle co
     {
         internal_setTriangle(*slot, triangle);
 
-        m_changed = true;
+        m_changed_slots.mark(*slot);
     }
 }
 
@@ -122,7 +134,7 @@ void FreeTriangleVertices::destroy_polygon(FreePolygonId const fpid)
 {
     auto & poly_info = m_poly_to_triangles.get(fpid);
 
-    edgeable_ids.destroy_id(poly_info.edgeable_id);
+    m_edgeable_ids.destroy_id(poly_info.edgeable_id);
 
     for (auto const ftid : poly_info.triangle_ids)
     {
@@ -142,7 +154,7 @@ void FreeTriangleVertices::destroy(FreeTriangleId const id)
     {
         internal_setTriangle(*slot, FreeTriangle{});
 
-        m_changed = true;
+        m_changed_slots.mark(*slot);
     }
 }
 
@@ -171,6 +183,8 @@ void FreeTriangleVertices::internal_setTriangle(SlotId const triangle_slot, Free
     auto const v0_tex = compute_openGLTextureCoordinates(fv0, m_texture);
     auto const v1_tex = compute_openGLTextureCoordinates(fv1, m_texture);
     auto const v2_tex = compute_openGLTextureCoordinates(fv2, m_texture);
+
+    auto const normal = triangle.normal();
     
     
     auto const vertex0_id = static_cast<decltype(m_vertices)::size_type>(triangle_slot) * vpt;  // id of the first vertex of the triangle in m_vertices
@@ -184,6 +198,9 @@ void FreeTriangleVertices::internal_setTriangle(SlotId const triangle_slot, Free
     v0->world_pos[2] = v0_world.z;
     v0->tex_coords[0] = v0_tex.x;
     v0->tex_coords[1] = v0_tex.y;
+    v0->normal[0] = normal.x;
+    v0->normal[1] = normal.y;
+    v0->normal[2] = normal.z;
     v0->entity_id = triangle.entity_id();
     v0->edgeable_id = triangle.edgeable_id();
     
@@ -193,6 +210,9 @@ void FreeTriangleVertices::internal_setTriangle(SlotId const triangle_slot, Free
     v1->world_pos[2] = v1_world.z;
     v1->tex_coords[0] = v1_tex.x;
     v1->tex_coords[1] = v1_tex.y;
+    v1->normal[0] = normal.x;
+    v1->normal[1] = normal.y;
+    v1->normal[2] = normal.z;
     v1->entity_id = triangle.entity_id();
     v1->edgeable_id = triangle.edgeable_id();
     
@@ -202,11 +222,69 @@ void FreeTriangleVertices::internal_setTriangle(SlotId const triangle_slot, Free
     v2->world_pos[2] = v2_world.z;
     v2->tex_coords[0] = v2_tex.x;
     v2->tex_coords[1] = v2_tex.y;
+    v2->normal[0] = normal.x;
+    v2->normal[1] = normal.y;
+    v2->normal[2] = normal.z;
     v2->entity_id = triangle.entity_id();
     v2->edgeable_id = triangle.edgeable_id();
 }
 
 
+void FreeTriangleVertices::grow()
+{
+    auto const old_capacity = m_slot_mgr.capacity();
+
+    if (old_capacity == SlotManager::max_capacity) { throw std::runtime_error("Overflow: FreeTriangleVertices can't grow anymore."); }
+
+    auto const new_capacity = old_capacity > SlotManager::max_capacity / 2 ? SlotManager::max_capacity : std::max(old_capacity * 2, size_type{ 1u });
+
+    m_slot_mgr.set_capacity(new_capacity);
+
+    try
+    {
+        m_vertices.reserve(static_cast<decltype(m_vertices)::size_type>(new_capacity) * vpt);
+    }
+    catch (std::exception const& e)
+    {
+        std::ostringstream oss; oss << "No space in RAM for such a big triangle count. " << e.what();
+        throw std::runtime_error(oss.str());
+    }
+
+    m_resized = true;
+}
+
+void FreeTriangleVertices::grow_edgeableIds()
+{
+    auto const old_capacity = m_edgeable_ids.capacity();
+
+    if (old_capacity == SlotManager::max_capacity) { throw std::runtime_error("Overflow: the edgeable ids can't grow anymore."); }
+
+    auto const new_capacity = old_capacity > SlotManager::max_capacity / 2 ? SlotManager::max_capacity : std::max(old_capacity * 2, size_type{ 1u });
+
+    m_edgeable_ids.set_capacity(new_capacity);
+}
+
+auto FreeTriangleVertices::get_changes() const -> std::vector<VerticesChange>
+{
+    auto const merged_slots = m_changed_slots.merged(max_mergedGap);
+
+    auto changes = std::vector<VerticesChange>{};
+    changes.reserve(merged_slots.size());
+
+    for (auto const& [first, last] : merged_slots)
+    {
+        auto const vertex0_id = static_cast<decltype(m_vertices)::size_type>(first) * vpt;
+        auto const vertex_count = static_cast<decltype(m_vertices)::size_type>(last - first) * vpt;
+
+        changes.push_back({ static_cast<GLintptr>(vertex0_id * sizeof(EdgeableVertexData)),
+                            static_cast<GLsizeiptr>(vertex_count * sizeof(EdgeableVertexData)),
+                            &m_vertices[vertex0_id] });
+    }
+
+    return changes;
+}
+
+
 auto FreeTriangleVertices::compute_worldCoordinates(Vector3f const pos, FreeVertex const fv) -> Vector3f
 {
     // The map is subdivided in floors. Each floor in OpenGL world reference system is much taller than the floor in
@@ -237,9 +315,9 @@ auto FreeTriangleVertices::compute_openGLTextureCoordinates(FreeVertex const fv,
              (texture.height() - fv.tex_v)  /  texture.height()   };
 }
 
-auto FreeTriangleVertices::init_edgeableIds() -> SlotManager
+auto FreeTriangleVertices::create_edgeableIds() -> SlotManager
 {
-    SlotManager sm{ max_edgeableEntities };
+    SlotManager sm{ initial_edgeableEntities };
 
     // Create an unused id just to reserve the slot 0. An edgeable id mustn't be 0, because 0 is reserved for the background and 
     // for the entities that doesn't have any edge.
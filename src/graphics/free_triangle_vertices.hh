@@ -9,6 +9,7 @@
 
 #include <glad/glad.h>
 
+#include "data_strctures/changed_slot_ranges.hh"
 #include "data_strctures/slot_manager.hh"
 #include "data_strctures/data_array.hh"
 #include "dynamic_subimage.hh"
@@ -31,6 +32,7 @@ struct EdgeableVertexData
 {
     GLfloat world_pos[3];
     GLfloat tex_coords[2];
+    GLfloat normal[3];
     GLuint entity_id;
     GLuint edgeable_id;
 };
@@ -56,20 +58,70 @@ class FreeTriangleVertices
     public:
         using size_type = uint32_t;
 
-        FreeTriangleVertices(size_type const max_size, Texture2D & texture);
+        ////
+        //	A range of vertices that changed since the last flush, ready to be passed to glBufferSubData.
+        ////
+        struct VerticesChange
+        {
+            GLintptr offset;						//offset of the range from the start of the buffer (in bytes)
+            GLsizeiptr byte_size;
+            EdgeableVertexData const* ptr;			//pointer to the first vertex of the range
+        };
+
+
+        ////
+        //	@max_size: Maximum number of triangles. If @resizable is true, it's only the initial capacity: the capacity is doubled 
+        //			   every time a triangle is created while all the slots are in use.
+        //	@edgeable_ids: Ids assigned to the polygons to draw their edges. It must be shared by all the FreeTriangleVertices drawn in 
+        //				   the same scene (see create_edgeableIds()), and it must outlive them. If @resizable is true, its capacity is 
+        //				   doubled too when a polygon is created while all the ids are in use.
+        ////
+        FreeTriangleVertices(size_type const max_size, Texture2D & texture, SlotManager & edgeable_ids, bool const resizable = false);
+
+        ////
+        //	@return: A pool of edgeable ids for a scene, with an initial capacity of initial_edgeableEntities. The id 0 is already taken, 
+        //			 since it's reserved for the background and for the entities without edges.
+        ////
+        static auto create_edgeableIds() -> SlotManager;
 
         ////
         //	Size of the buffer (in bytes).
         ////
         auto buffer_byteSize() const { return m_vertices.size() * sizeof(EdgeableVertexData); }
+        ////
+        //	Size of the buffer (in bytes) when all the triangle slots are in use. The VBO is allocated once with this size, so that
+        //	it never needs to be reallocated when triangles are added.
+        ////
+        auto capacity_byteSize() const { return static_cast<GLsizeiptr>(m_slot_mgr.capacity()) * vpt * sizeof(EdgeableVertexData); }
         auto vertices_count() const { return m_vertices.size(); }
         auto get_ptr() const { return m_vertices.data(); }
 
-        bool has_changed() const { return m_changed; }
-        void flushed() { m_changed = false; }
+        ////
+        //	Indicate whether any triangle has been created, modified or destroyed since the last flush.
+        ////
+        bool has_changed() const { return !m_changed_slots.empty() || m_resized; }
+
+        ////
+        //	Indicate whether the capacity increased since the last flush. In this case the VBO must be reallocated (see capacity_byteSize()).
+        ////
+        bool has_been_resized() const { return m_resized; }
+
+        ////
+        //	@return: The ranges of vertices changed since the last flush, sorted by offset. Ranges that are close to each other are
+        //			 merged, so that the GPU buffer is updated with few glBufferSubData calls.
+        ////
+        auto get_changes() const -> std::vector<VerticesChange>;
+
+        ////
+        //	Make FreeTriangleVertices aware that the changed vertices have been loaded in the GPU memory.
+        ////
+        void flushed() { m_changed_slots.clear(); m_resized = false; }
         
 
-        auto create_polygon(FreePolygon const& polygon) -> DataArrayId;
+        ////
+        //	@normal: Normal of the polygon surface (OpenGL world space RS), shared by all its triangles.
+        ////
+        auto create_polygon(FreePolygon const& polygon, Vector3f const normal) -> DataArrayId;
         auto create_triangle(FreeTriangle const triangle) -> FreeTriangleId;
         
         void set_triangle(FreeTriangleId const id, FreeTriangle const triangle);
@@ -88,7 +140,10 @@ class FreeTriangleVertices
 
     private:
 
-        bool m_changed = false;
+        ChangedSlotRanges m_changed_slots;						//ranges of triangle slots changed since the last flush (in order of change)
+        bool m_resized = false;									//true if the capacity increased since the last flush
+
+        bool m_resizable;
 
         std::vector<EdgeableVertexData> m_vertices;				//m_vertices != slots. A slot corresponds to a whole triangle, i.e. 3 vertices.
 
@@ -99,17 +154,28 @@ class FreeTriangleVertices
 
         DataArray<PolygonInfo, true> m_poly_to_triangles;   //map each polygon to its constituent triangles
 
-        static constexpr int max_edgeableEntities = 100000u;
-        static auto init_edgeableIds() -> SlotManager;
-        //TODO: THREAD-SAFETY: edgeable_ids is a global variable and it isn't thread safe.
-        static inline SlotManager edgeable_ids = init_edgeableIds();
+        SlotManager & m_edgeable_ids;
+
+        static constexpr SlotManager::size_type initial_edgeableEntities = 100000u;
 
 
         static constexpr int vpt = 3; //vertices per triangle
 
+        static constexpr SlotId max_mergedGap = 16u; //see ChangedSlotRanges::merged()
+
 
 
         void internal_setTriangle(SlotId const triangle_slot, FreeTriangle const triangle);
+
+        ////
+        //	Double the number of triangle slots.
+        ////
+        void grow();
+
+        ////
+        //	Double the number of edgeable ids (the ones already assigned stay valid).
+        ////
+        void grow_edgeableIds();
         
         ////
         //	Compute the world space position (in units) from the map position (in units).
@@ -4,6 +4,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "graphics_manager_core.hh"
+#include "graphics/picking/tile_ray_picker.hh"
 
 #include "debug/asserts.hh"
 
@@ -43,7 +44,7 @@ static auto operator<<(std::ostream & os, glm::vec4 const& v) -> std::ostream &
 }
 
 GraphicsManager::GraphicsManager(Vector2i const defaultFbo_size, Vector2i const window_size,
-                                 TileVertices & tile_vertices, DynamicVertices const* dynamic_vertices, RoofVertices & roof_vertices, 
+                                 TileVertices & tile_vertices, DynamicVertices * dynamic_vertices, RoofVertices & roof_vertices, 
                                  Camera & camera) :
     m_defaultFbo_size(defaultFbo_size), m_window_size(window_size),
     m_tile_vertices(tile_vertices), m_dynamic_vertices(*dynamic_vertices), m_roof_vertices(roof_vertices), 
@@ -160,7 +161,9 @@ void GraphicsManager::generate_objects()
     // bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
     glBindVertexArray(m_dynamic_VAO);
         glBindBuffer(GL_ARRAY_BUFFER, m_dynamic_VBO);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(float) * m_dynamic_vertices.attribute_count(), m_dynamic_vertices.get_ptr(), GL_DYNAMIC_DRAW);
+            // The buffer is allocated once for all the sprite slots. Afterwards, only the changed sprites are streamed (see rebuff_dynamicVerticesVBO).
+            glBufferData(GL_ARRAY_BUFFER, m_dynamic_vertices.capacity_byteSize(), nullptr, GL_DYNAMIC_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, m_dynamic_vertices.buffer_byteSize(), m_dynamic_vertices.get_ptr());
             // position attribute
             glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
             glEnableVertexAttribArray(0);
@@ -180,13 +183,7 @@ void GraphicsManager::generate_objects()
 
 
     // RoofVertices VAO
-    generate_freeTriangleVerticesObjects(m_roofSouth_VBO, m_roofSouth_VAO, m_roof_vertices.south_roof);
-
-    generate_freeTriangleVerticesObjects(m_roofWest_VBO,  m_roofWest_VAO,  m_roof_vertices.west_roof);
-
-    generate_freeTriangleVerticesObjects(m_roofNorth_VBO, m_roofNorth_VAO, m_roof_vertices.north_roof);
-
-    generate_freeTriangleVerticesObjects(m_roofEast_VBO,  m_roofEast_VAO,  m_roof_vertices.east_roof);
+    generate_freeTriangleVerticesObjects(m_roof_VBO, m_roof_VAO, m_roof_vertices.vertices);
 
 
 
@@ -320,6 +317,19 @@ void GraphicsManager::generate_tileObjects()
 
         glBindBuffer(GL_ARRAY_BUFFER, 0); 
     glBindVertexArray(0); 
+
+    #if GSET_FRUSTUM_CULLING && !GSET_OCCLUSION_CULLING
+        m_tile_culler.reset(m_tile_vertices);
+
+        // FRUSTUM CULLING INDIRECT COMMAND BUFFER (large enough to store a command for each culling cell)
+        glGenBuffers(1, &m_frustumCulling_indirectCommandBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_frustumCulling_indirectCommandBuffer);
+            static char const frustumCulling_indirectCommandBuffer_label[] = "frustumCulling_indirectCommandBuffer";
+            glObjectLabel(GL_BUFFER, m_frustumCulling_indirectCommandBuffer, sizeof(frustumCulling_indirectCommandBuffer_label), frustumCulling_indirectCommandBuffer_label);
+
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawArraysIndirectCommand) * m_tile_culler.max_commandCount(), nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0); //unbind
+    #endif
 }
 
 #if GSET_EDGE_DETECTION_FILTER
@@ -720,7 +730,9 @@ void GraphicsManager::generate_freeTriangleVerticesObjects(GLuint & VBO_id, GLui
 
     glBindVertexArray(VAO_id);
     glBindBuffer(GL_ARRAY_BUFFER, VBO_id);
-    glBufferData(GL_ARRAY_BUFFER, ftv.buffer_byteSize(), ftv.get_ptr(), GL_DYNAMIC_DRAW);
+    // The buffer is allocated once for all the triangle slots. Afterwards, only the changed ranges are uploaded (see rebuff_freeTriangleVerticesVBO).
+    glBufferData(GL_ARRAY_BUFFER, ftv.capacity_byteSize(), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, ftv.buffer_byteSize(), ftv.get_ptr());
 
 
     // world position attribute
@@ -735,6 +747,9 @@ void GraphicsManager::generate_freeTriangleVerticesObjects(GLuint & VBO_id, GLui
     // edgeable_id attribute
     glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(EdgeableVertexData), (void*)(offsetof(EdgeableVertexData, edgeable_id)));
     glEnableVertexAttribArray(3);
+    // normal attribute
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(EdgeableVertexData), (void*)(offsetof(EdgeableVertexData, normal)));
+    glEnableVertexAttribArray(4);
 
 
     // note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind
@@ -817,6 +832,9 @@ void GraphicsManager::draw()
     if (is_defaulFbo_null())
         return;
 
+    //--- Resolve the picking requests of the previous frames
+    m_depth_picker.update();
+
     //--- Regenerate tile objects and occlusion culling objects
     if (m_tile_vertices.has_been_reset())
     {
@@ -1238,6 +1256,23 @@ void GraphicsManager::draw_scene()
             glDrawArraysIndirect(GL_TRIANGLES, nullptr); //nullptr because the indirect command is the buffer bound to GL_DRAW_INDIRECT_BUFFER
         glBindVertexArray(0); //unbind VAO
         glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0); //unbind command
+    #elif GSET_FRUSTUM_CULLING
+        // Draw only the ranges of the tile buffer inside the view frustum
+        auto const& visible_commands = m_tile_culler.cull(projection * view);
+        if (!visible_commands.empty())
+        {
+            auto const commands_byteSize = sizeof(DrawArraysIndirectCommand) * visible_commands.size();
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_frustumCulling_indirectCommandBuffer);
+                // Orphan the old storage, so that the commands of the previous frame can still be read by the GPU without stalling.
+                glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawArraysIndirectCommand) * m_tile_culler.max_commandCount(), nullptr, GL_STREAM_DRAW);
+                glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands_byteSize, visible_commands.data());
+
+            glBindVertexArray(m_tile_VAO);
+                glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, static_cast<GLsizei>(visible_commands.size()), 0); //nullptr because the commands are in the buffer bound to GL_DRAW_INDIRECT_BUFFER
+            glBindVertexArray(0); //unbind VAO
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0); //unbind commands
+        }
     #else
         // Draw all the tiles of the game map
         glBindVertexArray(m_tile_VAO);	
@@ -1249,10 +1284,12 @@ void GraphicsManager::draw_scene()
     set_sceneUniforms(m_dynamic_main_shader, view, projection, are_noRoofRects_changed);
     m_dynamic_main_shader.set_int("u_texture", dynamicTexture_unit); //"2" means texture at location of "GL_TEXTURE2"
 
-    // Rebuff dynamic vertices
-    glBindBuffer(GL_ARRAY_BUFFER, m_dynamic_VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * m_dynamic_vertices.attribute_count(), m_dynamic_vertices.get_ptr(), GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // Rebuff dynamic vertices (nothing is uploaded if no sprite changed)
+    if (m_dynamic_vertices.has_changed())
+    {
+        rebuff_dynamicVerticesVBO();
+        m_dynamic_vertices.flushed();
+    }
     
 
     // Draw dynamic vertices
@@ -1276,38 +1313,14 @@ void GraphicsManager::draw_scene()
     m_edgeableIds_main_shader.set_int("u_texture", roofTexture_unit); //"3" means texture at location of "GL_TEXTURE3"
 
 
-    if (m_roof_vertices.south_roof.has_changed())
-    {
-        rebuff_freeTriangleVerticesVBO(m_roofSouth_VBO, m_roof_vertices.south_roof);
-        m_roof_vertices.south_roof.flushed();
-    }
-    if (m_roof_vertices.west_roof.has_changed())
-    {
-        rebuff_freeTriangleVerticesVBO(m_roofWest_VBO, m_roof_vertices.west_roof);
-        m_roof_vertices.west_roof.flushed();
-    }
-    if (m_roof_vertices.north_roof.has_changed())
+    if (m_roof_vertices.vertices.has_changed())
     {
-        rebuff_freeTriangleVerticesVBO(m_roofNorth_VBO, m_roof_vertices.north_roof);
-        m_roof_vertices.north_roof.flushed();
-    }
-    if (m_roof_vertices.east_roof.has_changed())
-    {
-        rebuff_freeTriangleVerticesVBO(m_roofEast_VBO, m_roof_vertices.east_roof);
-        m_roof_vertices.east_roof.flushed();
+        rebuff_freeTriangleVerticesVBO(m_roof_VBO, m_roof_vertices.vertices);
+        m_roof_vertices.vertices.flushed();
     }
 
-    m_edgeableIds_main_shader.set_vec3("u_frag_normal", { -1.f,  0.f,  1.f });
-    draw_genericVAO(m_roofSouth_VAO, m_roof_vertices.south_roof);
-    
-    m_edgeableIds_main_shader.set_vec3("u_frag_normal", {  0.f,  1.f,  1.f });
-    draw_genericVAO(m_roofWest_VAO, m_roof_vertices.west_roof);
-    
-    m_edgeableIds_main_shader.set_vec3("u_frag_normal", {  1.f,  0.f,  1.f });
-    draw_genericVAO(m_roofNorth_VAO, m_roof_vertices.north_roof);
-    
-    m_edgeableIds_main_shader.set_vec3("u_frag_normal", {  0.f, -1.f,  1.f });
-    draw_genericVAO(m_roofEast_VAO, m_roof_vertices.east_roof);
+    // The orientation of each slope is stored in its vertices (as the normal of the surface), so all the roofs are drawn at once.
+    draw_genericVAO(m_roof_VAO, m_roof_vertices.vertices);
 
 
     #if GSET_ALPHA_TO_COVERAGE
@@ -1468,35 +1481,21 @@ auto GraphicsManager::floor_highestZ(float const world_z) -> float
     return GSet::tiles_to_units(GSet::units_to_tiles(world_z / GSet::floorsSpacing_ratio) + 1) * GSet::floorsSpacing_ratio - GSet::upt / 100.f;
 }
 
-auto GraphicsManager::glfwWindowPixel_to_mapTile(Vector2f const glfw_cursorPos) const -> Vector3i
-{
-    auto map_units = glfwWindowPixel_to_mapUnits(glfw_cursorPos);
-
-    return { GSet::units_to_tiles(map_units.x), 
-             GSet::units_to_tiles(map_units.y), 
-             GSet::units_to_tiles(map_units.z + 0.3f * GSet::upt) }; //adding "0.3 * upt" because GraphicsManager::windowPixel_to_mapUnits() isn't really accurate in perspective mode
-}
-
-auto GraphicsManager::glfwWindowPixel_to_mapUnits(Vector2f const glfw_cursorPos) const -> Vector3f
+auto GraphicsManager::openGlWorldSpace_to_mapUnits(Vector3f const world_pos) -> Vector3f
 {
-    //static auto test_counter = 0;
-    //g_log << "glfwWindowPixel_to_mapUnits: #" << test_counter << std::endl;
-    //++test_counter;
-
-
-    //g_log << "\n\nGLFW screen reference system: " << glfw_cursorPos << std::endl;
-
+    // Convert from "OpenGL world space r.s. (units)" to "map r.s. (units)".
+    auto const map_z = world_pos.z / GSet::floorsSpacing_ratio;
 
-    // Conversion of mouse coordinates from "GLFW screen reference system" to "OpengGL framebuffer reference system"
-    auto openGl_fboPos = GraphicsManagerCore::glfwScreenRS_to_openGlFramebufferRS(glfw_cursorPos, m_window_size, m_defaultFbo_size);
+    auto const wy_sliding = map_z * GSet::wySliding_ratio();
+    auto const map_x = - world_pos.y + wy_sliding;
 
-    //g_log << "OpenGL framebuffer reference system: " << openGl_fboPos << std::endl;
-    
+    auto const map_y = world_pos.x;
 
+    return { map_x, map_y, map_z };
+}
 
-    // Retrieving the depth associated to the clicked pixel
-    auto z_depth = 0.f;
-    
+void GraphicsManager::bind_sceneDepthFBO() const
+{
     //bind the framebuffer where the actual depth test happens
     #if GSET_EDGE_DETECTION_FILTER
         glBindFramebuffer(GL_FRAMEBUFFER, m_edfScene_FBO);
@@ -1505,57 +1504,107 @@ auto GraphicsManager::glfwWindowPixel_to_mapUnits(Vector2f const glfw_cursorPos)
     #else
         glBindFramebuffer(GL_FRAMEBUFFER, default_FBO);		
     #endif
+}
 
-    //read the depth component from the active framebuffer (be it the default one or an user-defined one)
-    glReadPixels((GLint)openGl_fboPos.x, (GLint)openGl_fboPos.y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &z_depth);
-    
-    #if GSET_EDGE_DETECTION_FILTER || GSET_OVERDRAW_MODE
-        //rebind the default framebuffer
-        glBindFramebuffer(GL_FRAMEBUFFER, default_FBO);
-    #endif
-
-    //g_log << "Pixel z_depth: " << z_depth << std::endl;
-
+auto GraphicsManager::request_mapTilePicking(Vector2f const glfw_cursorPos) -> PickingId
+{
+    auto const openGl_fboPos = GraphicsManagerCore::glfwScreenRS_to_openGlFramebufferRS(glfw_cursorPos, m_window_size, m_defaultFbo_size);
 
-    
-    // Revert the rendering pipeline from the fragment back to the world space.
     auto const map_box = compute_mapBox();
     auto const view = compute_viewMatrix(map_box);
     auto const projection = compute_projectionMatrix(map_box);
 
-    auto const world = GraphicsManagerCore::fragmentRS_to_openGlWorldSpaceRS(openGl_fboPos, z_depth, view, projection, m_defaultFbo_size);
+    bind_sceneDepthFBO();
 
-    //auto const frag_pos = glm::vec3{ openGl_fboPos.x, openGl_fboPos.y, z_depth };			//position of the pixel and its depth
-    //auto const viewport = glm::vec4{ 0, 0, m_defaultFbo_size.x, m_defaultFbo_size.y };		//window rectangle 
-    //auto const world = glm::unProject(frag_pos, view, projection, viewport);				//(in pixels -- OpenGL world space reference system)
-    
+    auto const id = m_depth_picker.request(openGl_fboPos, view, projection, m_defaultFbo_size);
 
+    #if GSET_EDGE_DETECTION_FILTER || GSET_OVERDRAW_MODE
+        glBindFramebuffer(GL_FRAMEBUFFER, default_FBO);
+    #endif
 
-    // Convert from "OpenGL world space r.s. (units)" to "map r.s. (units)".
-    auto map_z = world.z / GSet::floorsSpacing_ratio;
+    return id;
+}
 
-    auto wy_sliding = map_z * GSet::wySliding_ratio();
-    auto map_x = - world.y + wy_sliding;
+auto GraphicsManager::picked_mapTile(PickingId const id) -> std::optional<Vector3i>
+{
+    auto const world = m_depth_picker.take_result(id);
 
-    auto map_y = world.x;
+    if (!world) { return std::nullopt; }
 
-    Vector3f map_units{ map_x, map_y, map_z };
+    auto const map_units = openGlWorldSpace_to_mapUnits(*world);
 
+    return Vector3i{ GSet::units_to_tiles(map_units.x), 
+                     GSet::units_to_tiles(map_units.y), 
+                     GSet::units_to_tiles(map_units.z + 0.3f * GSet::upt) }; //adding "0.3 * upt" because the unprojected depth isn't really accurate in perspective mode
+}
 
-    
-    //g_log << "World coordinates (in pixels): " << world		<< '\n'
-              //<< "Map coordinates (in units):    " << map_units << '\n' << std::endl;
+auto GraphicsManager::cpu_pick_mapTile(Vector2f const glfw_cursorPos, TileSet const& tiles) const -> std::optional<Vector3i>
+{
+    auto const openGl_fboPos = GraphicsManagerCore::glfwScreenRS_to_openGlFramebufferRS(glfw_cursorPos, m_window_size, m_defaultFbo_size);
 
+    auto const map_box = compute_mapBox();
+    auto const view = compute_viewMatrix(map_box);
+    auto const projection = compute_projectionMatrix(map_box);
 
+    // The ray passing through the pixel, from the near plane (depth 0) to the far plane (depth 1). The conversion from the world space 
+    // to the map space is affine, so the ray is still a straight line in the map space.
+    auto const near_world = GraphicsManagerCore::fragmentRS_to_openGlWorldSpaceRS(openGl_fboPos, 0.f, view, projection, m_defaultFbo_size);
+    auto const far_world  = GraphicsManagerCore::fragmentRS_to_openGlWorldSpaceRS(openGl_fboPos, 1.f, view, projection, m_defaultFbo_size);
 
-    return map_units;
+    return TileRayPicker::pick_tile(tiles, openGlWorldSpace_to_mapUnits(near_world), openGlWorldSpace_to_mapUnits(far_world));
 }
 
-
 void GraphicsManager::rebuff_freeTriangleVerticesVBO(GLuint VBO_id, FreeTriangleVertices const& ftv)
 {
     glBindBuffer(GL_ARRAY_BUFFER, VBO_id);
-    glBufferData(GL_ARRAY_BUFFER, ftv.buffer_byteSize(), ftv.get_ptr(), GL_DYNAMIC_DRAW);
+
+    if (ftv.has_been_resized())
+    {
+        // The buffer is reallocated, so the vertices that didn't change must be uploaded as well.
+        glBufferData(GL_ARRAY_BUFFER, ftv.capacity_byteSize(), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, ftv.buffer_byteSize(), ftv.get_ptr());
+    }
+    else
+    {
+        for (auto const& change : ftv.get_changes())
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, change.offset, change.byte_size, change.ptr);
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GraphicsManager::rebuff_dynamicVerticesVBO()
+{
+    // If most of the buffer changed, it's cheaper to orphan it and upload it whole: the driver gives back a fresh block of memory,
+    // so the upload doesn't have to wait for the draw calls of the previous frames still reading the old one.
+    static auto constexpr orphaning_threshold = 0.5;
+
+    auto const changes = m_dynamic_vertices.get_changes();
+
+    auto changed_byteSize = GLsizeiptr{ 0 };
+    for (auto const& change : changes)
+    {
+        changed_byteSize += change.byte_size;
+    }
+
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_dynamic_VBO);
+
+    if (changed_byteSize > orphaning_threshold * m_dynamic_vertices.buffer_byteSize())
+    {
+        glBufferData(GL_ARRAY_BUFFER, m_dynamic_vertices.capacity_byteSize(), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_dynamic_vertices.buffer_byteSize(), m_dynamic_vertices.get_ptr());
+    }
+    else
+    {
+        for (auto const& change : changes)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, change.offset, change.byte_size, change.ptr);
+        }
+    }
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
@@ -1581,6 +1630,8 @@ void GraphicsManager::free_objects()
     glDeleteVertexArrays(1, &m_windowQuad_VAO);
     glDeleteBuffers(1, &m_windowQuad_VBO);
 
+    m_depth_picker.free_objects();
+
 
     #if GSET_EDGE_DETECTION_FILTER
         free_edgeDetectionFilterObjects();
@@ -1606,17 +1657,8 @@ void GraphicsManager::free_objects()
 
 
 
-    glDeleteVertexArrays(1, &m_roofSouth_VAO);
-    glDeleteBuffers(1, &m_roofSouth_VBO);
-
-    glDeleteVertexArrays(1, &m_roofWest_VAO);
-    glDeleteBuffers(1, &m_roofWest_VBO);
-
-    glDeleteVertexArrays(1, &m_roofNorth_VAO);
-    glDeleteBuffers(1, &m_roofNorth_VBO);
-
-    glDeleteVertexArrays(1, &m_roofEast_VAO);
-    glDeleteBuffers(1, &m_roofEast_VBO);
+    glDeleteVertexArrays(1, &m_roof_VAO);
+    glDeleteBuffers(1, &m_roof_VBO);
 
     #if GSET_TILESET_TEXARRAY
         glDeleteTextures(1, &m_tilesetTexarray_id);
@@ -1670,6 +1712,10 @@ void GraphicsManager::free_tileObjects()
 {
     glDeleteVertexArrays(1, &m_tile_VAO);
     glDeleteBuffers(1, &m_tile_VBO);
+
+    #if GSET_FRUSTUM_CULLING && !GSET_OCCLUSION_CULLING
+        glDeleteBuffers(1, &m_frustumCulling_indirectCommandBuffer);
+    #endif
 }
 
 #if GSET_OCCLUSION_CULLING
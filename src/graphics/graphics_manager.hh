@@ -2,13 +2,17 @@
 #define GM_GRAPHICS_MANAGER_HH
 
 
+#include <optional>
+
 #include <glad/glad.h>
 #define GLM_FORCE_SILENT_WARNINGS
 #include <glm/glm.hpp>
 
 #include "camera.hh"
 #include "dynamic_vertices.hh"
+#include "graphics/culling/tile_frustum_culler.hh"
 #include "graphics/opengl/draw_arrays_indirect_command.hh"
+#include "graphics/picking/async_depth_picker.hh"
 #include "graphics/textures/texture_2d.hh"
 #include "graphics/textures/texture_2d_array.hh"
 #include "roof_vertices.hh"
@@ -24,6 +28,9 @@ namespace tgm
 
 
 
+class TileSet;
+
+
 //TODO: NOW: Forse andrebbe rinominato GPU manager
 class GraphicsManager
 {
@@ -34,7 +41,7 @@ class GraphicsManager
         //  @camera_phi, @camera_theta: Angular polar coordinates of the camera (the origin is @camera_target) (in degrees).
         ////
         GraphicsManager(Vector2i const defaultFbo_size, Vector2i const window_size,
-                        TileVertices & tile_vertices, DynamicVertices const* dynamic_vertices, RoofVertices & roof_vertices, 
+                        TileVertices & tile_vertices, DynamicVertices * dynamic_vertices, RoofVertices & roof_vertices, 
                         Camera & camera);
         ~GraphicsManager();
         
@@ -44,7 +51,28 @@ class GraphicsManager
         void resize_window(Vector2i const new_window_size) noexcept;
         void draw();
 
-        auto glfwWindowPixel_to_mapTile(Vector2f const glfw_cursorPos) const -> Vector3i;
+        ////
+        //	Queue the asynchronous read of the depth of the pixel under the cursor (see AsyncDepthPicker).
+        //	@return: The id to pass to picked_mapTile() in the next frames.
+        ////
+        auto request_mapTilePicking(Vector2f const glfw_cursorPos) -> PickingId;
+
+        ////
+        //	@return: The tile (in tiles -- map reference system) picked by the request with @id, or nothing if it hasn't been resolved 
+        //			 yet. A request made in frame N is resolved by the draw() of frame N+1 or N+2.
+        ////
+        auto picked_mapTile(PickingId const id) -> std::optional<Vector3i>;
+
+        ////
+        //	Pick the tile under the cursor by casting a ray against @tiles on the CPU. The result is immediate and doesn't involve the
+        //	GPU, but only tiles are taken into account (sprites and roofs are ignored).
+        ////
+        auto cpu_pick_mapTile(Vector2f const glfw_cursorPos, TileSet const& tiles) const -> std::optional<Vector3i>;
+
+        ////
+        //	Statistics of the last frustum culling of the tiles (they are all zero when GSET_FRUSTUM_CULLING is disabled).
+        ////
+        auto tileCulling_stats() const noexcept -> FrustumCullingStats const& { return m_tile_culler.stats(); }
 
     private:
         bool m_is_init = false;
@@ -135,6 +163,13 @@ class GraphicsManager
         GLuint m_tile_VBO = 0;
         GLuint m_tile_VAO = 0;
 
+        // Select the tiles inside the view frustum (used only when GSET_FRUSTUM_CULLING is enabled)
+        TileFrustumCuller m_tile_culler;
+        // Buffer of the indirect commands used to draw the tiles inside the view frustum
+        GLuint m_frustumCulling_indirectCommandBuffer = 0;
+
+        AsyncDepthPicker m_depth_picker;
+
 
         #if GSET_OCCLUSION_CULLING
             //Framebuffer used to compute the texture of the entity ids
@@ -179,14 +214,8 @@ class GraphicsManager
         GLuint m_building_VBO = 0;
         GLuint m_building_VAO = 0;
 
-        GLuint m_roofSouth_VBO = 0;
-        GLuint m_roofSouth_VAO = 0;
-        GLuint m_roofWest_VBO = 0;
-        GLuint m_roofWest_VAO = 0;
-        GLuint m_roofNorth_VBO = 0;
-        GLuint m_roofNorth_VAO = 0;
-        GLuint m_roofEast_VBO = 0;
-        GLuint m_roofEast_VAO = 0;
+        GLuint m_roof_VBO = 0;
+        GLuint m_roof_VAO = 0;
 
 
         ////
@@ -228,7 +257,7 @@ class GraphicsManager
 
 
         TileVertices & m_tile_vertices;
-        DynamicVertices const& m_dynamic_vertices;
+        DynamicVertices & m_dynamic_vertices;
         RoofVertices & m_roof_vertices;
 
         Camera & m_camera;
@@ -309,15 +338,29 @@ class GraphicsManager
         static auto floor_highestZ(float const world_z) -> float;
         
         ////
-        //	@window_coord_x, @window_coord_y: (in pixels -- screen reference system)
+        //	@world_pos: (in units -- OpenGL world space reference system)
         //
         //	@return: (in units -- map reference system)
         ////
-        auto glfwWindowPixel_to_mapUnits(Vector2f const glfw_cursorPos) const -> Vector3f;
+        static auto openGlWorldSpace_to_mapUnits(Vector3f const world_pos) -> Vector3f;
+
+        ////
+        //	Bind the framebuffer where the depth test of the scene happens.
+        ////
+        void bind_sceneDepthFBO() const;
 
         
+        ////
+        //	Upload to @VBO_id only the ranges of @ftv changed since the last flush. The VBO must have been allocated with the whole
+        //	capacity of @ftv (see generate_freeTriangleVerticesObjects). If the capacity of @ftv increased, the VBO is reallocated.
+        ////
         void rebuff_freeTriangleVerticesVBO(GLuint VBO_id, FreeTriangleVertices const& ftv);
 
+        ////
+        //	Stream to m_dynamic_VBO the sprites changed since the last flush.
+        ////
+        void rebuff_dynamicVerticesVBO();
+
         void draw_genericVAO(GLuint VAO_id, FreeTriangleVertices const& ftv);
 
         
@@ -58,7 +58,7 @@ namespace tests
         //testpoly.push_vertex({  3.f,  7.f, 0.f, 300.f, 100.f });
         //testpoly.push_vertex({  7.f,  7.f, 0.f, 300.f, 400.f });
         //testpoly.push_vertex({  0.f, 10.f, 0.f, 400.f,   0.f });
-        //roof_vertices.north_roof.create_polygon(testpoly);
+        //roof_vertices.create_polygon(testpoly, RoofOrientation::North);
 
 
         #pragma warning(default: 4100)
@@ -0,0 +1,139 @@
+#include "async_depth_picker.hh"
+
+
+#include <algorithm>
+
+#include "graphics/graphics_manager_core.hh"
+
+
+namespace tgm
+{
+
+
+
+void AsyncDepthPicker::free_objects()
+{
+    for (auto & read : m_pending)
+    {
+        glDeleteSync(read.fence);
+        glDeleteBuffers(1, &read.PBO);
+    }
+    m_pending.clear();
+
+    if (!m_free_PBOs.empty())
+    {
+        glDeleteBuffers(static_cast<GLsizei>(m_free_PBOs.size()), m_free_PBOs.data());
+        m_free_PBOs.clear();
+    }
+
+    m_results.clear();
+}
+
+
+auto AsyncDepthPicker::request(Vector2f const fbo_pos, glm::mat4 const& view, glm::mat4 const& projection, Vector2i const fbo_size) -> PickingId
+{
+    auto const PBO = acquire_PBO();
+
+    // With a buffer bound to GL_PIXEL_PACK_BUFFER, glReadPixels only schedules the copy and returns immediately.
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, PBO);
+    glReadPixels(static_cast<GLint>(fbo_pos.x), static_cast<GLint>(fbo_pos.y), 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr); //nullptr is the offset inside the PBO
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    auto const fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    ++m_last_id;
+    m_pending.push_back({ m_last_id, PBO, fence, 0, fbo_pos, view, projection, fbo_size });
+
+    return m_last_id;
+}
+
+
+void AsyncDepthPicker::update()
+{
+    auto it = m_pending.begin();
+    while (it != m_pending.end())
+    {
+        auto const must_wait = it->waited_frames >= max_waitedFrames;
+
+        // A zero timeout only polls the fence. When waiting, the commands must be flushed, otherwise the fence could never be signaled.
+        auto const flags = must_wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+        auto const timeout = must_wait ? GL_TIMEOUT_IGNORED : 0;
+        auto const status = glClientWaitSync(it->fence, flags, timeout);
+
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+        {
+            resolve(*it);
+
+            glDeleteSync(it->fence);
+            m_free_PBOs.push_back(it->PBO);
+
+            it = m_pending.erase(it);
+        }
+        else
+        {
+            ++it->waited_frames;
+            ++it;
+        }
+    }
+}
+
+
+auto AsyncDepthPicker::take_result(PickingId const id) -> std::optional<Vector3f>
+{
+    auto const it = std::find_if(m_results.begin(), m_results.end(), [id](auto const& r) { return r.first == id; });
+
+    if (it == m_results.end()) { return std::nullopt; }
+
+    auto const world_pos = it->second;
+    m_results.erase(it);
+
+    return world_pos;
+}
+
+
+auto AsyncDepthPicker::acquire_PBO() -> GLuint
+{
+    if (!m_free_PBOs.empty())
+    {
+        auto const PBO = m_free_PBOs.back();
+        m_free_PBOs.pop_back();
+
+        return PBO;
+    }
+
+    auto PBO = GLuint{ 0 };
+    glGenBuffers(1, &PBO);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, PBO);
+    glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLfloat), nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return PBO;
+}
+
+
+void AsyncDepthPicker::resolve(PendingRead const& read)
+{
+    auto z_depth = 1.f;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, read.PBO);
+    if (auto const ptr = static_cast<GLfloat const*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(GLfloat), GL_MAP_READ_BIT)))
+    {
+        z_depth = *ptr;
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+
+    auto const world_pos = GraphicsManagerCore::fragmentRS_to_openGlWorldSpaceRS(read.fbo_pos, z_depth, read.view, read.projection, read.fbo_size);
+
+    if (m_results.size() >= max_results)
+    {
+        m_results.erase(m_results.begin());
+    }
+    m_results.push_back({ read.id, world_pos });
+}
+
+
+
+} // namespace tgm
\ No newline at end of file
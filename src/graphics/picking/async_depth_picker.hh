@@ -0,0 +1,108 @@
+#ifndef GM_ASYNC_DEPTH_PICKER_HH
+#define GM_ASYNC_DEPTH_PICKER_HH
+
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+#define GLM_FORCE_SILENT_WARNINGS
+#include <glm/glm.hpp>
+
+#include "system/vector2.hh"
+#include "system/vector3.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//	Uniquely identify a picking request. 0 is reserved for empty values.
+////
+using PickingId = uint64_t;
+
+
+////
+//
+//	Read the depth of single pixels without stalling the CPU. Each request copies the depth in a pixel buffer object and inserts a
+//	fence after the copy; update() collects the requests whose fence has been signaled and unprojects them in the OpenGL world space.
+//	A request made in frame N is resolved in frame N+1 or, at the latest, in frame N+2 (update() waits for its fence in that case).
+//
+////
+class AsyncDepthPicker
+{
+    public:
+        AsyncDepthPicker() = default;
+        AsyncDepthPicker(AsyncDepthPicker const&) = delete;
+        AsyncDepthPicker & operator=(AsyncDepthPicker const&) = delete;
+
+        void free_objects();
+
+        ////
+        //	Queue the read of the depth of a pixel of the framebuffer currently bound to GL_READ_FRAMEBUFFER.
+        //	@fbo_pos: Position of the pixel (OpenGL framebuffer reference system).
+        //	@view, @projection, @fbo_size: Used to unproject the pixel. They must be the ones used to draw the framebuffer.
+        ////
+        auto request(Vector2f const fbo_pos, glm::mat4 const& view, glm::mat4 const& projection, Vector2i const fbo_size) -> PickingId;
+
+        ////
+        //	Resolve the requests whose depth has reached the pixel buffer object. It must be called once per frame.
+        ////
+        void update();
+
+        ////
+        //	@return: The position of the picked pixel (in units -- OpenGL world space reference system), or nothing if the request with
+        //			 @id hasn't been resolved yet (or doesn't exist). A result is returned only once.
+        ////
+        auto take_result(PickingId const id) -> std::optional<Vector3f>;
+
+        auto pending_count() const noexcept { return m_pending.size(); }
+
+
+    private:
+        struct PendingRead
+        {
+            PickingId id;
+            GLuint PBO;
+            GLsync fence;
+            int waited_frames;
+
+            Vector2f fbo_pos;
+            glm::mat4 view;
+            glm::mat4 projection;
+            Vector2i fbo_size;
+        };
+
+        // Unclaimed results beyond this number are discarded (oldest first).
+        static constexpr std::size_t max_results = 16u;
+        // Number of frames after which update() stops polling a fence and waits for it.
+        static constexpr int max_waitedFrames = 1;
+
+
+        PickingId m_last_id = 0u;
+
+        std::vector<PendingRead> m_pending;
+        std::vector<std::pair<PickingId, Vector3f>> m_results;
+
+        std::vector<GLuint> m_free_PBOs;		//pixel buffer objects not used by any pending request
+
+
+        auto acquire_PBO() -> GLuint;
+
+        ////
+        //	Read the depth from the pixel buffer object of @read (whose fence must be signaled) and store the unprojected position.
+        ////
+        void resolve(PendingRead const& read);
+};
+
+
+
+} // namespace tgm
+
+
+#endif //GM_ASYNC_DEPTH_PICKER_HH
\ No newline at end of file
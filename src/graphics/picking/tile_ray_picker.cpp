@@ -0,0 +1,48 @@
+#include "tile_ray_picker.hh"
+
+
+#include "settings/graphics_settings.hh"
+
+
+namespace tgm
+{
+
+
+
+namespace TileRayPicker
+{
+
+
+auto pick_tile(TileSet const& tiles, Vector3f const ray_begin, Vector3f const ray_end) -> std::optional<Vector3i>
+{
+    auto const dz = ray_end.z - ray_begin.z;
+
+    // A ray parallel to the floors can't hit any of them.
+    if (dz == 0.f) { return std::nullopt; }
+
+    for (auto z = tiles.height() - 1; z >= 0; --z)
+    {
+        // Parameter of the intersection between the ray and the plane of the floor.
+        auto const t = (GSet::tiles_to_units(z) - ray_begin.z) / dz;
+
+        if (t < 0.f) { continue; }
+
+        auto const x = GSet::units_to_tiles(ray_begin.x + t * (ray_end.x - ray_begin.x));
+        auto const y = GSet::units_to_tiles(ray_begin.y + t * (ray_end.y - ray_begin.y));
+
+        auto const tile = tiles.get(x, y, z);
+        if (tile && tile->get_type() != TileType::sky)
+        {
+            return Vector3i{ x, y, z };
+        }
+    }
+
+    return std::nullopt;
+}
+
+
+} // namespace TileRayPicker
+
+
+
+} // namespace tgm
\ No newline at end of file
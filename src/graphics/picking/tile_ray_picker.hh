@@ -0,0 +1,38 @@
+#ifndef GM_TILE_RAY_PICKER_HH
+#define GM_TILE_RAY_PICKER_HH
+
+
+#include <optional>
+
+#include "map/tiles/tile_set.hh"
+#include "system/vector3.hh"
+
+
+namespace tgm
+{
+
+
+
+namespace TileRayPicker
+{
+
+
+////
+//	Intersect a ray with the floors of @tiles, from the highest floor to the lowest one, and return the first tile hit that isn't 
+//	sky. The tiles are flat, so the intersection with each floor is exact. The fragments discarded by the shaders (e.g. the ones 
+//	above the player) aren't taken into account.
+//	@ray_begin, @ray_end: Two points of the ray (in units -- map reference system). @ray_begin is the one nearer to the camera.
+//
+//	@return: The position of the hit tile (in tiles -- map reference system), or nothing if no tile is hit.
+////
+auto pick_tile(TileSet const& tiles, Vector3f const ray_begin, Vector3f const ray_end) -> std::optional<Vector3i>;
+
+
+} // namespace TileRayPicker
+
+
+
+} // namespace tgm
+
+
+#endif //GM_TILE_RAY_PICKER_HH
\ No newline at end of file
@@ -17,24 +17,9 @@ void RoofGraphicsManager::prepare(GameMap const& simulation)
     {
         auto const& rg = m_roof_graphics.at(rid);
 
-        for (auto const fpid : rg.south_polygons)
+        for (auto const fpid : rg.polygons)
         {
-            m_roof_vertices.south_roof.destroy_polygon(fpid);
-        }
-
-        for (auto const fpid : rg.west_polygons)
-        {
-            m_roof_vertices.west_roof.destroy_polygon(fpid);
-        }
-
-        for (auto const fpid : rg.north_polygons)
-        {
-            m_roof_vertices.north_roof.destroy_polygon(fpid);
-        }
-
-        for (auto const fpid : rg.east_polygons)
-        {
-            m_roof_vertices.east_roof.destroy_polygon(fpid);
+            m_roof_vertices.destroy_polygon(fpid);
         }
 
         m_roof_graphics.erase(rid);
@@ -56,29 +41,18 @@ void RoofGraphicsManager::prepare(GameMap const& simulation)
 
         auto const polygons = HipRoofAlgorithm::generate_hipRoof(r.roofed_poss, r.roofed_poss.front().z, tiles.length(), tiles.width());
         
-        for (auto const& poly : polygons.south)
-        {
-            auto const fpid = m_roof_vertices.south_roof.create_polygon(poly);
-            r_graphics.south_polygons.push_back(fpid);
-        }
-
-        for (auto const& poly : polygons.west)
-        {
-            auto const fpid = m_roof_vertices.west_roof.create_polygon(poly);
-            r_graphics.west_polygons.push_back(fpid);
-        }
-
-        for (auto const& poly : polygons.north)
-        {
-            auto const fpid = m_roof_vertices.north_roof.create_polygon(poly);
-            r_graphics.north_polygons.push_back(fpid);
-        }
-
-        for (auto const& poly : polygons.east)
-        {
-            auto const fpid = m_roof_vertices.east_roof.create_polygon(poly);
-            r_graphics.east_polygons.push_back(fpid);
-        }
+        auto const create_slopes = [this, &r_graphics](std::vector<FreePolygon> const& slopes, RoofOrientation const orientation)
+        {
+            for (auto const& poly : slopes)
+            {
+                r_graphics.polygons.push_back(m_roof_vertices.create_polygon(poly, orientation));
+            }
+        };
+
+        create_slopes(polygons.south, RoofOrientation::South);
+        create_slopes(polygons.west,  RoofOrientation::West);
+        create_slopes(polygons.north, RoofOrientation::North);
+        create_slopes(polygons.east,  RoofOrientation::East);
     }
 
     m_mediator.changes_acquired();
@@ -10,19 +10,59 @@ namespace tgm
 
 
 
+enum class RoofOrientation
+{
+    South,
+    West,
+    North,
+    East,
+};
+
+
+////
+//
+//	The triangles of all the roofs, stored in a single buffer so that they are drawn with a single draw call. The orientation of each
+//	slope is stored in the vertices as the normal of its surface (used for the diffuse lighting).
+//
+////
 struct RoofVertices
 {
-    FreeTriangleVertices south_roof{ 30000u, roof_texture };
-    FreeTriangleVertices west_roof{ 30000u, roof_texture };
-    FreeTriangleVertices north_roof{ 30000u, roof_texture };
-    FreeTriangleVertices east_roof{ 30000u, roof_texture };
+    // Initial number of triangles. The buffer grows on demand when it's full.
+    static constexpr FreeTriangleVertices::size_type initial_triangleCapacity = 30000u;
+
+    ////
+    //	@edgeable_ids: Shared with the other FreeTriangleVertices of the scene (see FreeTriangleVertices::create_edgeableIds()).
+    ////
+    explicit RoofVertices(SlotManager & edgeable_ids) : vertices{ initial_triangleCapacity, roof_texture, edgeable_ids, true } {}
+
+
+    FreeTriangleVertices vertices;
+
 
-    void clear()
+    auto create_polygon(FreePolygon const& polygon, RoofOrientation const orientation) -> FreePolygonId
     {
-        south_roof.clear();
-        west_roof.clear();
-        north_roof.clear();
-        east_roof.clear();
+        return vertices.create_polygon(polygon, surface_normal(orientation));
+    }
+
+    void destroy_polygon(FreePolygonId const id) { vertices.destroy_polygon(id); }
+
+    void clear() { vertices.clear(); }
+
+
+    ////
+    //	@return: Normal of the slopes with @orientation (OpenGL world space RS).
+    ////
+    static auto surface_normal(RoofOrientation const orientation) -> Vector3f
+    {
+        switch (orientation)
+        {
+            case RoofOrientation::South: return { -1.f,  0.f,  1.f };
+            case RoofOrientation::West:  return {  0.f,  1.f,  1.f };
+            case RoofOrientation::North: return {  1.f,  0.f,  1.f };
+            case RoofOrientation::East:  return {  0.f, -1.f,  1.f };
+        }
+
+        throw std::runtime_error("Unknown RoofOrientation.");
     }
 };
 
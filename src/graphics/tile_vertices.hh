@@ -153,6 +153,12 @@ class TileVertices
 
         static constexpr auto chunk_byteSize() { return chunk_size * sizeof(TilesetVertexData); }
 
+        ////
+        //	Number of vertices making up a single tile. The vertices of the tiles are stored row by row (first along the x-axis, then along
+        //	the y-axis and finally along the z-axis).
+        ////
+        static constexpr auto tile_verticesCount() -> int { return triangles_per_tile * vertices_per_triangle; }
+
 
         auto map_length() const -> int { assert_initialization(); return m_map_length; }
         auto map_width()  const -> int { assert_initialization(); return m_map_width; }
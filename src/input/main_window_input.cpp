@@ -6,7 +6,9 @@
 #include "graphics/algorithms/hip_roof/tests/hip_roof_tests.hh"
 #include "map/buildings/building_recipe.hh"
 #include "map/buildings/tests/building_tests.hh"
+#include "map/tests/map_graph_tests.hh"
 #include "settings/simulation/simulation_settings.hh"
+#include "systems/tests/trail_system_tests.hh"
 #include "ui/on_screen_messages.hh"
 #include "utilities.hh"
 
@@ -203,6 +205,14 @@ namespace MainWindow
             //	// BuildingManager tests
             //	//BuildingAlgorithmTests::blockOutline_tests(map);
             //	//BuildingAlgorithmTests::automatic_cityDevelopment(map, created_buildings);
+            //	//BuildingAlgorithmTests::expansionEvaluation_tests(map);
+            //	//BuildingAlgorithmTests::contextSettings_tests();
+
+            //	// Navigation tests
+            //	//MapGraphTests::test_pathfinding();
+
+            //	// Movement tests
+            //	//TrailSystemTests::test_nearestPosition();
 
 
 
@@ -282,9 +292,10 @@ namespace MainWindow
             
             case GLFW_KEY_9:
             {
-                sim_settings.map.generate_roofs = !sim_settings.map.generate_roofs;
+                auto & map_settings = map.simulation_context().settings.map;
+                map_settings.generate_roofs = !map_settings.generate_roofs;
 
-                auto oss = std::ostringstream{}; oss << "Roof generation: " << (sim_settings.map.generate_roofs ? "enabled" : "disabled");
+                auto oss = std::ostringstream{}; oss << "Roof generation: " << (map_settings.generate_roofs ? "enabled" : "disabled");
                 g_on_screen_messages.push_new_message(oss.str());
 
                 break;
@@ -430,7 +441,6 @@ namespace MainWindow
     {
         auto u_ptr = std::any_cast<MainWindowObjects *>(window.user_pointer());
         auto & graphics_manager = u_ptr->graphics_manager;
-        auto & tileGraphics_mediator = u_ptr->tileGraphics_mediator;
         auto & map = u_ptr->map;
         auto & gui_mgr = u_ptr->gui_mgr;
 
@@ -440,20 +450,21 @@ namespace MainWindow
             {
                 case GLFW_MOUSE_BUTTON_LEFT:
                 {
-
-                    auto const tile_pos = graphics_manager.glfwWindowPixel_to_mapTile(mouse_pos);
-                    map.new_mobileEvent<DebugPlayerTeleportationEv>(tile_pos);
+                    // The depth is read without stalling the CPU, the teleportation happens when it's ready (see resolve_tilePickings())
+                    u_ptr->teleport_picking = graphics_manager.request_mapTilePicking(mouse_pos);
 
                     break;
                 }
 
                 case GLFW_MOUSE_BUTTON_MIDDLE:
                 {
-                    auto const tile_pos = graphics_manager.glfwWindowPixel_to_mapTile(mouse_pos);
+                    // Only tiles can be inspected, so the CPU picking is enough (and it doesn't stall the CPU waiting for the GPU).
+                    auto const tile_pos = graphics_manager.cpu_pick_mapTile(mouse_pos, map.tiles());
+                    if (!tile_pos) { break; }
 
-                    g_log << "Mid-clicked tile: " << tile_pos << std::endl;
+                    g_log << "Mid-clicked tile: " << *tile_pos << std::endl;
 
-                    auto const t = map.debug_getTile({ tile_pos.x, tile_pos.y, tile_pos.z });
+                    auto const t = map.debug_getTile({ tile_pos->x, tile_pos->y, tile_pos->z });
                     if (t) { gui_mgr.tile_gui.set_tile(t); }	//TODO: NOW: Forse meglio impostare la posizione e poi accedere alla mappa direttamente dal gui_mgr (per rendere esplicita la dipendenza)
 
                     break;
@@ -461,10 +472,7 @@ namespace MainWindow
 
                 case GLFW_MOUSE_BUTTON_RIGHT:
                 {
-                    auto const tile_pos = graphics_manager.glfwWindowPixel_to_mapTile(mouse_pos);
-                    //map.debug_createDestroy_door(tile_pos);
-                    //map.debug_buildBorder(tile_pos);
-                    tileGraphics_mediator.debug_record_tileStyleChange(tile_pos, TileType::sky);
+                    u_ptr->tileStyle_picking = graphics_manager.request_mapTilePicking(mouse_pos);
 
                     break;
                 }
@@ -515,6 +523,32 @@ namespace MainWindow
         graphics_manager.resize_window(new_size);
     }
 
+
+    void resolve_tilePickings(MainWindowObjects & objects)
+    {
+        auto & graphics_manager = objects.graphics_manager;
+
+        if (objects.teleport_picking)
+        {
+            if (auto const tile_pos = graphics_manager.picked_mapTile(objects.teleport_picking))
+            {
+                objects.map.new_mobileEvent<DebugPlayerTeleportationEv>(*tile_pos);
+                objects.teleport_picking = 0u;
+            }
+        }
+
+        if (objects.tileStyle_picking)
+        {
+            if (auto const tile_pos = graphics_manager.picked_mapTile(objects.tileStyle_picking))
+            {
+                //objects.map.debug_createDestroy_door(*tile_pos);
+                //objects.map.debug_buildBorder(*tile_pos);
+                objects.tileGraphics_mediator.debug_record_tileStyleChange(*tile_pos, TileType::sky);
+                objects.tileStyle_picking = 0u;
+            }
+        }
+    }
+
 } //namespace MainWindow
 
 
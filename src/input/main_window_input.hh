@@ -29,6 +29,11 @@ namespace MainWindow
     void framebufferSize_callback(Window & window, Vector2i const new_size);
 
     void windowSize_callback(Window & window, Vector2i const new_size);
+
+    ////
+    //	Apply the tile pickings requested by the mouse buttons whose result is ready. It must be called once per frame.
+    ////
+    void resolve_tilePickings(MainWindowObjects & objects);
 }
 
 
@@ -26,6 +26,10 @@ struct MainWindowObjects
     GuiManager & gui_mgr;
 
     std::vector<BuildingId> & created_buildings;
+
+    // Asynchronous tile pickings requested by the mouse buttons, 0 when none is pending (see MainWindow::resolve_tilePickings())
+    PickingId teleport_picking = 0u;
+    PickingId tileStyle_picking = 0u;
 };
 
 
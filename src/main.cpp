@@ -1,8 +1,66 @@
 #include "game.hh"
 
 
-int main()
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "map/simulation_batch_runner.hh"
+
+
+namespace
+{
+    ////
+    //	@return: The number of seeds of "--batch N", or nothing if @arg isn't a positive integer.
+    ////
+    auto parse_seedCount(std::string const& arg) -> std::optional<unsigned>
+    {
+        if (arg.empty() || arg.find_first_not_of("0123456789") != std::string::npos) { return {}; }
+
+        try
+        {
+            auto const count = std::stoul(arg);
+            if (count == 0u || count > std::numeric_limits<unsigned>::max()) { return {}; }
+
+            return static_cast<unsigned>(count);
+        }
+        catch (std::out_of_range const&)
+        {
+            return {};
+        }
+    }
+}
+
+
+////
+//	"--batch N": Instead of opening the game, run the city development on N seeds (starting from the test seed) and print the metrics
+//	of each seed in CSV format.
+////
+int main(int argc, char * argv[])
 {
+    if (argc > 1 && std::string{ argv[1] } == "--batch")
+    {
+        auto const seed_count = argc == 3 ? parse_seedCount(argv[2]) : std::nullopt;
+        if (!seed_count)
+        {
+            std::cerr << "Usage: " << argv[0] << " [--batch N]\n"
+                      << "  --batch N   Run the city development on N seeds (N > 0) and print their metrics in CSV format.\n";
+            return 1;
+        }
+
+        auto seeds = std::vector<unsigned>(seed_count.value());
+        std::iota(seeds.begin(), seeds.end(), tgm::sim_settings.test_seed);
+
+        auto const runner = tgm::SimulationBatchRunner{ tgm::SimulationBatchParameters{} };
+        tgm::SimulationBatchRunner::write_csv(std::cout, runner.run(seeds));
+
+        return 0;
+    }
+
     auto game = tgm::Game{};
 
     while (!game.should_shutdown())
@@ -40,7 +40,10 @@ class AreaTemplate
 
 
         auto min_dims() const noexcept { return m_min_dims; }
-        bool is_roofable() const noexcept { return sim_settings.map.roof_every_area ? true : m_roofable; }
+        ////
+        //	@roof_everyArea: MapSettings::roof_every_area of the simulation, which makes every area roofable.
+        ////
+        bool is_roofable(bool const roof_everyArea) const noexcept { return roof_everyArea || m_roofable; }
         auto tile_style() const noexcept { return m_tile_style; }
         auto border_style() const noexcept { return m_border_style; }
         auto debug_color() const noexcept { return m_debug_color; }
@@ -120,7 +120,32 @@ void Building::remove_area(BuildingAreaId const aid)
     if(!m_areas.destroy(aid)) {	throw std::runtime_error("Tried to remove an already destroyed area from the building."); }
 }
 
-auto Building::select_candidateAreas(std::unordered_map<AreaType, AreaExpansionTemplate> const& bld_exptempl, std::mt19937 & gen) -> std::vector<AreaType>
+void Building::begin_transaction()
+{
+    m_areas.begin_transaction();
+    m_transaction_backup = TransactionBackup{ m_expansion_step, m_external_doors, m_blind_doors };
+}
+
+void Building::commit_transaction() noexcept
+{
+    m_areas.commit_transaction();
+    m_transaction_backup.reset();
+}
+
+void Building::rollback_transaction()
+{
+    m_areas.rollback_transaction();
+
+    if (m_transaction_backup)
+    {
+        m_expansion_step = m_transaction_backup->expansion_step;
+        m_external_doors = std::move(m_transaction_backup->external_doors);
+        m_blind_doors = std::move(m_transaction_backup->blind_doors);
+        m_transaction_backup.reset();
+    }
+}
+
+auto Building::select_candidateAreas(std::unordered_map<AreaType, AreaExpansionTemplate> const& bld_exptempl, RandomStream & gen) const -> std::vector<AreaType>
 {
     std::vector<AreaType> candidate_areas;
 
@@ -132,13 +157,15 @@ auto Building::select_candidateAreas(std::unordered_map<AreaType, AreaExpansionT
         }
     }
 
+    // The iteration order of the unordered_map depends on the standard library, so sort the areas before shuffling them.
+    std::sort(candidate_areas.begin(), candidate_areas.end());
     shuffle_candidateAreas(gen, candidate_areas);
 
     return candidate_areas;
 }
 
 //TODO: PERFORMANCE: Find a better algorithm for this function.
-bool Building::are_areaPrerequisites_satisfied(AreaExpansionTemplate const& aet)
+bool Building::are_areaPrerequisites_satisfied(AreaExpansionTemplate const& aet) const
 {
     for (auto const req : aet.m_required_areas)
     {
@@ -153,9 +180,9 @@ bool Building::are_areaPrerequisites_satisfied(AreaExpansionTemplate const& aet)
 }
 
 //TODO: Make this function sort the vector giving more priority to candidate areas of higher cost
-void Building::shuffle_candidateAreas(std::mt19937 & gen, std::vector<AreaType> & careas)
+void Building::shuffle_candidateAreas(RandomStream & gen, std::vector<AreaType> & careas)
 {
-    std::shuffle(careas.begin(), careas.end(), gen);
+    gen.shuffle(careas.begin(), careas.end());
 }
 
 auto Building::find_replaceableAreas(BuildingId const bid, AreaType const atype, 
@@ -180,7 +207,7 @@ auto Building::find_replaceableAreas(BuildingId const bid, AreaType const atype,
 auto operator<<(std::ofstream & ofs, Building const& b) -> std::ofstream &
 {
     //TODO: 12: Finire i file stream di Building
-    ofs << b.m_expansionTemplate_id << ' ' << b.m_cid << ' ' << b.m_cbid << '\n';
+    ofs << b.m_expansionTemplate_id << ' ' << b.m_cid << ' ' << b.m_cbid << ' ' << b.m_expansion_step << '\n';
 //	ofs << b.m_areas << '\n';//TODO: 12: Implementa il file stream operator per BuildingArea
     ofs << b.m_external_doors << '\n';
     ofs << b.m_blind_doors;
@@ -190,7 +217,7 @@ auto operator<<(std::ofstream & ofs, Building const& b) -> std::ofstream &
 
 auto operator>>(std::ifstream & ifs, Building & b) -> std::ifstream &
 {
-    ifs >> b.m_expansionTemplate_id >> b.m_cid >> b.m_cbid;
+    ifs >> b.m_expansionTemplate_id >> b.m_cid >> b.m_cbid >> b.m_expansion_step;
 //	ifs >> b.m_areas; //TODO: 12: Implementa il file stream operator per BuildingArea
     ifs >> b.m_external_doors;
     ifs >> b.m_blind_doors;
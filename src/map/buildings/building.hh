@@ -4,10 +4,11 @@
 
 #include <iostream>
 #include <memory>
-#include <random>
+#include <optional>
 #include <set>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 
 #include "data_strctures/data_array.hh"
 #include "map/buildings/area_expansion_template.hh"
@@ -15,6 +16,7 @@
 #include "map/buildings/building_area.hh"
 #include "map/map_forward_decl.hh"
 #include "system/parallelepiped.hh"
+#include "utilities/random_stream.hh"
 
 #include "debug/logger/log_streams.hh"
 
@@ -49,6 +51,11 @@ class Building
 
 
         auto expTempl_id() const { return m_expansionTemplate_id; }
+
+        ////
+        //	@return: The progressive number of the next expansion attempt, used to derive the RandomStream of the attempt.
+        ////
+        auto next_expansionStep() noexcept -> std::uint64_t { return m_expansion_step++; }
         
         auto cid() const -> CityId;
         auto cbid() const -> CityBlockId;
@@ -76,12 +83,21 @@ class Building
         void add_blindDoor(Vector3i const pos);
         void remove_blindDoor(Vector3i const pos);
 
+        ////
+        //	Record the changes until commit_transaction() or rollback_transaction() is called: the areas are saved one by one, the first 
+        //	time they're touched, and only the doors and the expansion step are copied, so the building is never copied whole.
+        //	Started by DataArray<Building> the first time the building is accessed mutably during a transaction.
+        ////
+        void begin_transaction();
+        void commit_transaction() noexcept;
+        void rollback_transaction();
+
 
         ////
         //  @return: Boolean indicating if the candidate areas could reuse an abandoned area. Integer indicating the power. 
         //           Pointer to a vector of candidate areas.
         ////
-        auto propose_expansion(std::unordered_map<AreaType, AreaExpansionTemplate> const& bld_exptempl, std::mt19937 & gen) -> std::tuple<bool, int, std::vector<AreaType>>
+        auto propose_expansion(std::unordered_map<AreaType, AreaExpansionTemplate> const& bld_exptempl, RandomStream & gen) const -> std::tuple<bool, int, std::vector<AreaType>>
         {
             std::tuple<bool, int, std::vector<AreaType>> ret; //NRVO
             auto & [reuse, power, candidate_areas] = ret;
@@ -107,16 +123,25 @@ class Building
 
         CityId m_cid = 0;
         CityBlockId m_cbid = 0;
+        std::uint64_t m_expansion_step = 0u;
         DataArray<BuildingArea, true> m_areas{ 10u }; 
 
         std::vector<Vector3i> m_external_doors;
         std::vector<Vector3i> m_blind_doors;
 
+        struct TransactionBackup
+        {
+            std::uint64_t expansion_step;
+            std::vector<Vector3i> external_doors;
+            std::vector<Vector3i> blind_doors;
+        };
+        std::optional<TransactionBackup> m_transaction_backup;	// Members not journaled by m_areas, as they were before the transaction
+
         bool does_area_overlap(IntParallelepiped const vol) const;
         
-        auto select_candidateAreas(std::unordered_map<AreaType, AreaExpansionTemplate> const& bld_exptempl, std::mt19937 & gen) -> std::vector<AreaType>;
-        bool are_areaPrerequisites_satisfied(AreaExpansionTemplate const& pa);
-        void shuffle_candidateAreas(std::mt19937 & gen, std::vector<AreaType> & careas);
+        auto select_candidateAreas(std::unordered_map<AreaType, AreaExpansionTemplate> const& bld_exptempl, RandomStream & gen) const -> std::vector<AreaType>;
+        bool are_areaPrerequisites_satisfied(AreaExpansionTemplate const& pa) const;
+        static void shuffle_candidateAreas(RandomStream & gen, std::vector<AreaType> & careas);
 
         
 
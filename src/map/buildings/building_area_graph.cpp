@@ -0,0 +1,244 @@
+#include "building_area_graph.hh"
+
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace tgm
+{
+
+
+
+void BuildingAreaGraph::add_area(BuildingAreaCompleteId const acid, std::vector<BuildingAreaId> const& neighbours)
+{
+    log_building(acid.bid);
+
+    auto & g = m_graphs[acid.bid];
+
+    if (!g.adjacency.emplace(acid.aid, neighbours).second) { throw std::runtime_error("The BuildingArea is already in the BuildingAreaGraph."); }
+
+    for (auto const n : neighbours)
+    {
+        auto const it = g.adjacency.find(n);
+        if (it == g.adjacency.end()) { throw std::runtime_error("The neighbour of a BuildingArea isn't in the BuildingAreaGraph."); }
+
+        it->second.push_back(acid.aid);
+    }
+
+    // A dirty union-find is rebuilt as a whole when needed
+    if (!g.dirty)
+    {
+        g.parents.emplace(acid.aid, acid.aid);
+        ++g.components;
+
+        for (auto const n : neighbours)
+        {
+            unite(g, acid.aid, n);
+        }
+    }
+}
+
+void BuildingAreaGraph::remove_area(BuildingAreaCompleteId const acid)
+{
+    auto const git = m_graphs.find(acid.bid);
+    if (git == m_graphs.end() || git->second.adjacency.count(acid.aid) == 0)
+    {
+        throw std::runtime_error("The BuildingArea isn't in the BuildingAreaGraph.");
+    }
+
+    log_building(acid.bid);
+
+    auto & g = git->second;
+
+    for (auto const n : g.adjacency.at(acid.aid))
+    {
+        auto & links = g.adjacency.at(n);
+        links.erase(std::find(links.begin(), links.end(), acid.aid));
+    }
+    g.adjacency.erase(acid.aid);
+
+    if (g.adjacency.empty())
+    {
+        m_graphs.erase(git);
+    }
+    else
+    {
+        // The removed area may have been the only link between two parts of the building, which a union-find can't tell
+        g.dirty = true;
+        g.parents.clear();
+    }
+}
+
+
+bool BuildingAreaGraph::is_connected(BuildingId const bid)
+{
+    auto const git = m_graphs.find(bid);
+    if (git == m_graphs.end()) { return true; }
+
+    auto & g = git->second;
+    if (g.dirty) { rebuild(g); }
+
+    return g.components == 1u;
+}
+
+bool BuildingAreaGraph::is_connected_after(BuildingId const bid, std::pmr::unordered_set<BuildingAreaId> const& removed,
+                                           std::pmr::vector<BuildingAreaId> const& ghost_neighbours,
+                                           std::pmr::memory_resource * const scratch) const
+{
+    auto const git = m_graphs.find(bid);
+    if (git == m_graphs.cend()) { return true; }
+
+    auto const& g = git->second;
+
+    auto const remaining = static_cast<std::size_t>(std::count_if(g.adjacency.cbegin(), g.adjacency.cend(),
+                                                                  [&removed](auto const& node) { return removed.count(node.first) == 0; }));
+    if (remaining == 0u) { return true; }
+    if (ghost_neighbours.empty()) { return false; }
+
+    // Nothing is removed from a building already known to be connected: the new area only has to touch it
+    if (remaining == g.adjacency.size() && !g.dirty && g.components == 1u) { return true; }
+
+    // Otherwise visit the remaining areas starting from those touched by the new one
+    auto reached = std::pmr::unordered_set<BuildingAreaId>{ scratch };
+    auto frontier = std::pmr::vector<BuildingAreaId>{ scratch };
+
+    for (auto const n : ghost_neighbours)
+    {
+        if (removed.count(n) == 0 && reached.insert(n).second) { frontier.push_back(n); }
+    }
+
+    while (!frontier.empty())
+    {
+        auto const aid = frontier.back();
+        frontier.pop_back();
+
+        for (auto const n : g.adjacency.at(aid))
+        {
+            if (removed.count(n) == 0 && reached.insert(n).second) { frontier.push_back(n); }
+        }
+    }
+
+    return reached.size() == remaining;
+}
+
+auto BuildingAreaGraph::area_count(BuildingId const bid) const -> std::size_t
+{
+    auto const git = m_graphs.find(bid);
+
+    return git == m_graphs.cend() ? 0u : git->second.adjacency.size();
+}
+
+
+bool operator==(BuildingAreaGraph const& lhs, BuildingAreaGraph const& rhs)
+{
+    // A building whose areas were all removed can keep an empty graph, that equals a missing one.
+    auto const includes = [](BuildingAreaGraph const& a, BuildingAreaGraph const& b)
+        {
+            for (auto const& [bid, g] : a.m_graphs)
+            {
+                auto const git = b.m_graphs.find(bid);
+                if (git == b.m_graphs.cend() ? !g.adjacency.empty() : g.adjacency != git->second.adjacency) { return false; }
+            }
+            return true;
+        };
+
+    return includes(lhs, rhs) && includes(rhs, lhs);
+}
+
+
+void BuildingAreaGraph::begin_transaction()
+{
+    #if DYNAMIC_ASSERTS
+        if (m_transaction) { throw std::runtime_error("A transaction of the BuildingAreaGraph is already active."); }
+    #endif
+
+    m_transaction = true;
+}
+
+void BuildingAreaGraph::commit_transaction()
+{
+    m_undo_log.clear();
+    m_logged_buildings.clear();
+    m_transaction = false;
+}
+
+void BuildingAreaGraph::rollback_transaction()
+{
+    for (auto it = m_undo_log.rbegin(); it != m_undo_log.rend(); ++it)
+    {
+        auto & [bid, graph] = *it;
+
+        if (graph) { m_graphs[bid] = std::move(*graph); }
+        else	   { m_graphs.erase(bid); }
+    }
+
+    m_undo_log.clear();
+    m_logged_buildings.clear();
+    m_transaction = false;
+}
+
+
+void BuildingAreaGraph::log_building(BuildingId const bid)
+{
+    // The graphs of the buildings are small, so the first change of a transaction saves the whole graph
+    if (!m_transaction || !m_logged_buildings.insert(bid).second) { return; }
+
+    auto const git = m_graphs.find(bid);
+
+    if (git == m_graphs.cend()) { m_undo_log.emplace_back(bid, std::nullopt); }
+    else						{ m_undo_log.emplace_back(bid, git->second); }
+}
+
+auto BuildingAreaGraph::find(BuildingGraph & g, BuildingAreaId aid) -> BuildingAreaId
+{
+    auto parent = g.parents.at(aid);
+
+    // Path halving
+    while (parent != aid)
+    {
+        auto const grandparent = g.parents.at(parent);
+        g.parents[aid] = grandparent;
+
+        aid = grandparent;
+        parent = g.parents.at(aid);
+    }
+
+    return aid;
+}
+
+void BuildingAreaGraph::unite(BuildingGraph & g, BuildingAreaId const lhs, BuildingAreaId const rhs)
+{
+    auto const lhs_root = find(g, lhs);
+    auto const rhs_root = find(g, rhs);
+
+    if (lhs_root != rhs_root)
+    {
+        g.parents[lhs_root] = rhs_root;
+        --g.components;
+    }
+}
+
+void BuildingAreaGraph::rebuild(BuildingGraph & g)
+{
+    g.parents.clear();
+    g.components = g.adjacency.size();
+
+    for (auto const& [aid, neighbours] : g.adjacency)
+    {
+        g.parents.emplace(aid, aid);
+    }
+    for (auto const& [aid, neighbours] : g.adjacency)
+    {
+        for (auto const n : neighbours)
+        {
+            unite(g, aid, n);
+        }
+    }
+
+    g.dirty = false;
+}
+
+
+
+} // namespace tgm
\ No newline at end of file
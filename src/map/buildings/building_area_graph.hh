@@ -0,0 +1,94 @@
+#ifndef GM_BUILDING_AREA_GRAPH_HH
+#define GM_BUILDING_AREA_GRAPH_HH
+
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "map/map_forward_decl.hh"
+#include "settings/debug/debug_settings.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//
+//	Adjacency graph of the areas of each building: two areas are linked when they share a wall long enough to host a door. The
+//	connected components are tracked by a union-find, updated when an area is added and rebuilt from the adjacency lists, only when
+//	asked, after an area was removed. So the connectivity of a building is known without exploring the map.
+//	The const queries can run concurrently, but not during an update. Like the BuildingAreaIndex, it can record its changes in an undo
+//	log.
+//
+////
+class BuildingAreaGraph
+{
+    public:
+        ////
+        //	Add the area @acid, linked to the areas @neighbours of the same building.
+        ////
+        void add_area(BuildingAreaCompleteId const acid, std::vector<BuildingAreaId> const& neighbours);
+        void remove_area(BuildingAreaCompleteId const acid);
+
+        ////
+        //	@return: True if the areas of @bid form a single component (an empty building is connected). Rebuilds the union-find of the
+        //			 building if an area was removed since it was last computed.
+        ////
+        bool is_connected(BuildingId const bid);
+
+        ////
+        //	@return: True if the areas of @bid that aren't in @removed, plus a new area linked to @ghost_neighbours, would form a single
+        //			 component. A building whose areas are all removed is connected. The visit allocates in @scratch.
+        ////
+        bool is_connected_after(BuildingId const bid, std::pmr::unordered_set<BuildingAreaId> const& removed,
+                                std::pmr::vector<BuildingAreaId> const& ghost_neighbours, std::pmr::memory_resource * const scratch) const;
+
+        auto area_count(BuildingId const bid) const -> std::size_t;
+
+        ////
+        //	@return: True if both graphs link the same areas of the same buildings, in the same order. The union-finds aren't compared,
+        //			 since they're derived from the adjacency lists.
+        ////
+        friend bool operator==(BuildingAreaGraph const& lhs, BuildingAreaGraph const& rhs);
+        friend bool operator!=(BuildingAreaGraph const& lhs, BuildingAreaGraph const& rhs) { return !(lhs == rhs); }
+
+        void begin_transaction();
+        void commit_transaction();
+        void rollback_transaction();
+
+    private:
+        struct BuildingGraph
+        {
+            std::unordered_map<BuildingAreaId, std::vector<BuildingAreaId>> adjacency;
+            std::unordered_map<BuildingAreaId, BuildingAreaId> parents;		// Union-find, valid only if !dirty
+            std::size_t components = 0u;
+            bool dirty = false;
+        };
+
+        std::unordered_map<BuildingId, BuildingGraph> m_graphs;
+
+        bool m_transaction = false;
+        std::vector<std::pair<BuildingId, std::optional<BuildingGraph>>> m_undo_log;		// Graphs as they were before their first change
+        std::unordered_set<BuildingId> m_logged_buildings;
+
+
+        void log_building(BuildingId const bid);
+
+        static auto find(BuildingGraph & g, BuildingAreaId aid) -> BuildingAreaId;
+        static void unite(BuildingGraph & g, BuildingAreaId const lhs, BuildingAreaId const rhs);
+        static void rebuild(BuildingGraph & g);
+};
+
+
+
+} // namespace tgm
+
+
+#endif //GM_BUILDING_AREA_GRAPH_HH
\ No newline at end of file
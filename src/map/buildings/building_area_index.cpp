@@ -0,0 +1,193 @@
+#include "building_area_index.hh"
+
+
+#include <cstdlib>
+#include <stdexcept>
+
+
+namespace tgm
+{
+
+
+
+BuildingAreaIndex::BuildingAreaIndex(int const length, int const width, int const height, int const cell_dim) :
+    m_cell_dim{ cell_dim },
+    m_cells_x{ cell_dim > 0 ? (length + cell_dim - 1) / cell_dim : 0 },
+    m_cells_y{ cell_dim > 0 ? (width + cell_dim - 1) / cell_dim : 0 },
+    m_floors{ height }
+{
+    if (cell_dim <= 0) { throw std::runtime_error("The side of the cells of the BuildingAreaIndex must be positive."); }
+
+    m_cells.resize(static_cast<std::size_t>(m_cells_x) * m_cells_y * m_floors);
+}
+
+
+void BuildingAreaIndex::insert(BuildingAreaCompleteId const acid, CityBlockId const cbid, IntParallelepiped const& volume)
+{
+    if (volume.down < 0 || volume.up() >= m_floors) { throw std::runtime_error("Cannot index a BuildingArea lying outside the map."); }
+
+    auto const entry = Entry{ acid, cbid, volume };
+    internal_insert(entry);
+
+    if (m_transaction) { m_undo_log.emplace_back(true, entry); }
+}
+
+void BuildingAreaIndex::remove(BuildingAreaCompleteId const acid, IntParallelepiped const& volume)
+{
+    auto entry = std::optional<Entry>{};
+
+    // The entry is needed to reinsert the area if the transaction is rolled back
+    if (m_transaction)
+    {
+        for (auto const& e : m_cells[cell_index(cell_x(volume.behind), cell_y(volume.left), volume.down)])
+        {
+            if (e.acid == acid) { entry = e; break; }
+        }
+    }
+
+    internal_remove(acid, volume);
+
+    if (entry) { m_undo_log.emplace_back(false, *entry); }
+}
+
+
+void BuildingAreaIndex::query_rect(IntParallelepiped const& volume, std::vector<BuildingAreaCompleteId> & acids) const
+{
+    for_each_intersecting(volume, [&acids](Entry const& e) { acids.push_back(e.acid); });
+}
+
+void BuildingAreaIndex::query_point(Vector3i const pos, std::vector<BuildingAreaCompleteId> & acids) const
+{
+    query_rect({ pos.x, pos.y, pos.z, 1, 1, 1 }, acids);
+}
+
+auto BuildingAreaIndex::nearest_area(Vector3i const pos, int const max_distance) const -> std::optional<BuildingAreaCompleteId>
+{
+    if (pos.z < 0 || pos.z >= m_floors) { return std::nullopt; }
+
+    auto const distance = [pos](IntParallelepiped const& v)
+    {
+        auto const dx = std::max({ v.behind - pos.x, 0, pos.x - v.front() });
+        auto const dy = std::max({ v.left - pos.y, 0, pos.y - v.right() });
+
+        return std::max(dx, dy);
+    };
+
+    auto best = std::optional<BuildingAreaCompleteId>{};
+    auto best_distance = max_distance + 1;
+
+    auto const cx = cell_x(pos.x);
+    auto const cy = cell_y(pos.y);
+    auto const max_ring = std::max(m_cells_x, m_cells_y);
+
+    // Visit the rings of cells around the cell of @pos. Every tile of the ring r+1 is at least r*m_cell_dim far from @pos, so the search
+    // stops as soon as no farther ring can hold a nearer area.
+    for (auto r = 0; r <= max_ring && (r - 1) * m_cell_dim < best_distance; ++r)
+    {
+        for (auto x = cx - r; x <= cx + r; ++x)
+        {
+            for (auto y = cy - r; y <= cy + r; ++y)
+            {
+                if (std::max(std::abs(x - cx), std::abs(y - cy)) != r) { continue; }
+                if (x < 0 || y < 0 || x >= m_cells_x || y >= m_cells_y) { continue; }
+
+                for (auto const& e : m_cells[cell_index(x, y, pos.z)])
+                {
+                    auto const d = distance(e.volume);
+
+                    // Ties are broken by the ids, so that the result doesn't depend on the order of the entries
+                    if (d < best_distance || (d == best_distance && best &&
+                                              (e.acid.bid < best->bid || (e.acid.bid == best->bid && e.acid.aid < best->aid))))
+                    {
+                        best = e.acid;
+                        best_distance = d;
+                    }
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+
+void BuildingAreaIndex::begin_transaction()
+{
+    #if DYNAMIC_ASSERTS
+        if (m_transaction) { throw std::runtime_error("A transaction of the BuildingAreaIndex is already active."); }
+    #endif
+
+    m_transaction = true;
+}
+
+void BuildingAreaIndex::commit_transaction()
+{
+    m_undo_log.clear();
+    m_transaction = false;
+}
+
+void BuildingAreaIndex::rollback_transaction()
+{
+    for (auto it = m_undo_log.crbegin(); it != m_undo_log.crend(); ++it)
+    {
+        auto const& [inserted, entry] = *it;
+
+        if (inserted) { internal_remove(entry.acid, entry.volume); }
+        else		  { internal_insert(entry); }
+    }
+
+    m_undo_log.clear();
+    m_transaction = false;
+}
+
+
+void BuildingAreaIndex::internal_insert(Entry const& entry)
+{
+    auto const& v = entry.volume;
+
+    for (auto z = v.down; z <= v.up(); ++z)
+    {
+        for (auto cx = cell_x(v.behind); cx <= cell_x(v.front()); ++cx)
+        {
+            for (auto cy = cell_y(v.left); cy <= cell_y(v.right()); ++cy)
+            {
+                m_cells[cell_index(cx, cy, z)].push_back(entry);
+            }
+        }
+    }
+
+    ++m_size;
+}
+
+void BuildingAreaIndex::internal_remove(BuildingAreaCompleteId const acid, IntParallelepiped const& volume)
+{
+    auto found = false;
+
+    for (auto z = std::max(volume.down, 0); z <= std::min(volume.up(), m_floors - 1); ++z)
+    {
+        for (auto cx = cell_x(volume.behind); cx <= cell_x(volume.front()); ++cx)
+        {
+            for (auto cy = cell_y(volume.left); cy <= cell_y(volume.right()); ++cy)
+            {
+                auto & cell = m_cells[cell_index(cx, cy, z)];
+                auto const it = std::find_if(cell.begin(), cell.end(), [acid](Entry const& e) { return e.acid == acid; });
+
+                if (it != cell.end())
+                {
+                    // The order inside a cell doesn't matter
+                    *it = cell.back();
+                    cell.pop_back();
+                    found = true;
+                }
+            }
+        }
+    }
+
+    if (!found) { throw std::runtime_error("The BuildingArea isn't in the BuildingAreaIndex with the given volume."); }
+
+    --m_size;
+}
+
+
+
+} // namespace tgm
\ No newline at end of file
@@ -0,0 +1,163 @@
+#ifndef GM_BUILDING_AREA_INDEX_HH
+#define GM_BUILDING_AREA_INDEX_HH
+
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "map/map_forward_decl.hh"
+#include "settings/debug/debug_settings.hh"
+#include "system/parallelepiped.hh"
+#include "system/vector3.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//
+//	Uniform grid of the volumes of all the BuildingAreas of the map. Each cell is a square of tiles of a floor and lists the areas
+//	overlapping it, so the areas near a position are found without visiting every building. An area lying on many cells is reported
+//	once per query, by the first of its cells visited, so the queries don't allocate.
+//	The queries can run concurrently, but not during an update. Like the TileSet, it can record its changes in an undo log.
+//
+////
+class BuildingAreaIndex
+{
+    public:
+        struct Entry
+        {
+            BuildingAreaCompleteId acid;
+            CityBlockId cbid;
+            IntParallelepiped volume;
+        };
+
+        ////
+        //	@length, @width, @height: Dimensions of the map (in tiles).
+        //	@cell_dim: Side of a cell (in tiles).
+        ////
+        BuildingAreaIndex(int const length, int const width, int const height, int const cell_dim);
+
+        void insert(BuildingAreaCompleteId const acid, CityBlockId const cbid, IntParallelepiped const& volume);
+        void remove(BuildingAreaCompleteId const acid, IntParallelepiped const& volume);
+
+        ////
+        //	Call @f(entry) for each area sharing at least a tile with @volume.
+        ////
+        template <typename F>
+        void for_each_intersecting(IntParallelepiped const& volume, F && f) const;
+
+        ////
+        //	@return: True if @pred(entry) is true for any area sharing at least a tile with @volume.
+        ////
+        template <typename P>
+        bool any_intersecting(IntParallelepiped const& volume, P && pred) const;
+
+        ////
+        //	Append to @acids the areas sharing at least a tile with @volume.
+        ////
+        void query_rect(IntParallelepiped const& volume, std::vector<BuildingAreaCompleteId> & acids) const;
+
+        ////
+        //	Append to @acids the areas whose volume contains @pos (a shared border belongs to both its areas).
+        ////
+        void query_point(Vector3i const pos, std::vector<BuildingAreaCompleteId> & acids) const;
+
+        ////
+        //	@return: The area of the floor of @pos nearest to it, if any is at most @max_distance far (Chebyshev distance in tiles, 0 if the
+        //			 area contains @pos).
+        ////
+        auto nearest_area(Vector3i const pos, int const max_distance) const -> std::optional<BuildingAreaCompleteId>;
+
+        auto size() const noexcept { return m_size; }
+
+        void begin_transaction();
+        void commit_transaction();
+        void rollback_transaction();
+
+    private:
+        int const m_cell_dim;
+        int const m_cells_x;		// Cells along x on each floor
+        int const m_cells_y;		// Cells along y on each floor
+        int const m_floors;
+
+        std::vector<std::vector<Entry>> m_cells;
+        std::size_t m_size = 0u;
+
+        bool m_transaction = false;
+        std::vector<std::pair<bool, Entry>> m_undo_log;		// (true if inserted, area), in the order they happened
+
+
+        auto cell_index(int const cx, int const cy, int const z) const noexcept -> std::size_t
+        {
+            return (static_cast<std::size_t>(z) * m_cells_x + cx) * m_cells_y + cy;
+        }
+
+        auto cell_x(int const x) const noexcept { return std::clamp(x / m_cell_dim, 0, m_cells_x - 1); }
+        auto cell_y(int const y) const noexcept { return std::clamp(y / m_cell_dim, 0, m_cells_y - 1); }
+
+        static bool intersect(IntParallelepiped const& lhs, IntParallelepiped const& rhs) noexcept
+        {
+            return lhs.behind <= rhs.front() && rhs.behind <= lhs.front()
+                && lhs.left <= rhs.right()   && rhs.left <= lhs.right()
+                && lhs.down <= rhs.up()      && rhs.down <= lhs.up();
+        }
+
+        void internal_insert(Entry const& entry);
+        void internal_remove(BuildingAreaCompleteId const acid, IntParallelepiped const& volume);
+};
+
+
+template <typename F>
+void BuildingAreaIndex::for_each_intersecting(IntParallelepiped const& volume, F && f) const
+{
+    any_intersecting(volume, [&f](Entry const& e) { f(e); return false; });
+}
+
+template <typename P>
+bool BuildingAreaIndex::any_intersecting(IntParallelepiped const& volume, P && pred) const
+{
+    auto const first_z = std::max(volume.down, 0);
+    auto const last_z = std::min(volume.up(), m_floors - 1);
+
+    auto const first_cx = cell_x(volume.behind);
+    auto const last_cx = cell_x(volume.front());
+    auto const first_cy = cell_y(volume.left);
+    auto const last_cy = cell_y(volume.right());
+
+    for (auto z = first_z; z <= last_z; ++z)
+    {
+        for (auto cx = first_cx; cx <= last_cx; ++cx)
+        {
+            for (auto cy = first_cy; cy <= last_cy; ++cy)
+            {
+                for (auto const& e : m_cells[cell_index(cx, cy, z)])
+                {
+                    if (!intersect(e.volume, volume)) { continue; }
+
+                    // Report the area only from the first cell shared by the query and by the area
+                    if (cx == std::max(cell_x(e.volume.behind), first_cx) && cy == std::max(cell_y(e.volume.left), first_cy)
+                        && z == std::max(e.volume.down, first_z)
+                        && pred(e))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+
+
+} // namespace tgm
+
+
+#endif //GM_BUILDING_AREA_INDEX_HH
\ No newline at end of file
@@ -1,6 +1,13 @@
 #include "building_manager.hh"
 
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <tuple>
+#include <utility>
+
 #include "map/buildings/roof_algorithm.hh"
 #include "settings/simulation/simulation_settings.hh"
 #include "utilities.hh"
@@ -14,9 +21,10 @@ namespace tgm
 
 
 
-BuildingManager::BuildingManager(std::mt19937 & random_generator, TileSet & tiles, DataArray<Building> & buildings, DoorManager & door_manager, 
-                                 TileGraphicsMediator & tg_mediator, RoofGraphicsMediator & rg_mediator) :
-    m_random_generator{ random_generator },
+BuildingManager::BuildingManager(SimulationContext & context, std::uint64_t const seed, TileSet & tiles, DataArray<Building> & buildings, 
+                                 DoorManager & door_manager, TileGraphicsMediator & tg_mediator, RoofGraphicsMediator & rg_mediator) :
+    m_context{ context },
+    m_seed{ seed },
     m_tiles{ tiles },
     m_buildings{ buildings },
     m_door_manager{ door_manager },
@@ -44,7 +52,7 @@ BuildingManager::~BuildingManager()
             HRMdeb.stop();
         #endif
         } catch (std::exception const& e) {
-            g_log << "Error stopping VisualDebug: " << e.what();
+            m_context.log << "Error stopping VisualDebug: " << e.what();
             std::terminate();
         }
     #endif
@@ -119,7 +127,7 @@ auto BuildingManager::buildBuilding_inNearestCity(BuildingRecipe const& recipe)
     #endif
 
     
-    return new_bid;
+    return ret;
 }
 
 auto BuildingManager::build_firstBuilding_inCity(CityId const cid, CityBlockId const cbid, 
@@ -149,6 +157,7 @@ auto BuildingManager::build_building_inCity(BuildingRecipe const& recipe, CityId
 
 
     auto & city = m_cities.get_or_throw(cid);
+    auto rng = RandomStream{ m_seed, RandomDomain::city_expansion, cid, city.next_expansionStep() };
 
     auto const area_surface = recipe.startingArea_dims().x * recipe.startingArea_dims().y;
 
@@ -157,7 +166,7 @@ auto BuildingManager::build_building_inCity(BuildingRecipe const& recipe, CityId
     // If there are no blocks, then create the first one
     if (city.empty())
     {
-        auto & [cbid, cb] = m_blocks.create();
+        auto & [cbid, cb] = m_blocks.create(m_context.settings.map.max_cityBlockSurface);
         city.add_block(cbid);
 
         new_bid = build_firstBuilding_inCity(cid, cbid, tgm::Utilities::v2f_to_v3i(recipe.proposed_position()), recipe, replaceable_areas, cb);
@@ -179,7 +188,7 @@ auto BuildingManager::build_building_inCity(BuildingRecipe const& recipe, CityId
 
                 auto best_pos = Vector3i{};
                 auto replaced_areas = std::vector<BuildingAreaCompleteId>{};
-                if (is_blockExpansion_possible(cbid, cblock, recipe, replaceable_areas, best_pos, replaced_areas))
+                if (is_blockExpansion_possible(cbid, cblock, recipe, replaceable_areas, best_pos, replaced_areas, rng))
                 {
                     new_bid = internal_build_building(cid, cbid, best_pos, recipe, replaced_areas, cblock);
 
@@ -197,7 +206,7 @@ auto BuildingManager::build_building_inCity(BuildingRecipe const& recipe, CityId
         // If all the blocks are full, then create a new block.
         if (new_bid == 0u)
         {
-            auto & [cbid, cb] = m_blocks.create();
+            auto & [cbid, cb] = m_blocks.create(m_context.settings.map.max_cityBlockSurface);
             city.add_block(cbid);
         
             #if BUILDEXP_VISUALDEBUG
@@ -206,7 +215,7 @@ auto BuildingManager::build_building_inCity(BuildingRecipe const& recipe, CityId
 
             auto best_pos = Vector3i{};
             auto replaced_areas = std::vector<BuildingAreaCompleteId>{};
-            if (is_cityExpansion_possible(city, cbid, recipe, replaceable_areas, best_pos, replaced_areas))
+            if (is_cityExpansion_possible(city, cbid, recipe, replaceable_areas, best_pos, replaced_areas, rng))
             {
                 new_bid = internal_build_building(cid, cbid, best_pos, recipe, replaced_areas, cb);
             }
@@ -234,22 +243,121 @@ void BuildingManager::request_buildingExpansion(BuildingId const bid)
 
 void BuildingManager::expand_buildings()
 {
+    #if !BUILDEXP_VISUALDEBUG
+        if (auto const thread_count = expansion_threadCount(); thread_count > 1u)
+        {
+            expand_buildings_inParallel(thread_count);
+            return;
+        }
+    #endif
+
     for (auto n = 0; n < max_buildingExpansions; ++n)
     {
         if (buildingExpansion_queue.empty()) { break; }
         
-        static auto deb_exp_counter = 0u;
-        //g_log << "Expansion #" << deb_exp_counter << std::endl;
-        ++deb_exp_counter;
-
         auto const bid = buildingExpansion_queue.front();
 
-        expand_building(bid, n);
+        ++m_context.stats.processed_expansions;
+        if (expand_building(bid, n))
+        {
+            ++m_context.stats.successful_expansions;
+        }
             
         buildingExpansion_queue.pop();
     }
 }
 
+auto BuildingManager::expansion_threadCount() const -> unsigned
+{
+    auto const thread_count = m_context.settings.map.buildingExpansion_threads;
+
+    return thread_count == 0u ? std::max(std::thread::hardware_concurrency(), 1u) : thread_count;
+}
+
+void BuildingManager::expand_buildings_inParallel(unsigned const thread_count)
+{
+    auto proposals = std::vector<ExpansionProposal>{};
+
+    for (auto n = 0; n < max_buildingExpansions && !buildingExpansion_queue.empty(); ++n)
+    {
+        proposals.push_back({ buildingExpansion_queue.front(), n });
+        buildingExpansion_queue.pop();
+    }
+
+    // Reserve the random streams in queue order. A building queued twice in the same batch is expanded serially the second time, 
+    // since its first expansion changes it.
+    auto batch_buildings = std::unordered_set<BuildingId>{};
+    for (auto & p : proposals)
+    {
+        auto const pb = m_buildings.weak_get(p.bid);
+
+        if (pb && m_unexpandable_buildings.find(p.bid) == m_unexpandable_buildings.end() && batch_buildings.insert(p.bid).second)
+        {
+            p.step = pb->next_expansionStep();
+            p.proposed = true;
+        }
+    }
+
+    // Nothing is changed until all the proposals are computed, so the workers only read the map.
+    auto next_proposal = std::atomic<std::size_t>{ 0u };
+
+    auto const task_count = static_cast<unsigned>(std::clamp<std::size_t>(proposals.size(), 1u, thread_count));
+    m_context.workers.run(task_count, [this, &proposals, &next_proposal](unsigned const)
+        {
+            for (auto i = next_proposal.fetch_add(1u); i < proposals.size(); i = next_proposal.fetch_add(1u))
+            {
+                auto & p = proposals[i];
+                if (!p.proposed) { continue; }
+
+                // Const access, so that a transaction never journals from the workers.
+                auto const& building = std::as_const(m_buildings).get_or_throw(p.bid);
+                propose_buildingExpansion(std::as_const(m_blocks).get_or_throw(building.cbid()), building, p);
+            }
+        });
+
+
+    // Commit in queue order, so that the result doesn't depend on which thread finished first.
+    auto touched_volumes = std::vector<IntParallelepiped>{};
+    auto freed_volumes = std::vector<IntParallelepiped>{};
+
+    for (auto const& p : proposals)
+    {
+        ++m_context.stats.processed_expansions;
+
+        auto expanded = false;
+        auto const pb = p.proposed ? m_buildings.weak_get(p.bid) : nullptr;
+
+        if (pb && is_proposal_stillValid(p, m_blocks.get_or_throw(pb->cbid()), *pb, touched_volumes, freed_volumes))
+        {
+            for (auto const acid : p.replaced_areas)
+            {
+                freed_volumes.push_back(get_area(acid).volume());
+            }
+
+            expanded = commit_buildingExpansion(p, m_blocks.get_or_throw(pb->cbid()), *pb, &touched_volumes);
+        }
+        else
+        {
+            if (p.proposed) { ++m_context.stats.retried_expansions; }
+
+            auto const first_touched = touched_volumes.size();
+            // The step reserved by the proposal is reused, so that the retry draws what the serial expansion would have drawn.
+            expanded = expand_building(p.bid, p.queue_id, &touched_volumes, p.proposed ? std::optional{ p.step } : std::nullopt);
+
+            // The first touched volume is the new area, the next ones are the replaced areas.
+            if (touched_volumes.size() > first_touched + 1u)
+            {
+                freed_volumes.insert(freed_volumes.cend(), touched_volumes.cbegin() + first_touched + 1, touched_volumes.cend());
+            }
+        }
+
+        if (expanded)
+        {
+            ++m_context.stats.successful_expansions;
+        }
+    }
+}
+
 void BuildingManager::debug_expand_random_building()
 {
     for (auto& [bid, b] : m_buildings)
@@ -263,6 +371,12 @@ void BuildingManager::debug_expand_random_building()
 }
 
 bool BuildingManager::expand_building(BuildingId const bid, int const queue_id)
+{
+    return expand_building(bid, queue_id, nullptr);
+}
+
+bool BuildingManager::expand_building(BuildingId const bid, int const queue_id, std::vector<IntParallelepiped> * const touched_volumes,
+                                      std::optional<std::uint64_t> const step)
 {
     auto ret = false;
 
@@ -288,30 +402,13 @@ bool BuildingManager::expand_building(BuildingId const bid, int const queue_id)
                 if(!cblock.contains(bid)) { throw std::runtime_error("The CityBlock doesn't contain the BuildingId of the expanding building."); }
             #endif
 
-            auto [reuse, power, candidate_areas] = building.propose_expansion(building_expansionTemplates.at(building.expTempl_id()), m_random_generator);
-    
-            auto best_position = Vector3i{};
-            auto selected_area = AreaType::none;
-            auto replaced_areas = std::vector<BuildingAreaCompleteId>{};
-
-            if (is_buildingExpansion_possible(cblock, bid, building, candidate_areas, best_position, selected_area, replaced_areas))
-            {
-                internal_expand_building(bid, selected_area, best_position, replaced_areas, cblock, building);
-                
-                #if DYNAMIC_ASSERTS
-                    if (!is_building_connected(bid, building)) { throw std::runtime_error("The areas of the building aren't connected."); }
-                #endif
+            auto proposal = ExpansionProposal{ bid, queue_id, step ? *step : building.next_expansionStep(), true };
+            propose_buildingExpansion(cblock, building, proposal);
 
-                ret = true;
-            }
-            else
-            {
-                m_unexpandable_buildings.insert(bid);
-                ret = false;
-            }
+            ret = commit_buildingExpansion(proposal, cblock, building, touched_volumes);
 
             #if BUILDEXP_DEBUGLOG
-                BElog << Logger::nltb << "---- " << queue_id << "th expansion in queue ends.\n\n";
+                ASYNC_LOG(building_expansion, "---- {}th expansion in queue ends.\n", queue_id);
             #endif
             #if BUILDEXP_VISUALDEBUG
                 BEdeb.end_chapter();
@@ -330,6 +427,270 @@ bool BuildingManager::expand_building(BuildingId const bid, int const queue_id)
     return ret;
 }
 
+void BuildingManager::propose_buildingExpansion(CityBlock const& cblock, Building const& building, ExpansionProposal & proposal) const
+{
+    // Each expansion attempt draws from its own stream, so the result doesn't depend on the order in which the buildings expand.
+    auto rng = RandomStream{ m_seed, RandomDomain::building_expansion, proposal.bid, proposal.step };
+    auto const [reuse, power, candidate_areas] = building.propose_expansion(building_expansionTemplates.at(building.expTempl_id()), rng);
+
+    proposal.possible = is_buildingExpansion_possible(cblock, proposal.bid, building, candidate_areas, 
+                                                      proposal.best_position, proposal.selected_area, proposal.replaced_areas, rng);
+}
+
+bool BuildingManager::commit_buildingExpansion(ExpansionProposal const& proposal, CityBlock & cblock, Building & building,
+                                               std::vector<IntParallelepiped> * const touched_volumes)
+{
+    if (proposal.possible)
+    {
+        if (touched_volumes)
+        {
+            auto const dims = area_templates.at(proposal.selected_area).min_dims();
+            touched_volumes->emplace_back(proposal.best_position.x, proposal.best_position.y, proposal.best_position.z, dims.x, dims.y, 1);
+
+            for (auto const acid : proposal.replaced_areas)
+            {
+                touched_volumes->push_back(get_area(acid).volume());
+            }
+        }
+
+        internal_expand_building(proposal.bid, proposal.selected_area, proposal.best_position, proposal.replaced_areas, cblock, building);
+                
+        #if DYNAMIC_ASSERTS
+            if (m_area_graph.area_count(proposal.bid) != building.areas_by_ref().count() || !m_area_graph.is_connected(proposal.bid))
+            {
+                throw std::runtime_error("The areas of the building aren't connected.");
+            }
+        #endif
+
+        return true;
+    }
+    else
+    {
+        if (m_unexpandable_buildings.insert(proposal.bid).second && m_transaction)
+        {
+            m_transaction_unexpandables.push_back(proposal.bid);
+        }
+
+        return false;
+    }
+}
+
+bool BuildingManager::is_proposal_stillValid(ExpansionProposal const& proposal, CityBlock const& cblock, Building const& building,
+                                             std::vector<IntParallelepiped> const& touched_volumes,
+                                             std::vector<IntParallelepiped> const& freed_volumes) const
+{
+    auto const margin = m_context.settings.map.road_dim + 1;
+    auto const enlarge = [](IntParallelepiped const& vol, int const m) 
+        { 
+            return IntParallelepiped{ vol.behind - m, vol.left - m, vol.down, vol.length + 2 * m, vol.width + 2 * m, vol.height }; 
+        };
+    auto const intersects_any = [](IntParallelepiped const& vol, std::vector<IntParallelepiped> const& others)
+        {
+            return std::any_of(others.cbegin(), others.cend(), [&vol](auto const& o) { return !vol.intersect(o).is_null(); });
+        };
+
+    if (proposal.possible)
+    {
+        auto const dims = area_templates.at(proposal.selected_area).min_dims();
+        if (!cblock.has_room_for(dims.x * dims.y)) { return false; }
+
+        auto const new_vol = IntParallelepiped{ proposal.best_position.x, proposal.best_position.y, proposal.best_position.z, dims.x, dims.y, 1 };
+        if (intersects_any(enlarge(new_vol, margin), touched_volumes)) { return false; }
+
+        for (auto const acid : proposal.replaced_areas)
+        {
+            if (intersects_any(enlarge(get_area(acid).volume(), margin), touched_volumes)) { return false; }
+        }
+
+        // Two distant commits could each take an external door of the same building, or each close an opening of the same outside 
+        // region, so the chosen position is checked again against the current map.
+        std::array<std::byte, expansion_scratchSize> scratch_buffer;
+        auto scratch = std::pmr::monotonic_buffer_resource{ scratch_buffer.data(), scratch_buffer.size() };
+
+        auto const replaceable_areas = building.find_replaceableAreas(proposal.bid, proposal.selected_area, 
+                                                                      building_expansionTemplates.at(building.expTempl_id()));
+        auto const result = is_area_buildable(building.cbid(), proposal.bid, &building, proposal.best_position, dims, replaceable_areas, &scratch);
+        auto const& replaced_areas = result.second;
+
+        return result.first 
+            && replaced_areas.size() == proposal.replaced_areas.size()
+            && std::all_of(proposal.replaced_areas.cbegin(), proposal.replaced_areas.cend(), 
+                           [&replaced_areas](auto const acid) { return replaced_areas.count(acid) == 1u; });
+    }
+    else
+    {
+        // The committed areas can only take space away from a building, so an expansion stays impossible unless some space was freed
+        // close enough to be reached by one of its new areas.
+        auto max_areaDim = 0;
+        for (auto const& [type, templ] : area_templates)
+        {
+            max_areaDim = std::max({ max_areaDim, templ.min_dims().x, templ.min_dims().y });
+        }
+
+        return !intersects_any(enlarge(building.compute_volume(), max_areaDim + margin), freed_volumes);
+    }
+}
+
+void BuildingManager::begin_transaction()
+{
+    #if DYNAMIC_ASSERTS
+        if (m_transaction) { throw std::runtime_error("A transaction of the BuildingManager is already active."); }
+    #endif
+
+    m_tiles.begin_transaction();
+    m_cities.begin_transaction();
+    m_blocks.begin_transaction();
+    m_buildings.begin_transaction();
+    m_roofs.begin_transaction();
+    m_door_manager.begin_transaction();
+    m_area_index.begin_transaction();
+    m_area_graph.begin_transaction();
+    m_outside.begin_transaction();
+
+    m_transaction = true;
+}
+
+void BuildingManager::commit_transaction()
+{
+    m_tiles.commit_transaction();
+    m_cities.commit_transaction();
+    m_blocks.commit_transaction();
+    m_buildings.commit_transaction();
+    m_roofs.commit_transaction();
+    m_door_manager.commit_transaction();
+    m_area_index.commit_transaction();
+    m_area_graph.commit_transaction();
+    m_outside.commit_transaction();
+
+    m_transaction = false;
+
+    for (auto const& vol : m_pending_areaChanges)  { record_areaChange(vol); }
+    for (auto const& pos : m_pending_borderChanges) { record_borderChange(pos); }
+    for (auto const [rid, added] : m_pending_roofChanges)
+    {
+        if (added) { record_roofAddition(rid); }
+        else	   { record_roofRemoval(rid); }
+    }
+    for (auto const& change : m_pending_navChanges) { apply_navChange(change); }
+
+    m_pending_areaChanges.clear();
+    m_pending_borderChanges.clear();
+    m_pending_roofChanges.clear();
+    m_pending_navChanges.clear();
+    m_transaction_unexpandables.clear();
+}
+
+void BuildingManager::rollback_transaction()
+{
+    // Reverse order of begin_transaction(), even if the undo logs are independent.
+    m_outside.rollback_transaction();
+    m_area_graph.rollback_transaction();
+    m_area_index.rollback_transaction();
+    m_door_manager.rollback_transaction();
+    m_roofs.rollback_transaction();
+    m_buildings.rollback_transaction();
+    m_blocks.rollback_transaction();
+    m_cities.rollback_transaction();
+    m_tiles.rollback_transaction();
+
+    for (auto const bid : m_transaction_unexpandables)
+    {
+        m_unexpandable_buildings.erase(bid);
+    }
+
+    m_pending_areaChanges.clear();
+    m_pending_borderChanges.clear();
+    m_pending_roofChanges.clear();
+    m_pending_navChanges.clear();
+    m_transaction_unexpandables.clear();
+
+    m_transaction = false;
+}
+
+auto BuildingManager::evaluate_buildingExpansion(BuildingId const bid) -> std::optional<ExpansionEvaluation>
+{
+    if (!std::as_const(m_buildings).weak_get(bid) || m_unexpandable_buildings.find(bid) != m_unexpandable_buildings.end())
+    {
+        return std::nullopt;
+    }
+
+    auto const doors_before = static_cast<int>(m_door_manager.door_count());
+    auto const roofs_before = static_cast<int>(m_roofs.count());
+
+    begin_transaction();
+
+    try
+    {
+        // Taken after begin_transaction(), so that their changes are journaled.
+        auto & building = m_buildings.get_or_throw(bid);
+        auto & cblock = m_blocks.get_or_throw(building.cbid());
+
+        auto proposal = ExpansionProposal{ bid, 0, building.next_expansionStep(), true };
+        propose_buildingExpansion(cblock, building, proposal);
+
+        auto evaluation = std::optional<ExpansionEvaluation>{};
+        if (proposal.possible)
+        {
+            internal_expand_building(bid, proposal.selected_area, proposal.best_position, proposal.replaced_areas, cblock, building);
+
+            evaluation = ExpansionEvaluation{ proposal.selected_area, proposal.best_position, static_cast<int>(proposal.replaced_areas.size()),
+                                              static_cast<int>(m_door_manager.door_count()) - doors_before,
+                                              static_cast<int>(m_roofs.count()) - roofs_before };
+        }
+
+        rollback_transaction();
+
+        return evaluation;
+    }
+    catch (...)
+    {
+        rollback_transaction();
+        throw;
+    }
+}
+
+auto BuildingManager::debug_snapshot() const -> BuildingManagerSnapshot
+{
+    auto snapshot = BuildingManagerSnapshot{};
+
+    auto fbb = flatbuffers::FlatBufferBuilder{ 1024 };
+    fbb.Finish(m_tiles.write(fbb));
+    snapshot.tiles.assign(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+
+    snapshot.city_count = m_cities.count();
+    for (auto const& [cid, city] : m_cities) { snapshot.city_ids.push_back(cid); }
+
+    snapshot.block_count = m_blocks.count();
+    for (auto const& [cbid, cblock] : m_blocks) { snapshot.block_ids.push_back(cbid); }
+
+    snapshot.building_count = m_buildings.count();
+    for (auto const& [bid, building] : m_buildings)
+    {
+        auto & aids = snapshot.building_ids.emplace_back(bid, std::vector<BuildingAreaId>{}).second;
+        for (auto const& [aid, area] : building.areas_by_ref()) { aids.push_back(aid); }
+    }
+
+    snapshot.roof_count = m_roofs.count();
+    for (auto const& [rid, roof] : m_roofs) { snapshot.roof_ids.push_back(rid); }
+
+    snapshot.door_count = m_door_manager.door_count();
+
+    for (auto z = 0; z < m_tiles.height(); ++z)
+    {
+        for (auto y = 0; y < m_tiles.width(); ++y)
+        {
+            for (auto x = 0; x < m_tiles.length(); ++x)
+            {
+                snapshot.outside_labels.push_back(m_outside.region({ x, y, z }));
+            }
+        }
+    }
+
+    snapshot.area_graph = m_area_graph;
+
+    return snapshot;
+}
+
 //TODO: 03:   E' meglio che Building sia una classe compatta che incapsuli le Aree al suo interno, oppure che sia un semplice raccoglitore?
 //			 Disincapsulando le Aree da Building si va incontro a una serie di problemi che collidono col design attuale: 
 //				- il principio cardine della programmazione a oggetti  l'incapuslamento. Se lo tolgo vado verso un design pi procedurale. Sar un male?
@@ -359,7 +720,7 @@ auto BuildingManager::debug_build_prefabBuilding(PrefabBuilding const& prefab) -
     auto const cid = get_nearestCity(tgm::Utilities::v3i_to_v2f(bldg_center));
     auto & city = m_cities.get_or_throw(cid);
 
-    auto & [cbid, cblock] = m_blocks.create(); // Create a block to contain the building
+    auto & [cbid, cblock] = m_blocks.create(m_context.settings.map.max_cityBlockSurface); // Create a block to contain the building
     city.add_block(cbid);
 
     // Check that all the areas are buildable
@@ -412,7 +773,7 @@ auto BuildingManager::debug_build_prefabBuilding(PrefabBuilding const& prefab) -
         }
 
         #if DYNAMIC_ASSERTS
-            if (!is_building_connected(new_bid, new_bldg)) { throw std::runtime_error("The areas of the building aren't connected."); }
+            if (!m_area_graph.is_connected(new_bid)) { throw std::runtime_error("The areas of the building aren't connected."); }
         #endif
 
 
@@ -510,9 +871,11 @@ bool BuildingManager::is_buildingExpansion_possible(CityBlock const& cblock,
                                                     std::vector<AreaType> const& candidate_areas,
                                                     Vector3i & best_position,
                                                     AreaType & selected_area,
-                                                    std::vector<BuildingAreaCompleteId> & replaced_areas)
+                                                    std::vector<BuildingAreaCompleteId> & replaced_areas,
+                                                    RandomStream & rng) const
 {
     auto alreadyChecked_dims = std::unordered_set<Vector2i>{};
+    std::array<std::byte, expansion_scratchSize> scratch_buffer;
 
     for (auto const& carea : candidate_areas)
     {
@@ -535,6 +898,9 @@ bool BuildingManager::is_buildingExpansion_possible(CityBlock const& cblock,
 
         if(cblock.has_room_for(area_dims.x * area_dims.y))
         {
+            // Each candidate area starts again from the beginning of the buffer
+            auto scratch = std::pmr::monotonic_buffer_resource{ scratch_buffer.data(), scratch_buffer.size() };
+
             // The candidate area could replace some other areas. Detect those areas in this building.
             auto const replaceable_areas = building.find_replaceableAreas(bid, carea, building_expansionTemplates.at(building.expTempl_id()));
 
@@ -544,7 +910,7 @@ bool BuildingManager::is_buildingExpansion_possible(CityBlock const& cblock,
         
 
             //--- The candidate area could be built only in specific positions (for building integrity's sake). Collect all those positions.
-            auto suitable_positions = std::unordered_set<Vector3i>{};
+            auto suitable_positions = std::pmr::unordered_set<Vector3i>{ &scratch };
             compute_suitablePositions_aroundBuilding(bid, building, area_dims, true, false, replaceable_areas, suitable_positions);
     
             #if BUILDEXP_VISUALDEBUG
@@ -553,9 +919,9 @@ bool BuildingManager::is_buildingExpansion_possible(CityBlock const& cblock,
             #endif
 
 
-            auto const buildable_positions = compute_buildablePositions(building.cbid(), bid, &building, suitable_positions, area_dims, replaceable_areas);
+            auto const buildable_positions = compute_buildablePositions(building.cbid(), bid, &building, suitable_positions, area_dims, replaceable_areas, &scratch);
 
-            if (!buildable_positions.empty() && compute_bestPosition(area_dims, 0, buildable_positions, best_position, replaced_areas))
+            if (!buildable_positions.empty() && compute_bestPosition(area_dims, 0, buildable_positions, best_position, replaced_areas, rng, &scratch))
             {
                 selected_area = carea;
                 return true;
@@ -575,19 +941,23 @@ bool BuildingManager::is_blockExpansion_possible(CityBlockId const cbid,
                                                  BuildingRecipe const& recipe,
                                                  std::vector<BuildingAreaCompleteId> const& replaceable_areas,
                                                  Vector3i & best_position,
-                                                 std::vector<BuildingAreaCompleteId> & replaced_areas) const
+                                                 std::vector<BuildingAreaCompleteId> & replaced_areas,
+                                                 RandomStream & rng) const
 {
     #if BUILDEXP_VISUALDEBUG
         visualDebug_replaceableAreasStep(replaceable_areas);
     #endif
 
 
+    std::array<std::byte, expansion_scratchSize> scratch_buffer;
+    auto scratch = std::pmr::monotonic_buffer_resource{ scratch_buffer.data(), scratch_buffer.size() };
+
     // The new area could be built only at a certain distance from the other areas of the block. Collect all those positions.
-    auto const suitable_poss = compute_suitablePositions_inBlock(block, recipe.startingArea_dims(), replaceable_areas);
+    auto const suitable_poss = compute_suitablePositions_inBlock(block, recipe.startingArea_dims(), replaceable_areas, &scratch);
     
-    auto const buildable_poss = compute_buildablePositions(cbid, suitable_poss, recipe.startingArea_dims(), replaceable_areas);
+    auto const buildable_poss = compute_buildablePositions(cbid, suitable_poss, recipe.startingArea_dims(), replaceable_areas, &scratch);
 
-    if (!buildable_poss.empty() && compute_bestPosition(recipe.startingArea_dims(), 0, buildable_poss, best_position, replaced_areas))
+    if (!buildable_poss.empty() && compute_bestPosition(recipe.startingArea_dims(), 0, buildable_poss, best_position, replaced_areas, rng, &scratch))
     {
         return true;
     }
@@ -603,10 +973,11 @@ bool BuildingManager::is_blockExpansion_possible(CityBlockId const cbid,
 
 auto BuildingManager::compute_suitablePositions_inBlock(CityBlock const& block, 
                                                        Vector2i const area_dims,
-                                                       std::vector<BuildingAreaCompleteId> const& replaceable_areas) const 
-    -> std::unordered_set<Vector3i>
+                                                       std::vector<BuildingAreaCompleteId> const& replaceable_areas,
+                                                       std::pmr::memory_resource * const scratch) const 
+    -> std::pmr::unordered_set<Vector3i>
 {
-    auto suitable_positions = std::unordered_set<Vector3i>{};
+    auto suitable_positions = std::pmr::unordered_set<Vector3i>{ scratch };
 
     for (auto const bid : block.buildings())
     {
@@ -628,13 +999,15 @@ bool BuildingManager::is_cityExpansion_possible(City const& city,
                                                 BuildingRecipe const& recipe,
                                                 std::vector<BuildingAreaCompleteId> const& replaceable_areas,
                                                 Vector3i & best_position,
-                                                std::vector<BuildingAreaCompleteId> & replaced_areas) const
+                                                std::vector<BuildingAreaCompleteId> & replaced_areas,
+                                                RandomStream & rng) const
 {
     #if BUILDEXP_VISUALDEBUG
         visualDebug_replaceableAreasStep(replaceable_areas);
     #endif
 
     auto const ordered_blocks = order_cityBlocks(city);
+    std::array<std::byte, expansion_scratchSize> scratch_buffer;
 
     // Try to build the new building sarting from the closest block to center of the city
     for (auto const [distance, block] : ordered_blocks)
@@ -645,8 +1018,11 @@ bool BuildingManager::is_cityExpansion_possible(City const& city,
             visualDebug_highlightCityBlock(*block, Color::Blue);
         #endif
 
+        // Each block starts again from the beginning of the buffer
+        auto scratch = std::pmr::monotonic_buffer_resource{ scratch_buffer.data(), scratch_buffer.size() };
+
         // Gather all the suitable positions around each area of the block
-        auto suitable_positions = std::unordered_set<Vector3i>{};
+        auto suitable_positions = std::pmr::unordered_set<Vector3i>{ &scratch };
     
         for (auto const bid : block->buildings())
         {
@@ -662,9 +1038,9 @@ bool BuildingManager::is_cityExpansion_possible(City const& city,
         #endif
 
             
-        auto const buildable_poss = compute_buildablePositions(cbid, suitable_positions, recipe.startingArea_dims(), replaceable_areas);
+        auto const buildable_poss = compute_buildablePositions(cbid, suitable_positions, recipe.startingArea_dims(), replaceable_areas, &scratch);
 
-        if (!buildable_poss.empty() && compute_bestPosition(recipe.startingArea_dims(), sim_settings.map.road_dim + 1, buildable_poss, best_position, replaced_areas))
+        if (!buildable_poss.empty() && compute_bestPosition(recipe.startingArea_dims(), m_context.settings.map.road_dim + 1, buildable_poss, best_position, replaced_areas, rng, &scratch))
         {
             return true;
         }
@@ -708,12 +1084,12 @@ void BuildingManager::compute_suitablePositions_aroundBuilding(BuildingId const
                                                                bool const is_expansion,
                                                                bool const is_newBlock,
                                                                std::vector<BuildingAreaCompleteId> const& replaceable_areas,
-                                                               std::unordered_set<Vector3i> & suitable_positions)
+                                                               std::pmr::unordered_set<Vector3i> & suitable_positions) const
 {
     auto const hor_expFactor = is_expansion ? 2 : 0;
     auto const vert_expFactor = is_expansion ? 1 : 0;
 
-    auto const road_dist = is_newBlock ? sim_settings.map.road_dim + 1 : 0;
+    auto const road_dist = is_newBlock ? m_context.settings.map.road_dim + 1 : 0;
 
     for (auto const& [aid, area] : building.areas_by_ref())
     {
@@ -784,28 +1160,30 @@ void BuildingManager::compute_suitablePositions_aroundBuilding(BuildingId const
 }
 
 auto BuildingManager::compute_buildablePositions(CityBlockId const cbid,
-                                                 std::unordered_set<Vector3i> const& suitable_positions,
+                                                 std::pmr::unordered_set<Vector3i> const& suitable_positions,
                                                  Vector2i const area_dims,
-                                                 std::vector<BuildingAreaCompleteId> const& replaceable_areas) const -> std::vector<BuildablePosition>
+                                                 std::vector<BuildingAreaCompleteId> const& replaceable_areas,
+                                                 std::pmr::memory_resource * const scratch) const -> std::pmr::vector<BuildablePosition>
 {
-    return compute_buildablePositions(cbid, 0, nullptr, suitable_positions, area_dims, replaceable_areas);
+    return compute_buildablePositions(cbid, 0, nullptr, suitable_positions, area_dims, replaceable_areas, scratch);
 }
 
 auto BuildingManager::compute_buildablePositions(CityBlockId const cbid,
                                                  BuildingId const bid, Building const*const bld,
-                                                 std::unordered_set<Vector3i> const& suitable_positions,
+                                                 std::pmr::unordered_set<Vector3i> const& suitable_positions,
                                                  Vector2i const area_dims,
-                                                 std::vector<BuildingAreaCompleteId> const& replaceable_areas) const -> std::vector<BuildablePosition>
+                                                 std::vector<BuildingAreaCompleteId> const& replaceable_areas,
+                                                 std::pmr::memory_resource * const scratch) const -> std::pmr::vector<BuildablePosition>
 {
-    auto buildable_positions = std::vector<BuildablePosition>{};
+    auto buildable_positions = std::pmr::vector<BuildablePosition>{ scratch };
 
     // For each suitable tile check if it denotes the begin of a free area.
     for (auto const pos : suitable_positions)
     {
-        auto [is_buildable, areas_to_replace] = is_area_buildable(cbid, bid, bld, pos, area_dims, replaceable_areas);
+        auto [is_buildable, areas_to_replace] = is_area_buildable(cbid, bid, bld, pos, area_dims, replaceable_areas, scratch);
         if (is_buildable)
         {
-            buildable_positions.emplace_back(pos, areas_to_replace);
+            buildable_positions.emplace_back(pos, std::move(areas_to_replace));
         }
     }
 
@@ -819,13 +1197,14 @@ auto BuildingManager::compute_buildablePositions(CityBlockId const cbid,
 auto BuildingManager::is_area_buildable(CityBlockId const cbid,
                                         BuildingId const bid, Building const*const building,
                                         Vector3i const position, Vector2i const dims, 
-                                        std::vector<BuildingAreaCompleteId> const& replaceable_areas) const
-    -> std::pair<bool, std::unordered_set<BuildingAreaCompleteId>>
+                                        std::vector<BuildingAreaCompleteId> const& replaceable_areas,
+                                        std::pmr::memory_resource * const scratch) const
+    -> std::pair<bool, std::pmr::unordered_set<BuildingAreaCompleteId>>
 {
     if (dims.x < 3 || dims.y < 3) {	throw std::runtime_error("Area dimensions are too small."); }
 
 
-    auto ret = std::pair<bool, std::unordered_set<BuildingAreaCompleteId>>{}; //NRVO
+    auto ret = std::pair<bool, std::pmr::unordered_set<BuildingAreaCompleteId>>{ false, scratch }; //NRVO
     auto & [is_buildable, replaced_areas] = ret;
 
     #if BUILDEXP_VISUALDEBUG_IS_AREA_BUILDABLE
@@ -834,8 +1213,8 @@ auto BuildingManager::is_area_buildable(CityBlockId const cbid,
         auto constexpr notBuildable_depth = 4;
     #endif
     
-    auto const e_pos = position - Vector3i{sim_settings.map.road_dim + 1, sim_settings.map.road_dim + 1, 0}; //'+1' because the rest of the algorithm supposes that the tile beyond the street exists
-    auto const e_dims = dims + Vector2i{sim_settings.map.road_dim + 1, sim_settings.map.road_dim + 1} * 2;
+    auto const e_pos = position - Vector3i{m_context.settings.map.road_dim + 1, m_context.settings.map.road_dim + 1, 0}; //'+1' because the rest of the algorithm supposes that the tile beyond the street exists
+    auto const e_dims = dims + Vector2i{m_context.settings.map.road_dim + 1, m_context.settings.map.road_dim + 1} * 2;
 
     //--- Check if the enlarged area spans outside the map
     if (!m_tiles.contains(e_pos.x, e_pos.y, e_pos.z, e_dims.x, e_dims.y, 1))
@@ -920,9 +1299,14 @@ auto BuildingManager::is_area_buildable(CityBlockId const cbid,
 
 
     //--- Check that the enlarged area doesn't hit neighboring blocks
+
+    // A built tile belongs to the block of its areas, so the road belt can hit another block only if an area of that block intersects it.
+    auto const road_dim = m_context.settings.map.road_dim;
+    auto const belt_vol = IntParallelepiped{ position.x - road_dim, position.y - road_dim, position.z, dims.x + road_dim * 2, dims.y + road_dim * 2, 1 };
+    auto const mayHit_otherBlocks = m_area_index.any_intersecting(belt_vol, [cbid](BuildingAreaIndex::Entry const& e) { return e.cbid != cbid; });
     
     // Iterate through the width of the road belt.
-    for(auto i = 1; i <= sim_settings.map.road_dim; ++i)
+    for(auto i = 1; mayHit_otherBlocks && i <= road_dim; ++i)
     {
         auto const rb_pos = position - Vector3i{i, i, 0};
         auto const rb_dims = dims + Vector2i{i * 2, i * 2};
@@ -980,7 +1364,7 @@ auto BuildingManager::is_area_buildable(CityBlockId const cbid,
     auto const vol = IntParallelepiped{ position.x, position.y, position.z, dims.x, dims.y, 1 };
     if (building && !replaced_areas.empty())
     {
-        if (!is_building_connected(bid, *building, vol, replaced_areas))
+        if (!is_building_connected(bid, *building, vol, replaced_areas, scratch))
         {
             #if BUILDEXP_VISUALDEBUG_IS_AREA_BUILDABLE
                 BEdeb.new_step("Not buildable. The building wouldn't be connected anymore.", notBuildable_depth);
@@ -993,7 +1377,7 @@ auto BuildingManager::is_area_buildable(CityBlockId const cbid,
 
     //--- Gather all the external doors of the block that this area would occlude
 
-    auto removed_doors = std::unordered_set<Vector3i>{};
+    auto removed_doors = std::pmr::unordered_set<Vector3i>{ scratch };
 
     // Gather external doors in replaced areas
     for (auto const acid : replaced_areas)
@@ -1023,8 +1407,16 @@ auto BuildingManager::is_area_buildable(CityBlockId const cbid,
     // Gather external doors on the shared borders and around the borders of this area.
     gather_adjacent_externalDoors(position, dims, removed_doors);
     
-    // Gather external doors that are occluded by this area
-    gather_occluded_externalDoors(vol, replaced_areas, removed_doors);
+    // Gather external doors that are occluded by this area. Without replaced areas, the outside regions tell which tiles it would cut
+    // off, with no need to trace the outlines around it.
+    if (replaced_areas.empty())
+    {
+        gather_cutOff_externalDoors(vol, removed_doors, scratch);
+    }
+    else
+    {
+        gather_occluded_externalDoors(vol, replaced_areas, removed_doors);
+    }
 
     
     //--- Check if there's any external door that's essential
@@ -1036,7 +1428,7 @@ auto BuildingManager::is_area_buildable(CityBlockId const cbid,
 
     
     // Compute how many external doors must be removed for each building.
-    auto removedDoors_per_building = std::unordered_map<BuildingId, std::size_t>{};		// Number of doors that would be removed for each building
+    auto removedDoors_per_building = std::pmr::unordered_map<BuildingId, std::size_t>{ scratch };		// Number of doors that would be removed for each building
     for (auto const pos : removed_doors)
     {
         auto const& t = m_tiles.get_existent(pos);
@@ -1070,7 +1462,7 @@ auto BuildingManager::is_area_buildable(CityBlockId const cbid,
 
 bool BuildingManager::is_tile_buildableWithInnerArea_inBlock(int const x, int const y, int const z,
                                                              std::vector<BuildingAreaCompleteId> const& replaceable_areas,
-                                                             std::unordered_set<BuildingAreaCompleteId> & replaced_areas) const
+                                                             std::pmr::unordered_set<BuildingAreaCompleteId> & replaced_areas) const
 {
     auto const t = m_tiles.get(x, y, z);
     if (!t) { throw std::runtime_error("Trying to check if an unexistent tile is built."); }
@@ -1122,7 +1514,7 @@ bool BuildingManager::is_tile_buildableWithInnerArea_inBlock(int const x, int co
 
 bool BuildingManager::is_tile_buildableWithBorder_inBlock(int const x, int const y, int const z, 
                                                           std::vector<BuildingAreaCompleteId> const& replaceable_areas,
-                                                          std::unordered_set<BuildingAreaCompleteId> & replaced_areas) const
+                                                          std::pmr::unordered_set<BuildingAreaCompleteId> & replaced_areas) const
 {
     auto const t = m_tiles.get(x, y, z);
     if (!t) { throw std::runtime_error("Trying to check if an unexistent tile is built."); }
@@ -1227,115 +1619,36 @@ bool BuildingManager::is_tile_blockFree(CityBlockId const cbid, int const x, int
 
 bool BuildingManager::is_building_connected(BuildingId const bid, Building const& bld, 
                                             IntParallelepiped const& ghost_vol, 
-                                            std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
-{
-    if (bld.is_empty() || is_building_subsetOf(bid, bld, replaced_areas))
-    {
-        #if BUILDEXP_VISUALDEBUG_IS_AREA_BUILDABLE
-            BEdeb.new_step("The building is either empty or a subset of the replaced areas.", 5);
-        #endif
-            
-        return true;
-    }
-    else
-    {
-        #if BUILDEXP_VISUALDEBUG_IS_AREA_BUILDABLE
-            BEdeb.new_step("Replaced areas in building.", 5);
-            for (auto const acid : replaced_areas)
-            {
-                auto vol =  bld.areas_by_ref().get_or_throw(acid.aid).volume();
-                BEdeb.highlight_tilesRect(vol.get_base(), vol.down, Color::Blue);
-            }
-        #endif
-
-        auto const nodes_number = tgm::Utilities::uint32_to_int32(bld.areas_by_ref().count());
-
-        auto examined_nodes = std::set<BuildingAreaId>{};
-
-        // Take the first area that is not a replaceable area (its existence is guaranteed by the fact that the building is not a subeset of replaced_areas).
-        auto it = bld.areas_by_ref().cbegin();
-        while (   replaced_areas.find({ bid, it->id() }) != replaced_areas.cend()
-               && it != bld.areas_by_ref().cend()									)
-        {
-            ++it;
-        }
-        #if DYNAMIC_ASSERTS
-            if (it == bld.areas_by_ref().cend()) { throw std::runtime_error("Unexpected situation. The building doesn't contain an area that isn't replaced, although it's not a subset of replaced_areas."); }
-        #endif
-            
-        auto const& [current_aid, current_area] = *it;
-        examined_nodes.insert(current_aid);
-
-        explore_areaNeighbors(bid, bld, ghost_vol, replaced_areas, current_area.volume(), examined_nodes);
-
-        return examined_nodes.size() == nodes_number;
-    }
-}
-
-bool BuildingManager::is_building_subsetOf(BuildingId const bid, Building const& bld, std::unordered_set<BuildingAreaCompleteId> const& replaced_areas)
-{
-    auto is_subsetOf = true;
-
-    for (auto const& [aid, area] : bld.areas_by_ref())
-    {
-        if (replaced_areas.find({ bid, aid }) == replaced_areas.cend())
-        {
-            is_subsetOf = false;
-            break;
-        }
-    }
-
-    return is_subsetOf;
-}
-
-void BuildingManager::explore_areaNeighbors(BuildingId const bid, Building const& bld,
-                                            IntParallelepiped const& ghost_vol, 
-                                            std::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
-                                            IntParallelepiped const& current_vol, std::set<BuildingAreaId> & examined_nodes) const
+                                            std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
+                                            std::pmr::memory_resource * const scratch) const
 {
     #if BUILDEXP_VISUALDEBUG_IS_AREA_BUILDABLE
-        BEdeb.new_step("Examined areas and current area.", 5);
-        for (auto const aid : examined_nodes)
+        BEdeb.new_step("Replaced areas in building.", 5);
+        for (auto const acid : replaced_areas)
         {
-            auto vol = IntParallelepiped{};
-            if (aid == 0) {	vol = ghost_vol; }
-            else		  { vol = bld.areas_by_ref().get_or_throw(aid).volume(); }
-            BEdeb.highlight_tilesRect(vol.get_base(), vol.down, Color{ 0, 0, 255, 123 });
+            if (acid.bid != bid) { continue; }
+            auto vol =  bld.areas_by_ref().get_or_throw(acid.aid).volume();
+            BEdeb.highlight_tilesRect(vol.get_base(), vol.down, Color::Blue);
         }
-        BEdeb.highlight_tilesRect(current_vol.get_base(), current_vol.down, Color{ 255, 0, 0, 123 });
     #endif
 
-    for (auto const& [aid, area] : bld.areas_by_ref())
+    auto removed = std::pmr::unordered_set<BuildingAreaId>{ scratch };
+    for (auto const acid : replaced_areas)
     {
-        // Skip replaced areas
-        if (replaced_areas.find({ bid, aid }) != replaced_areas.cend())
-        {
-            continue;
-        }
-
-        if (examined_nodes.find(aid) == examined_nodes.cend())
-        {
-            if (are_areas_connected(current_vol, area.volume()))
-            {
-                examined_nodes.insert(aid);
-
-                explore_areaNeighbors(bid, bld, ghost_vol, replaced_areas, area.volume(), examined_nodes);
-            }
-        }
+        if (acid.bid == bid) { removed.insert(acid.aid); }
     }
-    
-    // Check also the ghost_vol
-    auto const ghost_aid = BuildingAreaId{ 0 };
 
-    if (examined_nodes.find(ghost_aid) == examined_nodes.cend())
+    // The new area is linked to the areas of the building that it touches and that aren't replaced
+    auto ghost_neighbours = std::pmr::vector<BuildingAreaId>{ scratch };
+    m_area_index.for_each_intersecting(ghost_vol, [&](BuildingAreaIndex::Entry const& e)
     {
-        if (are_areas_connected(current_vol, ghost_vol))
+        if (e.acid.bid == bid && removed.find(e.acid.aid) == removed.cend() && are_areas_connected(ghost_vol, e.volume))
         {
-            examined_nodes.insert(ghost_aid);
-
-            explore_areaNeighbors(bid, bld, ghost_vol, replaced_areas, ghost_vol, examined_nodes);
+            ghost_neighbours.push_back(e.acid.aid);
         }
-    }
+    });
+
+    return m_area_graph.is_connected_after(bid, removed, ghost_neighbours, scratch);
 }
 
 bool BuildingManager::are_areas_connected(IntParallelepiped const lhs, IntParallelepiped const rhs)
@@ -1380,8 +1693,14 @@ bool BuildingManager::are_areas_connected(IntParallelepiped const lhs, IntParall
 }
 
 void BuildingManager::gather_adjacent_externalDoors(Vector3i const position, Vector2i const dims,
-                                                    std::unordered_set<Vector3i> & removed_doors) const
+                                                    std::pmr::unordered_set<Vector3i> & removed_doors) const
 {
+    // The doors lie on the borders of the areas: without areas around, there's nothing to gather.
+    if (!m_area_index.any_intersecting({ position.x - 1, position.y - 1, position.z, dims.x + 2, dims.y + 2, 1 }, [](auto const&) { return true; }))
+    {
+        return;
+    }
+
     // Horizontal borders
     for (auto y = position.y; y < position.y + dims.y; ++y)
     {
@@ -1448,7 +1767,7 @@ void BuildingManager::gather_adjacent_externalDoors(Vector3i const position, Vec
 }
 
 void BuildingManager::gather_externalDoor(Vector3i const pos,
-                                          std::unordered_set<Vector3i>& removed_doors) const
+                                          std::pmr::unordered_set<Vector3i> & removed_doors) const
 {
     auto const& t  = m_tiles.get_existent(pos);
 
@@ -1464,7 +1783,7 @@ void BuildingManager::gather_externalDoor(Vector3i const pos,
 }
 
 void BuildingManager::gather_surroundingExternalDoor(Vector3i const pos, bool const vertical,
-                                                     std::unordered_set<Vector3i>& removed_doors) const
+                                                     std::pmr::unordered_set<Vector3i> & removed_doors) const
 {
     auto const& t  = m_tiles.get_existent(pos);
 
@@ -1484,8 +1803,8 @@ void BuildingManager::gather_surroundingExternalDoor(Vector3i const pos, bool co
 }
 
 void BuildingManager::gather_occluded_externalDoors(IntParallelepiped const& vol,
-                                                    std::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
-                                                    std::unordered_set<Vector3i> & removed_doors) const
+                                                    std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
+                                                    std::pmr::unordered_set<Vector3i> & removed_doors) const
 {
     auto const outlines = compute_areaOutlines(vol, replaced_areas);
 
@@ -1499,21 +1818,46 @@ void BuildingManager::gather_occluded_externalDoors(IntParallelepiped const& vol
     }
 }
 
-auto BuildingManager::compute_areaOutlines(IntParallelepiped const& vol, std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
-    -> std::vector<BlockOutline>
+void BuildingManager::gather_cutOff_externalDoors(IntParallelepiped const& vol, std::pmr::unordered_set<Vector3i> & removed_doors,
+                                                  std::pmr::memory_resource * const scratch) const
 {
-    auto outlines = std::vector<BlockOutline>{};
-
-    
-    //--- Find the new concave angles on the block outline
-    auto starting_pivots = std::vector<OutlinePivot>{};
+    auto cutOff_tiles = std::pmr::vector<Vector3i>{ scratch };
+    m_outside.compute_cutOffTiles(vol, cutOff_tiles, scratch);
 
-    // Top horizontal borders
-    for (auto y = vol.right(); y >= vol.left; --y)
+    for (auto const pos : cutOff_tiles)
     {
-        auto const pos = Vector3i{ vol.behind, y, vol.down };
+        for (auto const drc : { Versor3i::N, Versor3i::S, Versor3i::W, Versor3i::E })
+        {
+            auto const t = m_tiles.get(pos + drc);
 
-        #if BUILDEXP_VISUALDEBUG_IS_AREA_BUILDABLE
+            if (t && t->is_externalDoor()) 
+            { 
+                removed_doors.insert(pos + drc); 
+            }
+        }
+    }
+
+    #if BUILDEXP_VISUALDEBUG_IS_AREA_BUILDABLE
+        BEdeb.new_step("Tiles that this area would cut off from the outside.", 4);
+        BEdeb.highlight_tiles(cutOff_tiles.cbegin(), cutOff_tiles.cend(), Color::Mint);
+    #endif
+}
+
+auto BuildingManager::compute_areaOutlines(IntParallelepiped const& vol, std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
+    -> std::vector<BlockOutline>
+{
+    auto outlines = std::vector<BlockOutline>{};
+
+    
+    //--- Find the new concave angles on the block outline
+    auto starting_pivots = std::vector<OutlinePivot>{};
+
+    // Top horizontal borders
+    for (auto y = vol.right(); y >= vol.left; --y)
+    {
+        auto const pos = Vector3i{ vol.behind, y, vol.down };
+
+        #if BUILDEXP_VISUALDEBUG_IS_AREA_BUILDABLE
             BEdeb.new_step("Examining if the tile adjacent to this border could be an outline starting angle.", 5); 
             BEdeb.highlight_tile(pos, Color(125, 125, 125, 50));
         #endif
@@ -1679,7 +2023,7 @@ auto BuildingManager::compute_areaOutlines(IntParallelepiped const& vol, std::un
 }
 
 auto BuildingManager::is_outlineConcaveStartingAngle(Vector3i const pos, Vector3i const forward_drc,
-                                                     std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
+                                                     std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
     -> std::optional<Vector3i>
 {
     auto ret = std::optional<Vector3i>{};
@@ -1713,7 +2057,7 @@ auto BuildingManager::is_outlineConcaveStartingAngle(Vector3i const pos, Vector3
 }
 
 bool BuildingManager::is_outlineConvexStartingAngle(Vector3i const pos, Vector3i const forward_drc,
-                                                    std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
+                                                    std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
 {
     return !is_tile_builtWithUnreplacedArea(pos, replaced_areas)																// The tile itself
         && !is_tile_builtWithUnreplacedArea(pos + DirectionUtil::orthogonalLeft_planeUnitVector(forward_drc), replaced_areas)	// The next tile
@@ -1727,7 +2071,7 @@ auto BuildingManager::compute_outline(OutlinePivot const starting_pivot, Buildin
 
 auto BuildingManager::compute_outlines(std::vector<OutlinePivot> starting_pivots, 
                                        IntParallelepiped const& ghost_vol,
-                                       std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
+                                       std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
     -> std::vector<BlockOutline>
 {
     auto outlines = std::vector<BlockOutline>{};
@@ -1851,7 +2195,7 @@ auto BuildingManager::compute_outlines(std::vector<OutlinePivot> starting_pivots
 
 auto BuildingManager::advance_outlinePos(Vector3i const pos, Vector3i const drc,
                                          IntParallelepiped const& vol,
-                                         std::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
+                                         std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
                                          BlockOutline & outline) const 
     -> OutlinePivot
 {
@@ -1907,7 +2251,7 @@ auto BuildingManager::advance_outlinePos(Vector3i const pos, Vector3i const drc,
     return next;
 }
 
-bool BuildingManager::is_tile_builtWithUnreplacedArea(Tile const& t, std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
+bool BuildingManager::is_tile_builtWithUnreplacedArea(Tile const& t, std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
 {
     if (t.is_built())
     {
@@ -1930,7 +2274,7 @@ bool BuildingManager::is_tile_builtWithUnreplacedArea(Tile const& t, std::unorde
     }
 }
 
-bool BuildingManager::is_tile_builtWithUnreplacedArea(Vector3i const pos, std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
+bool BuildingManager::is_tile_builtWithUnreplacedArea(Vector3i const pos, std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
 {
     auto const& t = m_tiles.get_existent(pos);
 
@@ -1938,21 +2282,147 @@ bool BuildingManager::is_tile_builtWithUnreplacedArea(Vector3i const pos, std::u
 }
 
 
+auto BuildingManager::compute_adjacencySums(IntParallelepiped const& bounds, std::pmr::memory_resource * const scratch) const -> AdjacencySums
+{
+    auto sums = AdjacencySums{ bounds, std::pmr::vector<int>{ scratch }, std::pmr::vector<int>{ scratch } };
+    sums.rows.assign(static_cast<std::size_t>(bounds.height) * bounds.length * (bounds.width + 1), 0);
+    sums.columns.assign(static_cast<std::size_t>(bounds.height) * bounds.width * (bounds.length + 1), 0);
+
+    auto const no_areas = std::pmr::unordered_set<BuildingAreaCompleteId>{};
+
+    for (auto dz = 0; dz < bounds.height; ++dz)
+    {
+        for (auto dx = 0; dx < bounds.length; ++dx)
+        {
+            for (auto dy = 0; dy < bounds.width; ++dy)
+            {
+                auto const t = m_tiles.get(bounds.behind + dx, bounds.left + dy, bounds.down + dz);
+                auto const is_point = t && is_adjacencyPoint(*t, no_areas) ? 1 : 0;
+
+                auto const row = (static_cast<std::size_t>(dz) * bounds.length + dx) * (bounds.width + 1) + dy;
+                auto const column = (static_cast<std::size_t>(dz) * bounds.width + dy) * (bounds.length + 1) + dx;
+
+                sums.rows[row + 1] = sums.rows[row] + is_point;
+                sums.columns[column + 1] = sums.columns[column] + is_point;
+            }
+        }
+    }
+
+    return sums;
+}
+
+auto BuildingManager::count_ringAdjacencyPoints(int const x_top, int const x_bottom, int const y_left, int const y_right, int const z,
+                                                std::pmr::unordered_set<BuildingAreaCompleteId> const& areas_to_replace) const -> int
+{
+    auto count = 0;
+
+    auto const visit = [&](int const x, int const y)
+    {
+        auto const t = m_tiles.get(x, y, z);
+        if (t && is_adjacencyPoint(*t, areas_to_replace)) { ++count; }
+    };
+
+    for (auto y = y_left; y <= y_right; ++y)
+    {
+        visit(x_top, y);
+        visit(x_bottom, y);
+    }
+
+    for (auto x = x_top + 1; x <= x_bottom - 1; ++x)
+    {
+        visit(x, y_left);
+        visit(x, y_right);
+    }
+
+    return count;
+}
+
+auto BuildingManager::compute_replacedAreas_adjacencyCorrection(int const x_top, int const x_bottom, int const y_left, int const y_right, int const z,
+                                                                std::pmr::unordered_set<BuildingAreaCompleteId> const& areas_to_replace,
+                                                                std::pmr::memory_resource * const scratch) const -> int
+{
+    auto const no_areas = std::pmr::unordered_set<BuildingAreaCompleteId>{ scratch };
+    auto correction = 0;
+
+    auto examined_vols = std::pmr::vector<IntParallelepiped>{ scratch };
+    examined_vols.reserve(areas_to_replace.size());
+
+    auto const correct = [&](int const x, int const y)
+    {
+        auto const pos = Vector3i{ x, y, z };
+
+        // A border shared by two replaced areas has already been examined with the first one
+        if (std::any_of(examined_vols.cbegin(), examined_vols.cend(), [pos](auto const& v) { return v.contains(pos); })) { return; }
+
+        auto const& t = m_tiles.get_existent(pos);
+        if (is_adjacencyPoint(t, no_areas) && !is_adjacencyPoint(t, areas_to_replace)) { --correction; }
+    };
+
+    for (auto const acid : areas_to_replace)
+    {
+        auto const& vol = get_area(acid).volume();
+        if (z < vol.down || z > vol.up()) { continue; }
+
+        // Horizontal borders of the ring
+        for (auto const x : { x_top, x_bottom })
+        {
+            if (x < vol.behind || x > vol.front()) { continue; }
+
+            for (auto y = std::max(y_left, vol.left); y <= std::min(y_right, vol.right()); ++y) { correct(x, y); }
+        }
+
+        // Vertical borders of the ring (apart the corner tiles)
+        for (auto const y : { y_left, y_right })
+        {
+            if (y < vol.left || y > vol.right()) { continue; }
+
+            for (auto x = std::max(x_top + 1, vol.behind); x <= std::min(x_bottom - 1, vol.front()); ++x) { correct(x, y); }
+        }
+
+        examined_vols.push_back(vol);
+    }
+
+    return correction;
+}
+
 bool BuildingManager::compute_bestPosition(Vector2i const area_dims,
                                            int const road_dist,
-                                           std::vector<BuildablePosition> const& buildable_positions, 
+                                           std::pmr::vector<BuildablePosition> const& buildable_positions, 
                                            Vector3i & best_position,
-                                           std::vector<BuildingAreaCompleteId> & replaced_areas) const
+                                           std::vector<BuildingAreaCompleteId> & replaced_areas,
+                                           RandomStream & rng,
+                                           std::pmr::memory_resource * const scratch) const
 {
     #if DYNAMIC_ASSERTS
         if (buildable_positions.empty()) { throw std::runtime_error("Cannot compute the best position if there's no buildable position."); }
     #endif
 
     // Positions with the greatest number of adjacent points (they are all tied for the same number of shared borders)
-    std::vector<std::vector<BuildablePosition>::const_iterator> best_positions;
+    auto best_positions = std::pmr::vector<std::pmr::vector<BuildablePosition>::const_iterator>{ scratch };
     // Score of the best position (or the tied for first best positions)
     auto bestPoss_score = 0;
 
+    // Count the adjacency points of all the rings at once, so that each ring is scored with four range sums. The sums visit every tile of
+    // the bounding box of the rings, so they are used only if that's cheaper than visiting the rings one by one (e.g. not when a few 
+    // candidates are spread around a whole block).
+    auto bounds_min = buildable_positions.front().pos;
+    auto bounds_max = buildable_positions.front().pos;
+    for (auto const& bp : buildable_positions)
+    {
+        bounds_min = { std::min(bounds_min.x, bp.pos.x), std::min(bounds_min.y, bp.pos.y), std::min(bounds_min.z, bp.pos.z) };
+        bounds_max = { std::max(bounds_max.x, bp.pos.x), std::max(bounds_max.y, bp.pos.y), std::max(bounds_max.z, bp.pos.z) };
+    }
+
+    auto const sums_bounds = IntParallelepiped{ bounds_min.x - road_dist, bounds_min.y - road_dist, bounds_min.z,
+                                                bounds_max.x - bounds_min.x + area_dims.x + 2 * road_dist,
+                                                bounds_max.y - bounds_min.y + area_dims.y + 2 * road_dist,
+                                                bounds_max.z - bounds_min.z + 1 };
+
+    auto const box_tiles = static_cast<std::size_t>(sums_bounds.length) * sums_bounds.width * sums_bounds.height;
+    auto const ring_tiles = static_cast<std::size_t>(2 * (area_dims.x + area_dims.y + 4 * road_dist) - 4) * buildable_positions.size();
+
+    auto const sums = box_tiles <= ring_tiles ? std::optional<AdjacencySums>{ compute_adjacencySums(sums_bounds, scratch) } : std::nullopt;
+
 
     #if BUILDEXP_VISUALDEBUG_BUILDABLE_POSITIONS
         // Adjacency points associated to each best position.
@@ -1977,55 +2447,32 @@ bool BuildingManager::compute_bestPosition(Vector2i const area_dims,
         auto const y_right  = pos.y + area_dims.y - 1 + road_dist;
         auto const z = pos.z;
 
-        // Check horizontal borders
-        for (auto y = y_left; y <= y_right; ++y)
+        if (sums)
         {
-            auto const t_top = m_tiles.get(x_top, y, z); //no need to check if the tile is existent. It's beeen already checked in is_area_buildable()
-
-            if (is_adjacencyPoint(*t_top, areas_to_replace))
-            {
-                ++adjacent_poss;
-                #if BUILDEXP_VISUALDEBUG_BUILDABLE_POSITIONS
-                    sharedBorders_set.insert({ x_top, y, z });
-                #endif
-            }
-            
-            auto const t_bottom = m_tiles.get(x_bottom, y, z);
+            // Count the adjacency points of the ring with four range sums, then correct the few tiles on the borders of the replaced areas
+            adjacent_poss += sums->row_sum(x_top,	y_left, y_right, z) + sums->row_sum(x_bottom, y_left, y_right, z)
+                           + sums->column_sum(y_left,  x_top + 1, x_bottom - 1, z) + sums->column_sum(y_right, x_top + 1, x_bottom - 1, z);
 
-            if (is_adjacencyPoint(*t_bottom, areas_to_replace))
+            if (!areas_to_replace.empty())
             {
-                ++adjacent_poss;
-                #if BUILDEXP_VISUALDEBUG_BUILDABLE_POSITIONS
-                    sharedBorders_set.insert({ x_bottom, y, z });
-                #endif
+                adjacent_poss += compute_replacedAreas_adjacencyCorrection(x_top, x_bottom, y_left, y_right, z, areas_to_replace, scratch);
             }
         }
-
-        // Check vertical borders (apart the corner tiles, already checked above)
-        for (auto x = x_top + 1; x <= x_bottom - 1; ++x)
+        else
         {
-            auto const t_left = m_tiles.get(x, y_left, z); //no need to check if the tile is existent. It's already beeen checked in is_area_buildable()
+            adjacent_poss += count_ringAdjacencyPoints(x_top, x_bottom, y_left, y_right, z, areas_to_replace);
+        }
 
-            if (is_adjacencyPoint(*t_left, areas_to_replace))
+        #if BUILDEXP_VISUALDEBUG_BUILDABLE_POSITIONS
+            for (auto x = x_top; x <= x_bottom; ++x)
             {
-                ++adjacent_poss;
-                #if BUILDEXP_VISUALDEBUG_BUILDABLE_POSITIONS
-                    sharedBorders_set.insert({ x, y_left, z });
-                #endif
+                for (auto y = y_left; y <= y_right; ++y)
+                {
+                    auto const is_ring = x == x_top || x == x_bottom || y == y_left || y == y_right;
+                    if (is_ring && is_adjacencyPoint(m_tiles.get_existent(x, y, z), areas_to_replace)) { sharedBorders_set.insert({ x, y, z }); }
+                }
             }
-            
-            auto const t_right = m_tiles.get(x, y_right, z);
 
-            if (is_adjacencyPoint(*t_right, areas_to_replace))
-            {
-                ++adjacent_poss;
-                #if BUILDEXP_VISUALDEBUG_BUILDABLE_POSITIONS
-                    sharedBorders_set.insert({ x, y_right, z });
-                #endif
-            }
-        }
-        
-        #if BUILDEXP_VISUALDEBUG_BUILDABLE_POSITIONS
             {
                 std::ostringstream oss;
                 oss << "MinDim: " << area_dims << "\t\tShared borders: " << adjacent_poss;
@@ -2076,9 +2523,8 @@ bool BuildingManager::compute_bestPosition(Vector2i const area_dims,
             }
         #endif
 
-        // Randomize the positions to avoid that a building will always expand in the same way.
-        std::shuffle(best_positions.begin(), best_positions.end(), m_random_generator);
-        auto best_pos = best_positions[0];
+        // Pick one of the tied positions at random to avoid that a building will always expand in the same way.
+        auto best_pos = best_positions[rng.bounded(static_cast<std::uint32_t>(best_positions.size()))];
 
         #if BUILDEXP_VISUALDEBUG
             BEdeb.new_step("Randomly selected best position", 1);
@@ -2096,7 +2542,7 @@ bool BuildingManager::compute_bestPosition(Vector2i const area_dims,
 }
 
 
-bool BuildingManager::is_adjacencyPoint(Tile const& t, std::unordered_set<BuildingAreaCompleteId> const& areas_to_replace)
+bool BuildingManager::is_adjacencyPoint(Tile const& t, std::pmr::unordered_set<BuildingAreaCompleteId> const& areas_to_replace)
 {
     if (!t.is_border()) 
     { 
@@ -2171,7 +2617,6 @@ void BuildingManager::internal_expand_building(BuildingId const bid,
         PMdeb.begin_chapter("Expanding building");	// Necessary because unbuild_replacedArea() and build_buildingArea() change impassable tiles
     #endif
     
-    //TODO: 02: When replacing an area take into account its role as edge in linking the building nodes
     for (auto const acid : replaced_areas)
     {	
         unbuild_replacedArea(acid, building.cid(), building.cbid(), bid);
@@ -2196,7 +2641,6 @@ void BuildingManager::internal_expand_building(BuildingId const bid,
     #endif
 }
 
-//TODO: 02: When replacing an area take into account its role as edge in linking the building nodes
 void BuildingManager::unbuild_replacedArea(BuildingAreaCompleteId const ra_acid, CityId const newArea_cid, CityBlockId const newArea_cbid, BuildingId const newArea_bid)
 {
     auto & b = m_buildings.get_or_throw(ra_acid.bid);
@@ -2253,7 +2697,7 @@ void BuildingManager::build_buildingArea(CityBlockId const cbid, BuildingId cons
     //--- Remove external doors that would be occluded by this area
     auto const area_pos = area.volume().begin();
     auto const area_dims = area.volume().base_dims();
-    auto doors_to_remove = std::unordered_set<Vector3i>{};
+    auto doors_to_remove = std::pmr::unordered_set<Vector3i>{};
 
     gather_adjacent_externalDoors(area_pos, area_dims, doors_to_remove);
 
@@ -2306,9 +2750,24 @@ void BuildingManager::build_buildingArea(CityBlockId const cbid, BuildingId cons
         m_tiles.build_border(x, y_right, vol.down, cbid, bid, aid, BorderStyle::brickWall);
     }
 
+    // Link the area to the areas of the building it shares a wall with (before it's indexed, so that it doesn't find itself)
+    auto neighbours = std::vector<BuildingAreaId>{};
+    m_area_index.for_each_intersecting(vol, [&](BuildingAreaIndex::Entry const& e)
+    {
+        if (e.acid.bid == bid && are_areas_connected(vol, e.volume)) { neighbours.push_back(e.acid.aid); }
+    });
+    m_area_graph.add_area({ bid, aid }, neighbours);
+
+    m_area_index.insert({ bid, aid }, cbid, vol);
+    m_outside.build(vol);
+
+    // The area must be in the navigation graph before its doors are
+    nav_addArea({ bid, aid }, vol);
+    nav_updateOutdoor(vol);
+
 
     #if BUILDEXP_DEBUGLOG
-        BElog << Logger::nltb << "Built a BuildingArea of volume: " << vol;
+        ASYNC_LOG(building_expansion, "Built a BuildingArea of volume: {}", vol);
     #endif
 
       
@@ -2349,7 +2808,7 @@ void BuildingManager::build_buildingArea(CityBlockId const cbid, BuildingId cons
 
     //if (building.external_doors().size() < 2 && !external_doorablePoss.empty()) //TODO: 04: Ripristinare questa condizione
     //{
-        //std::shuffle(external_doorablePoss.begin(), external_doorablePoss.end(), m_random_generator);
+        //rng.shuffle(external_doorablePoss.begin(), external_doorablePoss.end());
 
         //auto it = external_doorablePoss.cbegin();
 
@@ -2389,14 +2848,14 @@ void BuildingManager::build_buildingArea(CityBlockId const cbid, BuildingId cons
     }
 
     
-    if(sim_settings.map.generate_roofs)
+    if(m_context.settings.map.generate_roofs)
     {
         // Cut and reshape possibly present roofs in order to make room for the new volume
         reshape_existentRoofs(bid, vol);
     }
     
     //--- Mention the tile changes to the TileGraphicsManager
-    m_tgraphics_mediator.record_areaChange(vol);
+    record_areaChange(vol);
 }
 
 void BuildingManager::check_borderDoorablePoss(Vector3i const beg, Vector3i const end, Vector3i const drc,
@@ -2612,7 +3071,8 @@ void BuildingManager::internal_build_internalDoor(Vector3i const pos, bool const
 
     //area.add_internalConnection(other_aid, doors.size() - 1);
 
-    m_tgraphics_mediator.record_borderChange(pos);
+    record_borderChange(pos);
+    nav_addDoor(did, pos);
 }
 
 void BuildingManager::internal_build_externalDoor(Vector3i const pos, bool const vertical, TileType const tile_style, Building & bldg)
@@ -2622,7 +3082,8 @@ void BuildingManager::internal_build_externalDoor(Vector3i const pos, bool const
 
     bldg.add_externalDoor(pos);
 
-    m_tgraphics_mediator.record_borderChange(pos);
+    record_borderChange(pos);
+    nav_addDoor(did, pos);
 }
 
 void BuildingManager::internal_build_blindDoor(Vector3i const pos, bool const vertical, TileType const tile_style, Building & bld)
@@ -2632,7 +3093,8 @@ void BuildingManager::internal_build_blindDoor(Vector3i const pos, bool const ve
 
     bld.add_blindDoor(pos);
     
-    m_tgraphics_mediator.record_borderChange(pos);
+    record_borderChange(pos);
+    nav_addDoor(did, pos);
 }
 
 
@@ -2698,7 +3160,7 @@ void BuildingManager::reshape_existentRoofs(BuildingId const bid, IntParallelepi
 
         
         // Notify the removal to RoofGraphicsManager
-        m_rgraphics_mediator.record_roofRemoval(rid);
+        record_roofRemoval(rid);
     }
 
 
@@ -2743,7 +3205,7 @@ void BuildingManager::try_buildRoof(int const x, int const y, int const z)
                 auto const& b = m_buildings.get_or_throw(info.bid());
                 auto const& a = b.getOrThrow_area(info.aid());
 
-                if (area_templates.at(a.type()).is_roofable())
+                if (area_templates.at(a.type()).is_roofable(m_context.settings.map.roof_every_area))
                 {
                     roofable_buildings.insert(info.bid());
                 }
@@ -2758,7 +3220,7 @@ void BuildingManager::try_buildRoof(int const x, int const y, int const z)
                     auto const& b = m_buildings.get_or_throw(info.bid());
                     auto const& a = b.getOrThrow_area(info.aid());
 
-                    if (area_templates.at(a.type()).is_roofable())
+                    if (area_templates.at(a.type()).is_roofable(m_context.settings.map.roof_every_area))
                     {
                         roofable_buildings.insert(info.bid());
                     }
@@ -2773,7 +3235,7 @@ void BuildingManager::try_buildRoof(int const x, int const y, int const z)
         
         for (auto const bid : roofable_buildings)
         {
-            auto const roofable_poss = RoofAlgorithm::compute_roofablePositions_fromTile(bid, { x, y, z }, m_buildings, m_tiles);
+            auto const roofable_poss = RoofAlgorithm::compute_roofablePositions_fromTile(bid, { x, y, z }, m_buildings, m_tiles, m_context.settings.map.roof_every_area);
 
             if(!roofable_poss.empty()) { create_roof(bid, roofable_poss); }
         }
@@ -2799,7 +3261,7 @@ void BuildingManager::create_roof(BuildingId const bid, std::unordered_set<Vecto
 
 
     // Notify the addition to the RoofGraphicsManager, in order to compute the 3D shape of the roof
-    m_rgraphics_mediator.record_roofAddition(rid);
+    record_roofAddition(rid);
 }
 
 void BuildingManager::unbuild_building(BuildingId const bid)
@@ -2857,6 +3319,259 @@ void BuildingManager::unbuild_building(BuildingId const bid)
     }
 }
 
+void BuildingManager::unbuild_buildings(std::vector<BuildingId> const& bids)
+{
+    // The buildings, the roofs and the doors are destroyed in sorted order: the order decides the free lists of their DataArrays, so
+    // the ids given later (and the random streams keyed on them) mustn't depend on the iteration order of a hash container.
+    auto doomed = std::vector<BuildingId>{};
+    auto volumes = std::vector<IntParallelepiped>{};
+
+    for (auto const bid : bids)
+    {
+        // It is allowed that @bids refers to expired/deleted buildings
+        if (std::as_const(m_buildings).weak_get(bid)) { doomed.push_back(bid); }
+    }
+
+    std::sort(doomed.begin(), doomed.end());
+    doomed.erase(std::unique(doomed.begin(), doomed.end()), doomed.end());
+
+    for (auto const bid : doomed)
+    {
+        for (auto const& [aid, area] : m_buildings.get_or_throw(bid).areas_by_ref())
+        {
+            volumes.push_back(area.volume());
+        }
+    }
+
+    auto const is_doomed = [&doomed](BuildingId const bid) { return std::binary_search(doomed.cbegin(), doomed.cend(), bid); };
+
+    if (doomed.empty()) { return; }
+
+    #if BUILDEXP_VISUALDEBUG
+        BEdeb.begin_chapter("Bulk building unbuilding");
+    #endif
+    #if PLAYERMOVEMENT_VISUALDEBUG
+        PMdeb.begin_chapter("Bulk building unbuilding."); // Starting a new chapter is necessary to remove impassable tiles from PlayerMovementVisualDebug.
+    #endif
+
+
+    // Even if an exception is thrown, the rectangles mustn't outlive this call.
+    struct ChangedRectsReset
+    {
+        std::vector<IntParallelepiped> & rects;
+        ~ChangedRectsReset() { rects.clear(); }
+    } const changedRects_reset{ m_bulk_changedRects };
+
+    // The changed tiles of each floor are covered by a few disjoint rectangles, so the changes inside them aren't recorded one by one. 
+    // Only the rectangles that overlap or touch are merged, so that far apart buildings don't make a whole floor be notified.
+    for (auto const& vol : volumes)
+    {
+        auto merged = vol;
+
+        for (auto rect = m_bulk_changedRects.begin(); rect != m_bulk_changedRects.end(); )
+        {
+            if (rect->down == merged.down && 
+                rect->behind <= merged.front_end() && merged.behind <= rect->front_end() && 
+                rect->left <= merged.right_end() && merged.left <= rect->right_end())
+            {
+                auto const behind = std::min(rect->behind, merged.behind);
+                auto const left   = std::min(rect->left,   merged.left);
+
+                merged = IntParallelepiped{ behind, left, merged.down,
+                                            std::max(rect->front_end(), merged.front_end()) - behind, std::max(rect->right_end(), merged.right_end()) - left, 1 };
+
+                // The grown rectangle may now touch the ones already checked.
+                m_bulk_changedRects.erase(rect);
+                rect = m_bulk_changedRects.begin();
+            }
+            else
+            {
+                ++rect;
+            }
+        }
+
+        m_bulk_changedRects.push_back(merged);
+    }
+
+
+    //--- Gather the external doors of the surviving buildings that could be no more blind, while the map is still intact
+    auto occluded_externalDoors = std::pmr::unordered_set<Vector3i>{};
+    for (auto const& vol : volumes)
+    {
+        gather_occluded_externalDoors(vol, {}, occluded_externalDoors);
+    }
+
+    //--- Unbuild the doors of the doomed areas
+    for (auto const& vol : volumes)
+    {
+        for (auto y = vol.left; y <= vol.right(); ++y)
+        {
+            try_unbuild_door(vol.behind,  y, vol.down);
+            try_unbuild_door(vol.front(), y, vol.down);
+        }
+
+        for (auto x = vol.behind + 1; x <= vol.front() - 1; ++x)
+        {
+            try_unbuild_door(x, vol.left,    vol.down);
+            try_unbuild_door(x, vol.right(), vol.down);
+        }
+    }
+
+    //--- Remove the roofs of the doomed buildings. They vanish altogether, so no roof has to be reshaped.
+    if (m_context.settings.map.generate_roofs)
+    {
+        auto roofs_to_remove = std::vector<std::pair<RoofId, BuildingId>>{};
+
+        for (auto const& vol : volumes)
+        {
+            for (auto y = vol.left; y <= vol.right(); ++y)
+            {
+                for (auto x = vol.behind; x <= vol.front(); ++x)
+                {
+                    for (auto const rinfo : m_tiles.get_existent(x, y, vol.down).roof_infos())
+                    {
+                        if (rinfo.bid != 0 && is_doomed(rinfo.bid)) { roofs_to_remove.emplace_back(rinfo.roof_id, rinfo.bid); }
+                    }
+                }
+            }
+        }
+
+        std::sort(roofs_to_remove.begin(), roofs_to_remove.end());
+        roofs_to_remove.erase(std::unique(roofs_to_remove.begin(), roofs_to_remove.end()), roofs_to_remove.end());
+
+        for (auto const [rid, bid] : roofs_to_remove)
+        {
+            for (auto const pos : m_roofs.get(rid).roofed_poss)
+            {
+                m_tiles.unbuild_roof(bid, pos);
+            }
+
+            m_roofs.destroy(rid);
+            record_roofRemoval(rid);
+        }
+    }
+
+    //--- Unbuild the areas and update the blocks and the cities
+    for (auto const bid : doomed)
+    {
+        auto & building = m_buildings.get_or_throw(bid);
+        auto & city = m_cities.get_or_throw(building.cid());
+        auto & cblock = m_blocks.get_or_throw(building.cbid());
+
+        for (auto const& [aid, area] : building.areas_by_ref())
+        {
+            auto const& vol = area.volume();
+            cblock.decrease_surface(vol);
+
+            for (auto y = vol.left; y <= vol.right(); ++y)
+            {
+                m_tiles.unbuild_border(vol.behind,  y, vol.down, bid, aid);
+                m_tiles.unbuild_border(vol.front(), y, vol.down, bid, aid);
+            }
+
+            for (auto x = vol.behind + 1; x <= vol.front() - 1; ++x)
+            {
+                m_tiles.unbuild_border(x, vol.left,    vol.down, bid, aid);
+                m_tiles.unbuild_border(x, vol.right(), vol.down, bid, aid);
+
+                for (auto y = vol.left + 1; y <= vol.right() - 1; ++y)
+                {
+                    m_tiles.unbuild_innerArea(x, y, vol.down, bid, aid);
+                }
+            }
+
+            m_area_index.remove({ bid, aid }, vol);
+            m_area_graph.remove_area({ bid, aid });
+            m_outside.unbuild(vol);
+            nav_removeArea({ bid, aid });
+        }
+
+        cblock.remove_building(bid);
+
+        if (cblock.empty())
+        {
+            m_blocks.destroy(building.cbid());
+            city.remove_block(building.cbid());
+
+            if (city.empty())
+            {
+                m_cities.destroy(building.cid());
+            }
+        }
+
+        m_buildings.destroy(bid);
+
+        #if BUILDEXP_VISUALDEBUG
+            BEdeb.remove_building(bid);
+        #endif
+    }
+
+    //--- Check once, against the final map, the doors that could be no more blind
+    auto sorted_occludedDoors = std::vector<Vector3i>(occluded_externalDoors.cbegin(), occluded_externalDoors.cend());
+    std::sort(sorted_occludedDoors.begin(), sorted_occludedDoors.end(), [](Vector3i const& a, Vector3i const& b) { 
+        return std::tie(a.z, a.y, a.x) < std::tie(b.z, b.y, b.x); 
+    });
+
+    for (auto const d : sorted_occludedDoors)
+    {
+        if (m_tiles.get_existent(d).is_externalDoor() && !is_externalBlindDoor(d)) 
+        { 
+            try_unbuild_door(d.x, d.y, d.z); 
+        }
+    }
+
+
+    //--- Mention the changes to the preparation managers
+    auto changed_rects = std::vector<IntParallelepiped>{};
+    changed_rects.swap(m_bulk_changedRects);
+
+    for (auto const& rect : changed_rects)
+    {
+        record_areaChange(rect);
+        nav_updateOutdoor(rect);
+    }
+
+
+    #if BUILDEXP_VISUALDEBUG
+        BEdeb.end_chapter();
+    #endif
+    #if PLAYERMOVEMENT_VISUALDEBUG
+        PMdeb.end_chapter();
+    #endif
+}
+
+void BuildingManager::unbuild_region(IntParallelepiped const& region)
+{
+    auto bids = std::vector<BuildingId>{};
+
+    for (auto z = region.down; z <= region.up(); ++z)
+    {
+        for (auto y = region.left; y <= region.right(); ++y)
+        {
+            for (auto x = region.behind; x <= region.front(); ++x)
+            {
+                auto const t = m_tiles.get(x, y, z);
+
+                if (!t || !t->is_built()) { continue; }
+
+                if (t->is_innerArea())
+                {
+                    bids.push_back(t->get_innerAreaInfo().bid());
+                }
+                else
+                {
+                    for (auto const info : t->get_borderInfos())
+                    {
+                        if (!info.is_empty()) { bids.push_back(info.bid()); }
+                    }
+                }
+            }
+        }
+    }
+
+    unbuild_buildings(bids);
+}
+
 void BuildingManager::unbuild_buildingArea(BuildingId const bid, Building const& building, BuildingAreaId const aid)
 {
     auto const vol = building.getOrThrow_area(aid).volume();
@@ -2886,7 +3601,7 @@ void BuildingManager::unbuild_buildingArea(BuildingId const bid, Building const&
         }
 
         // Find the blind doors in the courtyards around this area
-        auto occluded_externalDoors = std::unordered_set<Vector3i>{};
+        auto occluded_externalDoors = std::pmr::unordered_set<Vector3i>{};
         gather_occluded_externalDoors(vol, {}, occluded_externalDoors);
 
         #if BUILDEXP_VISUALDEBUG_DOORS
@@ -2932,15 +3647,20 @@ void BuildingManager::unbuild_buildingArea(BuildingId const bid, Building const&
     }
     
     //--- Generate the roof
-    if (sim_settings.map.generate_roofs)
+    if (m_context.settings.map.generate_roofs)
     {
         // Cut and reshape possibly present roofs
         reshape_existentRoofs(bid, vol);
     }
 
     //--- Mention the changes to the preparation managers
-    m_tgraphics_mediator.record_areaChange(vol);
+    record_areaChange(vol);
 
+    m_area_index.remove({ bid, aid }, vol);
+    m_area_graph.remove_area({ bid, aid });
+    m_outside.unbuild(vol);
+    nav_removeArea({ bid, aid });
+    nav_updateOutdoor(vol);
 }
 
 void BuildingManager::try_build_door(Vector3i const pos)
@@ -2960,7 +3680,7 @@ void BuildingManager::try_build_door(Vector3i const pos)
         switch (door_position.type)
         {
             case BorderDoorType::None:
-                g_log << "\nCan't build a door here." << std::endl;
+                m_context.log << "\nCan't build a door here." << std::endl;
                 break;
 
             case BorderDoorType::Internal:
@@ -2968,7 +3688,7 @@ void BuildingManager::try_build_door(Vector3i const pos)
                 break;
 
             case BorderDoorType::BuildingsLinker:
-                g_log << "\nCan't build a door connecting two different buildings." << std::endl;
+                m_context.log << "\nCan't build a door connecting two different buildings." << std::endl;
                 break;
 
             case BorderDoorType::External:
@@ -3023,13 +3743,94 @@ void BuildingManager::try_unbuild_door(int const x, int const y, int const z)
             }
         }
 
+        nav_removeDoor(t.furniture_id());
         m_door_manager.destroy_door(t.furniture_id());
         m_tiles.unbuild_door(x, y, z);
 
-        m_tgraphics_mediator.record_borderChange(x, y, z);
+        record_borderChange({ x, y, z });
+    }
+}
+
+void BuildingManager::record_areaChange(IntParallelepiped const& vol)
+{
+    if (is_bulkChange(vol)) { return; }
+
+    if (m_transaction) { m_pending_areaChanges.push_back(vol); }
+    else			   { m_tgraphics_mediator.record_areaChange(vol); }
+}
+
+void BuildingManager::record_borderChange(Vector3i const& pos)
+{
+    if (is_bulkChange(pos)) { return; }
+
+    if (m_transaction) { m_pending_borderChanges.push_back(pos); }
+    else			   { m_tgraphics_mediator.record_borderChange(pos); }
+}
+
+void BuildingManager::record_roofRemoval(RoofId const rid)
+{
+    if (m_transaction) { m_pending_roofChanges.emplace_back(rid, false); }
+    else			   { m_rgraphics_mediator.record_roofRemoval(rid); }
+}
+
+void BuildingManager::record_roofAddition(RoofId const rid)
+{
+    if (m_transaction) { m_pending_roofChanges.emplace_back(rid, true); }
+    else			   { m_rgraphics_mediator.record_roofAddition(rid); }
+}
+
+void BuildingManager::nav_addArea(BuildingAreaCompleteId const acid, IntParallelepiped const& vol)
+{
+    apply_navChange({ NavigationChangeType::add_area, acid, vol, 0u, {} });
+}
+
+void BuildingManager::nav_removeArea(BuildingAreaCompleteId const acid)
+{
+    apply_navChange({ NavigationChangeType::remove_area, acid, {}, 0u, {} });
+}
+
+void BuildingManager::nav_addDoor(DoorId const did, Vector3i const pos)
+{
+    apply_navChange({ NavigationChangeType::add_door, {}, {}, did, pos });
+}
+
+void BuildingManager::nav_removeDoor(DoorId const did)
+{
+    apply_navChange({ NavigationChangeType::remove_door, {}, {}, did, {} });
+}
+
+void BuildingManager::nav_updateOutdoor(IntParallelepiped const& vol)
+{
+    apply_navChange({ NavigationChangeType::update_outdoor, {}, vol, 0u, {} });
+}
+
+void BuildingManager::apply_navChange(NavigationChange const& change)
+{
+    if (m_transaction) { m_pending_navChanges.push_back(change); return; }
+
+    switch (change.type)
+    {
+        case NavigationChangeType::add_area:		m_navigation.add_area(change.acid, change.volume);	break;
+        case NavigationChangeType::remove_area:		m_navigation.remove_area(change.acid);				break;
+        case NavigationChangeType::add_door:		m_navigation.add_door(change.did, change.pos);		break;
+        case NavigationChangeType::remove_door:		m_navigation.remove_door(change.did);				break;
+        case NavigationChangeType::update_outdoor:	m_navigation.update_outdoor(change.volume);			break;
     }
 }
 
+bool BuildingManager::is_bulkChange(IntParallelepiped const& vol) const noexcept
+{
+    return std::any_of(m_bulk_changedRects.cbegin(), m_bulk_changedRects.cend(), [&vol](auto const& r) 
+                       { 
+                           return r.contains(vol.begin()) && r.contains({ vol.front(), vol.right(), vol.up() }); 
+                       });
+}
+
+bool BuildingManager::is_bulkChange(Vector3i const& pos) const noexcept
+{
+    return std::any_of(m_bulk_changedRects.cbegin(), m_bulk_changedRects.cend(), [&pos](auto const& r) { return r.contains(pos); });
+}
+
 
 
 #pragma warning(disable: 4100)
@@ -3100,7 +3901,7 @@ void BuildingManager::visualDebug_replaceableAreasStep(std::vector<BuildingAreaC
 }
 
 #pragma warning(disable: 4100)
-void BuildingManager::visualDebug_buildablePositionsStep(Vector2i const area_dims, std::vector<BuildablePosition> const& buildable_positions) const
+void BuildingManager::visualDebug_buildablePositionsStep(Vector2i const area_dims, std::pmr::vector<BuildablePosition> const& buildable_positions) const
 {
     #if BUILDEXP_VISUALDEBUG
         auto constexpr step_depth = 3;
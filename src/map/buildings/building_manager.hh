@@ -2,20 +2,29 @@
 #define GM_BUILDING_MANAGER_HH
 
 
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
 #include "std_extensions/hash_functions.hh"
 #include "data_strctures/data_array.hh"
 #include "mediators/tile_graphics_mediator.hh"
 #include "mediators/roof_graphics_mediator.hh"
 #include "map/map_forward_decl.hh"
 #include "map/buildings/building.hh"
+#include "map/buildings/building_area_graph.hh"
+#include "map/buildings/building_area_index.hh"
 #include "map/buildings/building_recipe.hh"
+#include "map/buildings/outside_regions.hh"
 #include "map/buildings/prefab_building.hh"
 #include "map/buildings/roof.hh"
 #include "map/buildings/block_outline.hh"
 #include "map/tiles/tile_set.hh"
 #include "map/door_manager.hh"
+#include "map/map_graph.h"
 #include "map/city.hh"
 #include "map/city_block.hh"
+#include "map/simulation_context.hh"
 
 
 namespace tgm
@@ -32,26 +41,127 @@ struct DoorablePosition
 };
 
 
+////
+//	Effects that an expansion would have on the map, measured by trying it in a transaction.
+////
+struct ExpansionEvaluation
+{
+    AreaType selected_area = AreaType::none;
+    Vector3i position{};
+    int replaced_areas = 0;
+    int door_delta = 0;		// Doors added to the map (minus the removed ones)
+    int roof_delta = 0;		// Roofs added to the map (minus the removed ones), a measure of how much the roofing gets fragmented
+};
+
+////
+//	Copy of the state that the transactions of the BuildingManager journal, taken by the tests to check that a rollback restores it.
+////
+struct BuildingManagerSnapshot
+{
+    std::vector<std::uint8_t> tiles;								// The TileSet serialized with its flatbuffers schema
+    std::size_t city_count = 0u;
+    std::vector<CityId> city_ids;
+    std::size_t block_count = 0u;
+    std::vector<CityBlockId> block_ids;
+    std::size_t building_count = 0u;
+    std::vector<std::pair<BuildingId, std::vector<BuildingAreaId>>> building_ids;		// With the ids of their areas
+    std::size_t roof_count = 0u;
+    std::vector<RoofId> roof_ids;
+    std::size_t door_count = 0u;
+    std::vector<OutsideRegions::RegionId> outside_labels;			// One for each tile, in the order of the TileSet
+    BuildingAreaGraph area_graph;
+};
+
+
 
 class BuildingManager
 {
     public:
-        BuildingManager(std::mt19937 & random_generator, TileSet & tiles, DataArray<Building> & buildings, DoorManager & door_manager, 
-                        TileGraphicsMediator & tg_mediator, RoofGraphicsMediator & rg_mediator);
+        BuildingManager(SimulationContext & context, std::uint64_t const seed, TileSet & tiles, DataArray<Building> & buildings, 
+                        DoorManager & door_manager, TileGraphicsMediator & tg_mediator, RoofGraphicsMediator & rg_mediator);
         ~BuildingManager();
 
 
         auto const& roofs() const { return m_roofs; }
 
+        ////
+        //	Navigation graph of the areas and the doors of the buildings. It's updated at each change of the buildings (at the commit, during
+        //	a transaction).
+        ////
+        auto navigation() -> MapGraph & { return m_navigation; }
+        auto navigation() const -> MapGraph const& { return m_navigation; }
+
+        ////
+        //	Volumes of all the BuildingAreas of the map, for the spatial queries.
+        ////
+        auto area_index() const noexcept -> BuildingAreaIndex const& { return m_area_index; }
+
+        ////
+        //	Adjacency graph of the areas of each building, for the connectivity queries.
+        ////
+        auto area_graph() const noexcept -> BuildingAreaGraph const& { return m_area_graph; }
+
+        ////
+        //	Connected components of the unbuilt tiles, telling the outside from the courtyards.
+        ////
+        auto outside_regions() const noexcept -> OutsideRegions const& { return m_outside; }
+
+        ////
+        //	Rebuild the navigation graph (areas, doors and outdoor clusters) from the tiles, e.g. after the TileSet was read.
+        ////
+        void reset_navigation() { m_navigation.reset(); m_pending_navChanges.clear(); }
+
+        ////
+        //	Label again the outside regions from the tiles, e.g. after the TileSet was read.
+        ////
+        void reset_outsideRegions() { m_outside.reset(); }
+
 
         void unbuild_building(BuildingId const id);
 
+        ////
+        //	Unbuild many buildings at once. Differently from calling unbuild_building() for each of them, the roofs are removed without being
+        //	reshaped after each area, the doors of the surviving buildings are checked once against the final map, and the graphics mediator 
+        //	receives a single rectangle for each floor. Expired and repeated ids are ignored.
+        ////
+        void unbuild_buildings(std::vector<BuildingId> const& bids);
+
+        ////
+        //	Unbuild every building with at least a tile in @region (also the parts lying outside of it). See unbuild_buildings().
+        ////
+        void unbuild_region(IntParallelepiped const& region);
+
         void request_buildingExpansion(BuildingId const id);
+
+        ////
+        //	Expand the first queued buildings. If MapSettings::buildingExpansion_threads isn't 1, the positions of the new areas are searched 
+        //	concurrently (see expand_buildings_inParallel()).
+        ////
         void expand_buildings();
         bool expand_building(BuildingId const id, int const queue_id);
 
         auto buildBuilding_inNearestCity(BuildingRecipe const& recipe) -> std::optional<BuildingId>;
 
+
+        ////
+        //	Between begin_transaction() and commit_transaction() or rollback_transaction(), the changes to the tiles, cities, blocks, buildings,
+        //	roofs and doors are recorded in undo logs, so they can be reverted in a time proportional to what was touched. The notifications to 
+        //	the graphics mediators (and the sprites of the doors) are held back until the commit, so the graphics never see a rolled back change.
+        //	The expansion queue, the SimulationStats and the VisualDebug records aren't part of the transaction. A reference to a building, block
+        //	or city obtained before begin_transaction() mustn't be used to change it during the transaction.
+        ////
+        void begin_transaction();
+        void commit_transaction();
+        void rollback_transaction();
+        bool in_transaction() const noexcept { return m_transaction; }
+
+        ////
+        //	Try the next expansion of a building and roll it back. Since the expansion step of the building is rolled back too, a later 
+        //	expand_building() builds exactly the evaluated area.
+        //	@return: The effects of the expansion, or nothing if the building doesn't exist or can't be expanded.
+        ////
+        auto evaluate_buildingExpansion(BuildingId const bid) -> std::optional<ExpansionEvaluation>;
+
         
 
         auto debug_getBlock(CityBlockId const cbid) const noexcept -> CityBlock const*const { return cbid == 0 ? nullptr : m_blocks.weak_get(cbid); }
@@ -62,29 +172,62 @@ class BuildingManager
         ////
         auto debug_build_prefabBuilding(PrefabBuilding const& building) -> std::pair<BuildingId, Building const*>;
         auto debug_get_buildings() -> DataArray<Building> const& { return m_buildings; }
+        auto debug_get_blocks() const -> DataArray<CityBlock, true> const& { return m_blocks; }
+        auto debug_getBuilding(BuildingId const bid) const -> Building const& { return m_buildings.get_or_throw(bid); }
         
         void debug_createDestroy_door(Vector3i const tile_pos);
 
         void debug_is_area_buildable(CityBlockId const cbid, BuildingId const bid, Building const& building,
                                      Vector3i const position, Vector2i const dims,
-                                     std::vector<BuildingAreaCompleteId> const& replaceable_areas) { is_area_buildable(cbid, bid, &building, position, dims, replaceable_areas); }
+                                     std::vector<BuildingAreaCompleteId> const& replaceable_areas)
+        {
+            is_area_buildable(cbid, bid, &building, position, dims, replaceable_areas, std::pmr::get_default_resource());
+        }
 
         void debug_expand_random_building();
 
+        auto debug_snapshot() const -> BuildingManagerSnapshot;
+
     private:
-        std::mt19937 & m_random_generator;
+        SimulationContext & m_context;
+        std::uint64_t const m_seed;
         TileSet & m_tiles;
 
-        DataArray<City> m_cities{ sim_settings.map.max_cityCount };
-        DataArray<CityBlock, true> m_blocks{ sim_settings.map.max_blockCount };
+        DataArray<City> m_cities{ m_context.settings.map.max_cityCount };
+        DataArray<CityBlock, true> m_blocks{ m_context.settings.map.max_blockCount };
         
         DataArray<Building> & m_buildings;
         DoorManager & m_door_manager;
-        DataArray<Roof> m_roofs{ sim_settings.map.max_roofCount };
+        DataArray<Roof> m_roofs{ m_context.settings.map.max_roofCount };
 
         TileGraphicsMediator & m_tgraphics_mediator;
         RoofGraphicsMediator & m_rgraphics_mediator;
 
+        MapGraph m_navigation{ m_tiles, m_context.settings.map.navigation_clusterDim };
+        BuildingAreaIndex m_area_index{ m_tiles.length(), m_tiles.width(), m_tiles.height(), m_context.settings.map.areaIndex_cellDim };
+        BuildingAreaGraph m_area_graph;
+        OutsideRegions m_outside{ m_tiles };
+
+        enum class NavigationChangeType { add_area, remove_area, add_door, remove_door, update_outdoor };
+
+        struct NavigationChange
+        {
+            NavigationChangeType type;
+            BuildingAreaCompleteId acid;
+            IntParallelepiped volume;
+            DoorId did;
+            Vector3i pos;
+        };
+
+        bool m_transaction = false;
+        std::vector<IntParallelepiped> m_pending_areaChanges;
+        std::vector<Vector3i> m_pending_borderChanges;
+        std::vector<std::pair<RoofId, bool>> m_pending_roofChanges;		// (roof, true if added), in the order they happened
+        std::vector<BuildingId> m_transaction_unexpandables;			// Buildings cached as non-expandable during the transaction
+        std::vector<NavigationChange> m_pending_navChanges;				// Replayed on the navigation graph at the commit, in the same order
+
+        std::vector<IntParallelepiped> m_bulk_changedRects;				// Rectangles notified at the end of unbuild_buildings(), disjoint on each floor
+
         static int const max_buildingExpansions = 100;
         std::queue<BuildingId> buildingExpansion_queue;
         std::unordered_set<BuildingId> m_unexpandable_buildings;
@@ -95,14 +238,14 @@ class BuildingManager
         std::map<std::string, BuildingExpansionTemplateId> buildingExpansionTemplates_nameToId =
             {
                 // id = 0 reserved
-                {"farm", sim_settings.map.test_farm_expId},
-                {"always_replace", sim_settings.map.test_alwaysReplace_expId}
+                {"farm", m_context.settings.map.test_farm_expId},
+                {"always_replace", m_context.settings.map.test_alwaysReplace_expId}
             };
 
         std::map<BuildingExpansionTemplateId, std::unordered_map<AreaType, AreaExpansionTemplate>> building_expansionTemplates =
             {
                 {
-                    sim_settings.map.test_farm_expId, //ID
+                    m_context.settings.map.test_farm_expId, //ID
                     {
                         //TODO: Bug in cui c'era ancora posto per alcune aree piccole ma non veniva riempito. (c'erano 4 diversi Building che si espandevano).
                         //		Ho scoperto poi che non era un vero bug, in realt il problema  che cowshed ha come prerequisito AreaType::Field, ma verso la fine
@@ -126,7 +269,7 @@ class BuildingManager
                 },
 
                 {
-                    sim_settings.map.test_alwaysReplace_expId, //ID
+                    m_context.settings.map.test_alwaysReplace_expId, //ID
                     {
                         { AreaType::field,			AreaExpansionTemplate{ {AreaType::large_cowshed},				{}					} },	//unbuildable since there's no large_cowshed
                         { AreaType::super_field,	AreaExpansionTemplate{ {AreaType::field},						{AreaType::field}	} },
@@ -166,6 +309,65 @@ class BuildingManager
         
 
 
+        ////////
+
+        //	Building expansion, split in a read-only proposal and in its commit, so that many proposals can be computed concurrently.
+
+        ////////
+
+        struct ExpansionProposal
+        {
+            BuildingId bid;
+            int queue_id;
+            std::uint64_t step = 0u;	// Expansion step of the building, from which the RandomStream of the proposal is derived
+            bool proposed = false;		// False if the proposal has to be computed serially (e.g. the building doesn't exist anymore)
+            bool possible = false;
+            AreaType selected_area = AreaType::none;
+            Vector3i best_position{};
+            std::vector<BuildingAreaCompleteId> replaced_areas;
+        };
+
+        auto expansion_threadCount() const -> unsigned;
+
+        ////
+        //	Compute the proposals of the first queued buildings on many threads, all of them against the map as it is before the batch, then
+        //	commit them one by one in queue order. A proposal is retried serially if an area committed earlier in the batch lies within a road
+        //	of distance from the volumes it touches, if its position isn't buildable anymore (or, for an impossible proposal, if an area freed
+        //	in the batch is within its reach). A retried proposal keeps the expansion step it reserved.
+        //	The results depend only on the seed and on the queue, not on the number of threads. Not available with BUILDEXP_VISUALDEBUG,
+        //	since the VisualDebug records a single sequence of steps.
+        ////
+        void expand_buildings_inParallel(unsigned const thread_count);
+
+        ////
+        //	@touched_volumes: If not null, the volumes of the built and of the replaced areas are appended to it.
+        //	@step: Expansion step already reserved for the building (see ExpansionProposal::step). If empty, the next one is drawn.
+        ////
+        bool expand_building(BuildingId const bid, int const queue_id, std::vector<IntParallelepiped> * const touched_volumes,
+                             std::optional<std::uint64_t> const step = std::nullopt);
+
+        ////
+        //	Find the area to add to @building and its position, without changing anything. It can be called concurrently.
+        ////
+        void propose_buildingExpansion(CityBlock const& cblock, Building const& building, ExpansionProposal & proposal) const;
+
+        ////
+        //	Build the proposed area, or cache the building as non-expandable if the expansion isn't possible.
+        //	@return: True if the building was expanded.
+        ////
+        bool commit_buildingExpansion(ExpansionProposal const& proposal, CityBlock & cblock, Building & building,
+                                      std::vector<IntParallelepiped> * const touched_volumes);
+
+        ////
+        //	@return: True if @proposal is still valid after the commit of the areas in @touched_volumes. A possible proposal is also checked
+        //			 again with is_area_buildable(), since the rules about the external doors depend on parts of the map that can be far
+        //			 from the proposed area.
+        ////
+        bool is_proposal_stillValid(ExpansionProposal const& proposal, CityBlock const& cblock, Building const& building,
+                                    std::vector<IntParallelepiped> const& touched_volumes,
+                                    std::vector<IntParallelepiped> const& freed_volumes) const;
+
+
         ////////
 
         //	Algorithm that compute the right position for a new area, depending on the situation.
@@ -177,7 +379,8 @@ class BuildingManager
                                            std::vector<AreaType> const& candidate_areas,
                                            Vector3i & best_position,
                                            AreaType & selected_area,
-                                           std::vector<BuildingAreaCompleteId> & replaced_areas);
+                                           std::vector<BuildingAreaCompleteId> & replaced_areas,
+                                           RandomStream & rng) const;
         
 
         bool is_blockExpansion_possible(CityBlockId const cbid,
@@ -185,12 +388,14 @@ class BuildingManager
                                         BuildingRecipe const& recipe,
                                         std::vector<BuildingAreaCompleteId> const& replaceable_areas,
                                         Vector3i& best_position,
-                                        std::vector<BuildingAreaCompleteId>& replaced_areas) const;
+                                        std::vector<BuildingAreaCompleteId>& replaced_areas,
+                                        RandomStream & rng) const;
         
         auto compute_suitablePositions_inBlock(CityBlock const& block, 
                                                Vector2i const area_dims,
-                                               std::vector<BuildingAreaCompleteId> const& replaceable_areas) const
-            -> std::unordered_set<Vector3i>;
+                                               std::vector<BuildingAreaCompleteId> const& replaceable_areas,
+                                               std::pmr::memory_resource * const scratch) const
+            -> std::pmr::unordered_set<Vector3i>;
 
         
         bool is_cityExpansion_possible(City const& city,
@@ -198,7 +403,8 @@ class BuildingManager
                                        BuildingRecipe const& recipe,
                                        std::vector<BuildingAreaCompleteId> const& replaceable_areas,
                                        Vector3i & best_position,
-                                       std::vector<BuildingAreaCompleteId> & replaced_areas) const;
+                                       std::vector<BuildingAreaCompleteId> & replaced_areas,
+                                       RandomStream & rng) const;
         
         auto order_cityBlocks(City const& city) const -> std::map<float, CityBlock const*>;
         
@@ -212,55 +418,103 @@ class BuildingManager
         //	(3) If the new area is a new area of an existing building, then the suitable positions are those in which the new area would share at least three 
         //		borders with the other areas of the building (so that a door can be built).
         ////
-        static void compute_suitablePositions_aroundBuilding(BuildingId const bid, Building const& building,
-                                                             Vector2i const area_dims,
-                                                             bool const is_expansion,
-                                                             bool const is_newBlock,
-                                                             std::vector<BuildingAreaCompleteId> const& replaceable_areas,
-                                                             std::unordered_set<Vector3i> & suitable_positions);
+        void compute_suitablePositions_aroundBuilding(BuildingId const bid, Building const& building,
+                                                      Vector2i const area_dims,
+                                                      bool const is_expansion,
+                                                      bool const is_newBlock,
+                                                      std::vector<BuildingAreaCompleteId> const& replaceable_areas,
+                                                      std::pmr::unordered_set<Vector3i> & suitable_positions) const;
         
 
 
+        ////
+        //	Size of the stack buffer of the scratch arena of an expansion attempt. The containers of the attempt (suitable and buildable 
+        //	positions, replaced areas, removed doors, prefix sums, tiles cut off from the outside) are allocated in the arena and released all at once when it ends; the 
+        //	arena falls back to the heap only when the buffer is exhausted.
+        ////
+        static constexpr auto expansion_scratchSize = std::size_t{ 32 * 1024 };
+
         struct BuildablePosition
         {
-            BuildablePosition(Vector3i const a_pos, std::unordered_set<BuildingAreaCompleteId> a_replaced_areas) : 
-                pos(a_pos), replaced_areas(a_replaced_areas) {}
+            BuildablePosition(Vector3i const a_pos, std::pmr::unordered_set<BuildingAreaCompleteId> a_replaced_areas) : 
+                pos(a_pos), replaced_areas(std::move(a_replaced_areas)) {}
 
             Vector3i pos;
-            std::unordered_set<BuildingAreaCompleteId> replaced_areas;
+            std::pmr::unordered_set<BuildingAreaCompleteId> replaced_areas;
+        };
+
+        ////
+        //	Prefix sums of the adjacency points (see is_adjacencyPoint(), with no replaced area) along each row and each column of @bounds, 
+        //	so that the adjacency points of a segment are counted in constant time.
+        ////
+        struct AdjacencySums
+        {
+            IntParallelepiped bounds;
+            std::pmr::vector<int> rows;			// For each floor and row x, the adjacency points of the row before each y
+            std::pmr::vector<int> columns;		// For each floor and column y, the adjacency points of the column before each x
+
+            ////
+            //	@return: The adjacency points from (x, y_begin) to (x, y_end), both included.
+            ////
+            auto row_sum(int const x, int const y_begin, int const y_end, int const z) const -> int
+            {
+                if (y_begin > y_end) { return 0; }
+
+                auto const base = ((z - bounds.down) * bounds.length + (x - bounds.behind)) * (bounds.width + 1) - bounds.left;
+                return rows[static_cast<std::size_t>(base + y_end + 1)] - rows[static_cast<std::size_t>(base + y_begin)];
+            }
+
+            ////
+            //	@return: The adjacency points from (x_begin, y) to (x_end, y), both included.
+            ////
+            auto column_sum(int const y, int const x_begin, int const x_end, int const z) const -> int
+            {
+                if (x_begin > x_end) { return 0; }
+
+                auto const base = ((z - bounds.down) * bounds.width + (y - bounds.left)) * (bounds.length + 1) - bounds.behind;
+                return columns[static_cast<std::size_t>(base + x_end + 1)] - columns[static_cast<std::size_t>(base + x_begin)];
+            }
         };
         
         ////
         //	For each @suitable_positions check if an area of @area_dims could be built there (taking into account also the @replaceable_areas). 
         ////
         auto compute_buildablePositions(CityBlockId const cbid,
-                                        std::unordered_set<Vector3i> const& suitable_positions,
+                                        std::pmr::unordered_set<Vector3i> const& suitable_positions,
                                         Vector2i const area_dims,
-                                        std::vector<BuildingAreaCompleteId> const& replaceable_areas) const -> std::vector<BuildablePosition>;
+                                        std::vector<BuildingAreaCompleteId> const& replaceable_areas,
+                                        std::pmr::memory_resource * const scratch) const -> std::pmr::vector<BuildablePosition>;
 
         auto compute_buildablePositions(CityBlockId const cbid, 
                                         BuildingId const bid, Building const*const bld,
-                                        std::unordered_set<Vector3i> const& suitable_positions,
+                                        std::pmr::unordered_set<Vector3i> const& suitable_positions,
                                         Vector2i const area_dims,
-                                        std::vector<BuildingAreaCompleteId> const& replaceable_areas) const -> std::vector<BuildablePosition>;
+                                        std::vector<BuildingAreaCompleteId> const& replaceable_areas,
+                                        std::pmr::memory_resource * const scratch) const -> std::pmr::vector<BuildablePosition>;
         
         ////
         //	Check that a BuildingArea belonging to @cbid with dimension @dims is buildable in @position.
         //  @replaceable_areas: Areas that could be replaced by the new area.
         //
+        //	@scratch: Memory of the returned set and of the temporary containers.
+        //
         //	@return: A bool indicating if the area is available and a vector indicating which areas must be replaced. 
         //			 Note: when the area isn't free the vector must be discarded
         ////
         auto is_area_buildable(CityBlockId const cbid,
                                Vector3i const position, Vector2i const dims, 
                                std::vector<BuildingAreaCompleteId> const& replaceable_areas) const
-            -> std::pair<bool, std::unordered_set<BuildingAreaCompleteId>> { return is_area_buildable(cbid, 0, nullptr, position, dims, replaceable_areas); }
+            -> std::pair<bool, std::pmr::unordered_set<BuildingAreaCompleteId>>
+        {
+            return is_area_buildable(cbid, 0, nullptr, position, dims, replaceable_areas, std::pmr::get_default_resource());
+        }
 
         auto is_area_buildable(CityBlockId const cbid,
                                BuildingId const bid, Building const*const building,
                                Vector3i const position, Vector2i const dims, 
-                               std::vector<BuildingAreaCompleteId> const& replaceable_areas) const
-            -> std::pair<bool, std::unordered_set<BuildingAreaCompleteId>>;
+                               std::vector<BuildingAreaCompleteId> const& replaceable_areas,
+                               std::pmr::memory_resource * const scratch) const
+            -> std::pair<bool, std::pmr::unordered_set<BuildingAreaCompleteId>>;
 
         
         ////
@@ -268,7 +522,7 @@ class BuildingManager
         ////
         bool is_tile_buildableWithInnerArea_inBlock(int const x, int const y, int const z,
                                                     std::vector<BuildingAreaCompleteId> const& replaceable_areas,
-                                                    std::unordered_set<BuildingAreaCompleteId> & replaced_areas) const;
+                                                    std::pmr::unordered_set<BuildingAreaCompleteId> & replaced_areas) const;
         
         ////
         //	Check if a border can be built on a tile. Take into account the @replaceable_areas and if the border can be only built with
@@ -276,54 +530,55 @@ class BuildingManager
         ////
         bool is_tile_buildableWithBorder_inBlock(int const x, int const y, int const z, 
                                                  std::vector<BuildingAreaCompleteId> const& replaceable_areas,
-                                                 std::unordered_set<BuildingAreaCompleteId> & replaced_areas) const;
+                                                 std::pmr::unordered_set<BuildingAreaCompleteId> & replaced_areas) const;
 
         bool is_tile_blockFree(CityBlockId const cbid, int const x, int const y, int const z) const;
         
         ////
-        //	Check if the areas of the building are all connected (as in a graph). 
-        //	Two areas are connected if their intersection is at least 3x1 (or 1x3) tile rectangle. 
+        //	Check if the areas of the building would be all connected (as in a graph) after replacing @replaced_areas with a new area of
+        //	volume @ghost_vol. Two areas are connected if their intersection is at least 3x1 (or 1x3) tile rectangle. The temporary sets
+        //	are allocated in @scratch.
         ////
         bool is_building_connected(BuildingId const bid, Building const& bld, 
-                                   IntParallelepiped const& ghost_vol = {},
-                                   std::unordered_set<BuildingAreaCompleteId> const& replaced_areas = {}) const;
-
-        static bool is_building_subsetOf(BuildingId const bid, Building const& bld, std::unordered_set<BuildingAreaCompleteId> const& replaced_areas);
-
-        void explore_areaNeighbors(BuildingId const bid, Building const& bld,
                                    IntParallelepiped const& ghost_vol,
-                                   std::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
-                                   IntParallelepiped const& current_vol, std::set<BuildingAreaId>& examined_nodes) const;
+                                   std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
+                                   std::pmr::memory_resource * const scratch) const;
 
         static bool are_areas_connected(IntParallelepiped const lhs, IntParallelepiped const rhs);
 
 
         void gather_adjacent_externalDoors(Vector3i const position, Vector2i const dims, 
-                                           std::unordered_set<Vector3i> & removed_doors) const;
+                                           std::pmr::unordered_set<Vector3i> & removed_doors) const;
 
         void gather_externalDoor(Vector3i const pos,
-                                 std::unordered_set<Vector3i> & removed_doors) const;
+                                 std::pmr::unordered_set<Vector3i> & removed_doors) const;
         
         void gather_surroundingExternalDoor(Vector3i const pos, bool const vertical,
-                                            std::unordered_set<Vector3i>& removed_doors) const;
+                                            std::pmr::unordered_set<Vector3i> & removed_doors) const;
 
         void gather_occluded_externalDoors(IntParallelepiped const& vol,
-                                           std::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
-                                           std::unordered_set<Vector3i> & removed_doors) const;
+                                           std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
+                                           std::pmr::unordered_set<Vector3i> & removed_doors) const;
+
+        ////
+        //	Gather the external doors facing the outside tiles that building @vol would cut off from the edge of the map.
+        ////
+        void gather_cutOff_externalDoors(IntParallelepiped const& vol, std::pmr::unordered_set<Vector3i> & removed_doors,
+                                         std::pmr::memory_resource * const scratch) const;
 
         ////
         //	@vol: Volume of the area whose outlines must be computed. The outlines are traced pretending that the area is built, 
         //		  also if the area hasn't been built yet.
         ////
-        auto compute_areaOutlines(IntParallelepiped const& vol, std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const 
+        auto compute_areaOutlines(IntParallelepiped const& vol, std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const 
             -> std::vector<BlockOutline>;
 
         auto is_outlineConcaveStartingAngle(Vector3i const pos, Vector3i const extern_drc,
-                                            std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
+                                            std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
             -> std::optional<Vector3i>;
 
         bool is_outlineConvexStartingAngle(Vector3i const pos, Vector3i const forward_drc,
-                                           std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const;
+                                           std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const;
         
         auto compute_outline(OutlinePivot const starting_pivot, BuildingAreaCompleteId const ignored_area) const -> BlockOutline;
 
@@ -332,18 +587,37 @@ class BuildingManager
         ////
         auto compute_outlines(std::vector<OutlinePivot> starting_pivots, 
                               IntParallelepiped const& ghost_area,
-                              std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
+                              std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const
             -> std::vector<BlockOutline>;
 
         auto advance_outlinePos(Vector3i const pos, Vector3i const drc, 
                                 IntParallelepiped const& vol,
-                                std::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
+                                std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas,
                                 BlockOutline & outline) const 
             -> OutlinePivot;
         
-        bool is_tile_builtWithUnreplacedArea(Tile const& t, std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const;
+        bool is_tile_builtWithUnreplacedArea(Tile const& t, std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const;
+
+        bool is_tile_builtWithUnreplacedArea(Vector3i const pos, std::pmr::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const;
+
+        ////
+        //	@return: The prefix sums of the adjacency points of the tiles inside @bounds (see AdjacencySums).
+        ////
+        auto compute_adjacencySums(IntParallelepiped const& bounds, std::pmr::memory_resource * const scratch) const -> AdjacencySums;
+
+        ////
+        //	@return: The adjacency points of the ring from (@x_top, @y_left) to (@x_bottom, @y_right), visiting its tiles one by one.
+        ////
+        auto count_ringAdjacencyPoints(int const x_top, int const x_bottom, int const y_left, int const y_right, int const z,
+                                       std::pmr::unordered_set<BuildingAreaCompleteId> const& areas_to_replace) const -> int;
 
-        bool is_tile_builtWithUnreplacedArea(Vector3i const pos, std::unordered_set<BuildingAreaCompleteId> const& replaced_areas) const;
+        ////
+        //	@return: How many adjacency points of the ring from (@x_top, @y_left) to (@x_bottom, @y_right) stop being such when 
+        //			 @areas_to_replace are removed (as a negative number). Only the tiles of the ring lying in those areas are examined.
+        ////
+        auto compute_replacedAreas_adjacencyCorrection(int const x_top, int const x_bottom, int const y_left, int const y_right, int const z,
+                                                       std::pmr::unordered_set<BuildingAreaCompleteId> const& areas_to_replace,
+                                                       std::pmr::memory_resource * const scratch) const -> int;
 
         ////
         //	Choose the best among the @buildable_positions. There are three cases: 
@@ -353,12 +627,15 @@ class BuildingManager
         //		higher number of borders with the areas of same blocks.
         //	(3) If the new area is a new area of an existing building, then the best position is that in which the the area would share the
         //		higher number of borders with the areas of same building.
+        //	Ties are broken with @rng.
         ////
         bool compute_bestPosition(Vector2i const area_dims,
                                   int const road_dist,
-                                  std::vector<BuildablePosition> const& buildable_positions, 
+                                  std::pmr::vector<BuildablePosition> const& buildable_positions, 
                                   Vector3i & best_position,
-                                  std::vector<BuildingAreaCompleteId> & replaced_areas) const;
+                                  std::vector<BuildingAreaCompleteId> & replaced_areas,
+                                  RandomStream & rng,
+                                  std::pmr::memory_resource * const scratch) const;
 
         //TODO: 04: Fare in modo che un edificio abbia al massimo 2-3 porte sull'esterno e non meno di 1.
 
@@ -366,7 +643,7 @@ class BuildingManager
         //  Check that not all the areas that share/are ajacent to the border have to be replaced. If that is the case, then the border
         //  can't be counted as a shared border, since those areas will be removed and their borders too.
         ////
-        static bool is_adjacencyPoint(Tile const& t, std::unordered_set<BuildingAreaCompleteId> const& areas_to_replace);
+        static bool is_adjacencyPoint(Tile const& t, std::pmr::unordered_set<BuildingAreaCompleteId> const& areas_to_replace);
 
 
         
@@ -466,10 +743,36 @@ class BuildingManager
 
         void visualDebug_replaceableAreasStep(std::vector<BuildingAreaCompleteId> const& replaceable_areas) const;
         
-        void visualDebug_buildablePositionsStep(Vector2i const area_dims, std::vector<BuildablePosition> const& buildable_positions) const;
+        void visualDebug_buildablePositionsStep(Vector2i const area_dims, std::pmr::vector<BuildablePosition> const& buildable_positions) const;
 
         void visualDebug_doorablePositionsStep(std::string const& title, std::vector<DoorablePosition> const& doorable_poss) const;
 
+
+
+        ////////
+
+        //	Notifications for the graphics mediators and changes of the navigation graph, held back during a transaction.
+
+        ////////
+
+        void record_areaChange(IntParallelepiped const& vol);
+        void record_borderChange(Vector3i const& pos);
+        void record_roofRemoval(RoofId const rid);
+        void record_roofAddition(RoofId const rid);
+
+        void nav_addArea(BuildingAreaCompleteId const acid, IntParallelepiped const& vol);
+        void nav_removeArea(BuildingAreaCompleteId const acid);
+        void nav_addDoor(DoorId const did, Vector3i const pos);
+        void nav_removeDoor(DoorId const did);
+        void nav_updateOutdoor(IntParallelepiped const& vol);
+        void apply_navChange(NavigationChange const& change);
+
+        ////
+        //	@return: True if the change is already covered by a rectangle that unbuild_buildings() will notify.
+        ////
+        bool is_bulkChange(IntParallelepiped const& vol) const noexcept;
+        bool is_bulkChange(Vector3i const& pos) const noexcept;
+
 };
 
 
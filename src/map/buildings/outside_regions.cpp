@@ -0,0 +1,527 @@
+#include "outside_regions.hh"
+
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+
+namespace tgm
+{
+
+
+
+OutsideRegions::OutsideRegions(TileSet const& tiles) :
+    m_tiles{ tiles },
+    m_length{ tiles.length() },
+    m_width{ tiles.width() },
+    m_height{ tiles.height() }
+{
+    reset();
+}
+
+
+void OutsideRegions::reset()
+{
+    #if DYNAMIC_ASSERTS
+        if (m_transaction) { throw std::runtime_error("The OutsideRegions cannot be reset during a transaction."); }
+    #endif
+
+    m_labels.assign(static_cast<std::size_t>(m_length) * m_width * m_height, 0u);
+    m_regions.assign(1u, Region{});
+    m_free_ids.clear();
+
+    auto frontier = std::vector<std::size_t>{};
+
+    for (auto i = std::size_t{ 0u }; i < m_labels.size(); ++i)
+    {
+        if (m_labels[i] != 0u || !is_unbuiltTile(i)) { continue; }
+
+        auto const rid = create_region();
+        auto & region = m_regions[rid];
+
+        m_labels[i] = rid;
+        frontier.push_back(i);
+
+        while (!frontier.empty())
+        {
+            auto const current = frontier.back();
+            frontier.pop_back();
+
+            ++region.tile_count;
+            if (is_edge(current)) { ++region.edge_count; }
+
+            for (auto const n : neighbours(current))
+            {
+                if (n < m_labels.size() && m_labels[n] == 0u && is_unbuiltTile(n))
+                {
+                    m_labels[n] = rid;
+                    frontier.push_back(n);
+                }
+            }
+        }
+    }
+}
+
+void OutsideRegions::build(IntParallelepiped const& vol)
+{
+    for (auto z = std::max(vol.down, 0); z <= std::min(vol.up(), m_height - 1); ++z)
+    {
+        //--- Remove the tiles of the volume from their regions
+        for (auto x = std::max(vol.behind, 0); x <= std::min(vol.front(), m_length - 1); ++x)
+        {
+            for (auto y = std::max(vol.left, 0); y <= std::min(vol.right(), m_width - 1); ++y)
+            {
+                auto const i = index(x, y, z);
+                auto const rid = m_labels[i];
+
+                if (rid == 0u) { continue; }
+
+                auto & region = mutable_region(rid);
+                --region.tile_count;
+                if (is_edge(i)) { --region.edge_count; }
+
+                set_label(i, 0u);
+
+                if (region.tile_count == 0u) { release_region(rid); }
+            }
+        }
+
+        //--- Only a region touched in many points around the volume can be split: label its pieces cut off
+        for (auto const& [rid, arcs] : compute_arcs(vol, z, std::pmr::get_default_resource()))
+        {
+            if (arcs.size() < 2u) { continue; }
+
+            auto pieces = explore_pieces(vol, rid, arcs, false, std::pmr::get_default_resource());
+
+            // If all the pieces were explored in the same round, the last one keeps the label
+            if (std::all_of(pieces.cbegin(), pieces.cend(), [](Piece const& p) { return p.exhausted; }))
+            {
+                pieces.back().exhausted = false;
+            }
+
+            for (auto const& piece : pieces)
+            {
+                if (!piece.exhausted) { continue; }
+
+                auto const new_rid = create_region();
+
+                for (auto const i : piece.tiles)
+                {
+                    set_label(i, new_rid);
+                }
+
+                mutable_region(new_rid) = { piece.tiles.size(), piece.edge_count };
+
+                auto & region = mutable_region(rid);
+                region.tile_count -= piece.tiles.size();
+                region.edge_count -= piece.edge_count;
+            }
+        }
+    }
+}
+
+void OutsideRegions::unbuild(IntParallelepiped const& vol)
+{
+    auto group = std::vector<std::size_t>{};
+    auto seeds = std::map<RegionId, std::size_t>{};		// A tile of each region touching the group
+
+    for (auto z = std::max(vol.down, 0); z <= std::min(vol.up(), m_height - 1); ++z)
+    {
+        for (auto x = std::max(vol.behind, 0); x <= std::min(vol.front(), m_length - 1); ++x)
+        {
+            for (auto y = std::max(vol.left, 0); y <= std::min(vol.right(), m_width - 1); ++y)
+            {
+                auto const start = index(x, y, z);
+
+                if (m_labels[start] != 0u || !is_unbuiltTile(start)) { continue; }
+
+                //--- Gather the group of freed tiles connected to this one, and the regions around it
+                group.clear();
+                seeds.clear();
+
+                // The freed tiles get a temporary label, so that they are visited once
+                auto const rid = create_region();
+
+                set_label(start, rid);
+                group.push_back(start);
+
+                for (auto g = std::size_t{ 0u }; g < group.size(); ++g)
+                {
+                    for (auto const n : neighbours(group[g]))
+                    {
+                        if (n >= m_labels.size()) { continue; }
+
+                        if (m_labels[n] == 0u)
+                        {
+                            if (vol.contains(position(n)) && is_unbuiltTile(n))
+                            {
+                                set_label(n, rid);
+                                group.push_back(n);
+                            }
+                        }
+                        else if (m_labels[n] != rid)
+                        {
+                            seeds.emplace(m_labels[n], n);
+                        }
+                    }
+                }
+
+                auto & region = mutable_region(rid);
+                region.tile_count = group.size();
+                region.edge_count = static_cast<std::size_t>(std::count_if(group.cbegin(), group.cend(), [this](auto const i) { return is_edge(i); }));
+
+                //--- Merge all the regions in the biggest one
+                auto target = rid;
+                for (auto const& [other, seed] : seeds)
+                {
+                    if (m_regions[other].tile_count > m_regions[target].tile_count) { target = other; }
+                }
+
+                if (target != rid) { merge_region(rid, start, target); }
+
+                for (auto const& [other, seed] : seeds)
+                {
+                    if (other != target) { merge_region(other, seed, target); }
+                }
+            }
+        }
+    }
+}
+
+
+void OutsideRegions::compute_cutOffTiles(IntParallelepiped const& vol, std::pmr::vector<Vector3i> & tiles, std::pmr::memory_resource * const scratch) const
+{
+    for (auto z = std::max(vol.down, 0); z <= std::min(vol.up(), m_height - 1); ++z)
+    {
+        for (auto const& [rid, arcs] : compute_arcs(vol, z, scratch))
+        {
+            // The courtyards are already cut off
+            if (!is_open(rid)) { continue; }
+
+            // The edge tiles of the region that the volume would cover
+            auto covered_edges = std::size_t{ 0u };
+            for (auto x = std::max(vol.behind, 0); x <= std::min(vol.front(), m_length - 1); ++x)
+            {
+                for (auto y = std::max(vol.left, 0); y <= std::min(vol.right(), m_width - 1); ++y)
+                {
+                    auto const i = index(x, y, z);
+                    if (m_labels[i] == rid && is_edge(i)) { ++covered_edges; }
+                }
+            }
+
+            auto pieces = explore_pieces(vol, rid, arcs, false, scratch);
+
+            // The piece not fully explored reaches the edge of the map if the others don't account for all the edge tiles
+            auto remaining_edges = m_regions[rid].edge_count - covered_edges;
+            for (auto const& piece : pieces)
+            {
+                if (piece.exhausted) { remaining_edges -= piece.edge_count; }
+            }
+
+            if (remaining_edges == 0u)
+            {
+                pieces = explore_pieces(vol, rid, arcs, true, scratch);
+            }
+
+            for (auto const& piece : pieces)
+            {
+                if (piece.exhausted && piece.edge_count == 0u)
+                {
+                    for (auto const i : piece.tiles)
+                    {
+                        tiles.push_back(position(i));
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+void OutsideRegions::begin_transaction()
+{
+    #if DYNAMIC_ASSERTS
+        if (m_transaction) { throw std::runtime_error("A transaction of the OutsideRegions is already active."); }
+    #endif
+
+    m_regionCount_atBegin = m_regions.size();
+    m_transaction = true;
+}
+
+void OutsideRegions::commit_transaction()
+{
+    m_free_ids.insert(m_free_ids.end(), m_released_ids.cbegin(), m_released_ids.cend());
+
+    m_label_log.clear();
+    m_region_log.clear();
+    m_reused_ids.clear();
+    m_released_ids.clear();
+    m_transaction = false;
+}
+
+void OutsideRegions::rollback_transaction()
+{
+    for (auto it = m_label_log.crbegin(); it != m_label_log.crend(); ++it)
+    {
+        m_labels[it->first] = it->second;
+    }
+    for (auto it = m_region_log.crbegin(); it != m_region_log.crend(); ++it)
+    {
+        m_regions[it->first] = it->second;
+    }
+
+    m_regions.resize(m_regionCount_atBegin);
+    m_free_ids.insert(m_free_ids.end(), m_reused_ids.crbegin(), m_reused_ids.crend());
+
+    m_label_log.clear();
+    m_region_log.clear();
+    m_reused_ids.clear();
+    m_released_ids.clear();
+    m_transaction = false;
+}
+
+
+auto OutsideRegions::neighbours(std::size_t const i) const noexcept -> std::array<std::size_t, 4>
+{
+    auto const p = position(i);
+    auto const none = m_labels.size();
+
+    return { p.x > 0			 ? i - m_width : none,
+             p.x < m_length - 1 ? i + m_width : none,
+             p.y > 0			 ? i - 1u	   : none,
+             p.y < m_width - 1  ? i + 1u	   : none };
+}
+
+bool OutsideRegions::is_unbuiltTile(std::size_t const i) const
+{
+    auto const p = position(i);
+
+    return !m_tiles.get_existent(p.x, p.y, p.z).is_built();
+}
+
+void OutsideRegions::set_label(std::size_t const i, RegionId const rid)
+{
+    if (m_transaction) { m_label_log.emplace_back(i, m_labels[i]); }
+
+    m_labels[i] = rid;
+}
+
+auto OutsideRegions::mutable_region(RegionId const rid) -> Region &
+{
+    // The regions created during the transaction are simply dropped by a rollback
+    if (m_transaction && rid < m_regionCount_atBegin) { m_region_log.emplace_back(rid, m_regions[rid]); }
+
+    return m_regions[rid];
+}
+
+auto OutsideRegions::create_region() -> RegionId
+{
+    if (m_free_ids.empty())
+    {
+        m_regions.emplace_back();
+        return static_cast<RegionId>(m_regions.size() - 1u);
+    }
+    else
+    {
+        auto const rid = m_free_ids.back();
+        m_free_ids.pop_back();
+
+        if (m_transaction) { m_reused_ids.push_back(rid); }
+
+        mutable_region(rid) = Region{};
+        return rid;
+    }
+}
+
+void OutsideRegions::release_region(RegionId const rid)
+{
+    // A region released during a transaction could be restored by a rollback, so it can't be reused before the commit
+    if (m_transaction) { m_released_ids.push_back(rid); }
+    else			   { m_free_ids.push_back(rid); }
+}
+
+void OutsideRegions::merge_region(RegionId const from, std::size_t const seed, RegionId const to)
+{
+    auto frontier = std::vector<std::size_t>{ seed };
+    set_label(seed, to);
+
+    while (!frontier.empty())
+    {
+        auto const current = frontier.back();
+        frontier.pop_back();
+
+        for (auto const n : neighbours(current))
+        {
+            if (n < m_labels.size() && m_labels[n] == from)
+            {
+                set_label(n, to);
+                frontier.push_back(n);
+            }
+        }
+    }
+
+    auto const moved = m_regions[from];
+
+    auto & target = mutable_region(to);
+    target.tile_count += moved.tile_count;
+    target.edge_count += moved.edge_count;
+
+    mutable_region(from) = Region{};
+    release_region(from);
+}
+
+auto OutsideRegions::compute_arcs(IntParallelepiped const& vol, int const z, std::pmr::memory_resource * const resource) const -> Arcs
+{
+    // The tiles around the volume, in order along its perimeter, so that consecutive tiles are adjacent
+    auto ring = std::pmr::vector<Vector3i>{ resource };
+    ring.reserve(2u * (vol.length + vol.width) + 4u);
+
+    for (auto y = vol.left - 1; y <= vol.right(); ++y)		{ ring.emplace_back(vol.behind - 1, y, z); }
+    for (auto x = vol.behind - 1; x <= vol.front(); ++x)	{ ring.emplace_back(x, vol.right_end(), z); }
+    for (auto y = vol.right_end(); y >= vol.left; --y)		{ ring.emplace_back(vol.front_end(), y, z); }
+    for (auto x = vol.front_end(); x >= vol.behind; --x)	{ ring.emplace_back(x, vol.left - 1, z); }
+
+    auto const label_at = [this](Vector3i const p) -> RegionId
+    {
+        if (p.x < 0 || p.y < 0 || p.x >= m_length || p.y >= m_width) { return 0u; }
+        return m_labels[index(p.x, p.y, p.z)];
+    };
+
+    // Start the runs after a built tile, so that no run wraps around the end of the ring
+    auto const first_built = std::find_if(ring.cbegin(), ring.cend(), [&label_at](Vector3i const p) { return label_at(p) == 0u; });
+    if (first_built != ring.cend())
+    {
+        std::rotate(ring.begin(), ring.begin() + (first_built - ring.cbegin()), ring.end());
+    }
+
+    auto arcs = Arcs{ resource };
+    auto * run = static_cast<std::pmr::vector<std::size_t>*>(nullptr);
+
+    for (auto const p : ring)
+    {
+        auto const rid = label_at(p);
+
+        if (rid == 0u)
+        {
+            run = nullptr;
+            continue;
+        }
+
+        // Consecutive unbuilt tiles are adjacent, so a run belongs to a single region
+        if (!run)
+        {
+            auto it = std::find_if(arcs.begin(), arcs.end(), [rid](auto const& a) { return a.first == rid; });
+            if (it == arcs.end()) 
+            { 
+                // The vectors of the pair get the resource of the arcs
+                it = arcs.emplace(arcs.end());
+                it->first = rid;
+            }
+
+            run = &it->second.emplace_back();
+        }
+
+        run->push_back(index(p.x, p.y, p.z));
+    }
+
+    return arcs;
+}
+
+auto OutsideRegions::explore_pieces(IntParallelepiped const& vol, RegionId const rid, std::pmr::vector<std::pmr::vector<std::size_t>> const& arcs,
+                                    bool const explore_all, std::pmr::memory_resource * const resource) const -> std::pmr::vector<Piece>
+{
+    // Each arc starts its own piece. The tiles of a piece are also the queue of its exploration: heads[g] is the next one to expand.
+    auto groups = std::pmr::vector<Piece>{ resource };
+    groups.reserve(arcs.size());
+    for (auto g = std::size_t{ 0u }; g < arcs.size(); ++g) { groups.emplace_back(resource); }
+
+    auto heads = std::pmr::vector<std::size_t>(arcs.size(), 0u, resource);
+    auto parents = std::pmr::vector<std::size_t>(arcs.size(), 0u, resource);
+    auto owners = std::pmr::unordered_map<std::size_t, std::size_t>{ resource };		// Group of each reached tile
+
+    auto const find = [&parents](std::size_t g)
+    {
+        while (parents[g] != g) { g = parents[g] = parents[parents[g]]; }
+        return g;
+    };
+
+    for (auto g = std::size_t{ 0u }; g < arcs.size(); ++g)
+    {
+        parents[g] = g;
+
+        for (auto const i : arcs[g])
+        {
+            owners.emplace(i, g);
+            groups[g].tiles.push_back(i);
+            if (is_edge(i)) { ++groups[g].edge_count; }
+        }
+    }
+
+    auto growing = std::pmr::vector<bool>(arcs.size(), false, resource);
+
+    while (true)
+    {
+        // A piece is growing while any of its merged groups still has tiles to expand
+        std::fill(growing.begin(), growing.end(), false);
+        for (auto g = std::size_t{ 0u }; g < groups.size(); ++g)
+        {
+            if (heads[g] < groups[g].tiles.size()) { growing[find(g)] = true; }
+        }
+
+        auto const growing_count = static_cast<std::size_t>(std::count(growing.cbegin(), growing.cend(), true));
+        if (growing_count == 0u || (growing_count == 1u && !explore_all)) { break; }
+
+        for (auto g = std::size_t{ 0u }; g < groups.size(); ++g)
+        {
+            if (heads[g] == groups[g].tiles.size()) { continue; }
+
+            auto const current = groups[g].tiles[heads[g]++];
+
+            for (auto const n : neighbours(current))
+            {
+                if (n >= m_labels.size() || m_labels[n] != rid || vol.contains(position(n))) { continue; }
+
+                auto const [it, inserted] = owners.emplace(n, g);
+                if (inserted)
+                {
+                    groups[g].tiles.push_back(n);
+                    if (is_edge(n)) { ++groups[g].edge_count; }
+                }
+                else
+                {
+                    // Two pieces met: they are the same
+                    auto const lhs = find(g);
+                    auto const rhs = find(it->second);
+                    if (lhs != rhs) { parents[lhs] = rhs; }
+                }
+            }
+        }
+    }
+
+    // Gather the groups of each piece
+    auto pieces = std::pmr::vector<Piece>{ resource };
+    auto root_pieces = std::pmr::unordered_map<std::size_t, std::size_t>{ resource };
+
+    for (auto g = std::size_t{ 0u }; g < groups.size(); ++g)
+    {
+        auto const root = find(g);
+        auto const [it, inserted] = root_pieces.emplace(root, pieces.size());
+        if (inserted)
+        {
+            pieces.emplace_back(resource);
+            pieces.back().exhausted = !growing[root];
+        }
+
+        auto & piece = pieces[it->second];
+        piece.tiles.insert(piece.tiles.end(), groups[g].tiles.cbegin(), groups[g].tiles.cend());
+        piece.edge_count += groups[g].edge_count;
+    }
+
+    return pieces;
+}
+
+
+
+} // namespace tgm
\ No newline at end of file
@@ -0,0 +1,169 @@
+#ifndef GM_OUTSIDE_REGIONS_HH
+#define GM_OUTSIDE_REGIONS_HH
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "map/tiles/tile_set.hh"
+#include "settings/debug/debug_settings.hh"
+#include "system/parallelepiped.hh"
+#include "system/vector3.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//
+//	Labelling of the connected components of the unbuilt tiles of each floor (4-connected, since nobody can walk between two walls
+//	touching at a corner). A region reaching the edge of the map is part of "the outside" (see doc/city_generation_algorithm), the
+//	others are courtyards.
+//	The labels are updated at each build and unbuild: an unbuilt area merges the regions around it, relabelling the smaller ones, while
+//	a built area can split only the regions it touches in more than one point, and only the pieces cut off are explored and relabelled.
+//	The queries can run concurrently, but not during an update. Like the TileSet, it can record its changes in an undo log.
+//
+////
+class OutsideRegions
+{
+    public:
+        using RegionId = std::uint32_t;
+
+        explicit OutsideRegions(TileSet const& tiles);
+
+        ////
+        //	Label again all the tiles, e.g. after the TileSet was read.
+        ////
+        void reset();
+
+        ////
+        //	Update the regions after the tiles of @vol were built.
+        ////
+        void build(IntParallelepiped const& vol);
+
+        ////
+        //	Update the regions after the tiles of @vol were unbuilt. The tiles still built (e.g. the borders shared with other areas) are
+        //	ignored.
+        ////
+        void unbuild(IntParallelepiped const& vol);
+
+        ////
+        //	@return: The region of the tile @pos, or 0 if the tile is built.
+        ////
+        auto region(Vector3i const pos) const -> RegionId { return m_labels[index(pos.x, pos.y, pos.z)]; }
+
+        ////
+        //	@return: True if the region @rid reaches the edge of the map.
+        ////
+        bool is_open(RegionId const rid) const { return m_regions[rid].edge_count > 0u; }
+
+        ////
+        //	Append to @tiles the tiles of the open regions that would be cut off from the edge of the map if @vol was built. Only the
+        //	regions that @vol would split are explored, and only until all their pieces but one are known.
+        //	@scratch: Memory of the temporary containers of the exploration.
+        ////
+        void compute_cutOffTiles(IntParallelepiped const& vol, std::pmr::vector<Vector3i> & tiles, std::pmr::memory_resource * const scratch) const;
+
+        void begin_transaction();
+        void commit_transaction();
+        void rollback_transaction();
+
+    private:
+        struct Region
+        {
+            std::size_t tile_count = 0u;
+            std::size_t edge_count = 0u;		// Tiles lying on the edge of the map
+        };
+
+        struct Piece
+        {
+            explicit Piece(std::pmr::memory_resource * const resource) : tiles{ resource } {}
+
+            std::pmr::vector<std::size_t> tiles;
+            std::size_t edge_count = 0u;
+            bool exhausted = false;		// True if all its tiles were explored
+        };
+
+        // Runs of consecutive unbuilt tiles around a volume, grouped by region
+        using Arcs = std::pmr::vector<std::pair<RegionId, std::pmr::vector<std::pmr::vector<std::size_t>>>>;
+
+        TileSet const& m_tiles;
+        int const m_length;
+        int const m_width;
+        int const m_height;
+
+        std::vector<RegionId> m_labels;
+        std::vector<Region> m_regions;		// Indexed by RegionId, 0 is reserved for the built tiles
+        std::vector<RegionId> m_free_ids;
+
+        bool m_transaction = false;
+        std::size_t m_regionCount_atBegin = 0u;
+        std::vector<std::pair<std::size_t, RegionId>> m_label_log;		// (tile, old label), in the order they happened
+        std::vector<std::pair<RegionId, Region>> m_region_log;			// (region, old value), in the order they happened
+        std::vector<RegionId> m_reused_ids;								// Taken from m_free_ids during the transaction
+        std::vector<RegionId> m_released_ids;							// Released during the transaction, free only after the commit
+
+
+        auto index(int const x, int const y, int const z) const noexcept -> std::size_t
+        {
+            return (static_cast<std::size_t>(z) * m_length + x) * m_width + y;
+        }
+
+        auto position(std::size_t const i) const noexcept -> Vector3i
+        {
+            auto const floor_size = static_cast<std::size_t>(m_length) * m_width;
+            auto const rem = i % floor_size;
+
+            return { static_cast<int>(rem / m_width), static_cast<int>(rem % m_width), static_cast<int>(i / floor_size) };
+        }
+
+        bool is_edge(std::size_t const i) const noexcept
+        {
+            auto const p = position(i);
+            return p.x == 0 || p.y == 0 || p.x == m_length - 1 || p.y == m_width - 1;
+        }
+
+        ////
+        //	@return: The 4-neighbours of the tile @i on its floor, inside the map. The unused slots hold the size of the map.
+        ////
+        auto neighbours(std::size_t const i) const noexcept -> std::array<std::size_t, 4>;
+
+        bool is_unbuiltTile(std::size_t const i) const;
+
+        void set_label(std::size_t const i, RegionId const rid);
+        auto mutable_region(RegionId const rid) -> Region &;
+        auto create_region() -> RegionId;
+        void release_region(RegionId const rid);
+
+        ////
+        //	Move all the tiles of @from, reached from its tile @seed, to @to.
+        ////
+        void merge_region(RegionId const from, std::size_t const seed, RegionId const to);
+
+        ////
+        //	@return: The unbuilt tiles around @vol on the floor @z, split in runs of consecutive tiles and grouped by region (allocated
+        //			 in @resource).
+        ////
+        auto compute_arcs(IntParallelepiped const& vol, int const z, std::pmr::memory_resource * const resource) const -> Arcs;
+
+        ////
+        //	Explore at the same pace, without entering @vol, the tiles of @rid reachable from each of the @arcs, merging the arcs that
+        //	meet. Stop when at most one piece is still growing, or when none is if @explore_all.
+        //	@return: The pieces found (allocated in @resource, like the temporary containers).
+        ////
+        auto explore_pieces(IntParallelepiped const& vol, RegionId const rid, std::pmr::vector<std::pmr::vector<std::size_t>> const& arcs,
+                            bool const explore_all, std::pmr::memory_resource * const resource) const -> std::pmr::vector<Piece>;
+};
+
+
+
+} // namespace tgm
+
+
+#endif //GM_OUTSIDE_REGIONS_HH
\ No newline at end of file
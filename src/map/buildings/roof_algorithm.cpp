@@ -17,7 +17,8 @@ namespace RoofAlgorithm
         return a;
     }
 
-    static auto compute_roofablePositions(BuildingId const bid, std::unordered_set<Vector3i> const& starting_positions, DataArray<Building> const& buildings, TileSet const& tiles)
+    static auto compute_roofablePositions(BuildingId const bid, std::unordered_set<Vector3i> const& starting_positions, DataArray<Building> const& buildings, TileSet const& tiles,
+                                          bool const roof_everyArea)
         -> std::unordered_set<Vector3i>
     {
         std::unordered_set<Vector3i> roofable_poss;
@@ -56,9 +57,9 @@ namespace RoofAlgorithm
 
                             auto const& atempl = area_templates.at(a.type());
 
-                            isAreaRoofable_cache.insert({ acid, atempl.is_roofable() });
+                            isAreaRoofable_cache.insert({ acid, atempl.is_roofable(roof_everyArea) });
 
-                            if (atempl.is_roofable()) {	is_roofable_for_bid = true; }
+                            if (atempl.is_roofable(roof_everyArea)) {	is_roofable_for_bid = true; }
                         }
                         else
                         {
@@ -96,7 +97,8 @@ namespace RoofAlgorithm
         return roofable_poss;
     }
 
-    auto compute_roofablePositions_fromArea(BuildingAreaCompleteId const starting_area, DataArray<Building> const& buildings, TileSet const& tiles)
+    auto compute_roofablePositions_fromArea(BuildingAreaCompleteId const starting_area, DataArray<Building> const& buildings, TileSet const& tiles,
+                                            bool const roof_everyArea)
         -> std::unordered_set<Vector3i>
     {
         std::unordered_set<Vector3i> starting_positions;
@@ -110,13 +112,14 @@ namespace RoofAlgorithm
             }
         }
 
-        return compute_roofablePositions(starting_area.bid, starting_positions, buildings, tiles);
+        return compute_roofablePositions(starting_area.bid, starting_positions, buildings, tiles, roof_everyArea);
     }
     
-    auto compute_roofablePositions_fromTile(BuildingId const bid, Vector3i const starting_pos, DataArray<Building> const& buildings, TileSet const& tiles)
+    auto compute_roofablePositions_fromTile(BuildingId const bid, Vector3i const starting_pos, DataArray<Building> const& buildings, TileSet const& tiles,
+                                            bool const roof_everyArea)
         -> std::unordered_set<Vector3i>
     {
-        return compute_roofablePositions(bid, { starting_pos }, buildings, tiles);
+        return compute_roofablePositions(bid, { starting_pos }, buildings, tiles, roof_everyArea);
     }
 
 } //namespace RoofAlgorithm
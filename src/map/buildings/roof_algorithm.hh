@@ -18,10 +18,15 @@ namespace tgm
 namespace RoofAlgorithm
 {
 
-    auto compute_roofablePositions_fromArea(BuildingAreaCompleteId const starting_area, DataArray<Building> const& buildings, TileSet const& tiles)
+    ////
+    //	@roof_everyArea: MapSettings::roof_every_area of the simulation (see AreaTemplate::is_roofable()).
+    ////
+    auto compute_roofablePositions_fromArea(BuildingAreaCompleteId const starting_area, DataArray<Building> const& buildings, TileSet const& tiles,
+                                            bool const roof_everyArea)
         -> std::unordered_set<Vector3i>;
     
-    auto compute_roofablePositions_fromTile(BuildingId const bid, Vector3i const starting_pos, DataArray<Building> const& buildings, TileSet const& tiles)
+    auto compute_roofablePositions_fromTile(BuildingId const bid, Vector3i const starting_pos, DataArray<Building> const& buildings, TileSet const& tiles,
+                                            bool const roof_everyArea)
         -> std::unordered_set<Vector3i>;
 
 } //namespace RoofAlgorithm
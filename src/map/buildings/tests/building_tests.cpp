@@ -6,6 +6,7 @@
 #include "settings/debug/visual_debug_hip_roof_matrix_settings.hh"
 
 #include "debug/visual/building_expansion_stream.hh"
+#include "map/simulation_batch_runner.hh"
 
 namespace tgm
 {
@@ -373,6 +374,140 @@ namespace BuildingAlgorithmTests
             lgr << Logger::remt;
         }
     }
+
+    static void check_sameSnapshot(BuildingManagerSnapshot const& before, BuildingManagerSnapshot const& after, int const evaluation)
+    {
+        auto const expect = [evaluation](bool const same, char const*const what)
+            {
+                if (!same)
+                {
+                    auto oss = std::ostringstream{};
+                    oss << "The evaluation #" << evaluation << " of a building expansion changed " << what << ".";
+                    throw std::runtime_error(oss.str());
+                }
+            };
+
+        expect(before.tiles == after.tiles, "the tiles");
+        expect(before.city_count == after.city_count && before.city_ids == after.city_ids, "the cities");
+        expect(before.block_count == after.block_count && before.block_ids == after.block_ids, "the city blocks");
+        expect(before.building_count == after.building_count && before.building_ids == after.building_ids, "the buildings or their areas");
+        expect(before.roof_count == after.roof_count && before.roof_ids == after.roof_ids, "the roofs");
+        expect(before.door_count == after.door_count, "the door count");
+        expect(before.outside_labels == after.outside_labels, "the outside regions");
+        expect(before.area_graph == after.area_graph, "the area graph");
+    }
+
+    void expansionEvaluation_tests(GameMap & map)
+    {
+        if (map.simulation_context().settings.map.ground_floor != 0 || map.tiles().length() < 100 || map.tiles().width() < 150 || map.tiles().height() < 1)
+        {
+            throw std::runtime_error("Cannot perform the test if the map is not large enough.");
+        }
+        
+        #if BUILDEXP_VISUALDEBUG || HIPROOFMATRIX_VISUALDEBUG
+            throw std::runtime_error("Cannot perform the test if BUILDEXP_VISUALDEBUG or HIPROOFMATRIX_VISUALDEBUG are activated.");
+        #endif
+
+        auto const building_recipe = BuildingRecipe{ { 200.f, 200.f }, AreaType::cowshed, { 10, 10 }, "farm" };
+
+        auto bids = std::vector<BuildingId>{};
+        for (auto i = 0; i < 5; ++i)
+        {
+            auto const bid = map.debug_buildBuilding_inNearestCity(building_recipe);
+            if (bid) { bids.push_back(bid.value()); }
+        }
+        if (bids.empty()) { throw std::runtime_error("Cannot build the buildings of the test."); }
+
+
+        auto evaluation_count = 0;
+        auto expansion_count = 0;
+
+        for (auto round = 0; round < 20; ++round)
+        {
+            for (auto const bid : bids)
+            {
+                auto const before = map.building_manager().debug_snapshot();
+
+                // Every evaluation of the same step must propose the same expansion, and leave the map untouched.
+                auto const evaluation = map.debug_evaluate_buildingExpansion(bid);
+                for (auto i = 0; i < 10; ++i)
+                {
+                    auto const again = map.debug_evaluate_buildingExpansion(bid);
+                    ++evaluation_count;
+
+                    check_sameSnapshot(before, map.building_manager().debug_snapshot(), evaluation_count);
+
+                    if (again.has_value() != evaluation.has_value() || 
+                        (again && (again->selected_area != evaluation->selected_area || again->position != evaluation->position ||
+                                   again->replaced_areas != evaluation->replaced_areas || again->door_delta != evaluation->door_delta ||
+                                   again->roof_delta != evaluation->roof_delta)))
+                    {
+                        throw std::runtime_error("Two evaluations of the same building expansion gave different results.");
+                    }
+                }
+
+                if (!evaluation) { continue; }
+
+
+                // The real expansion must build the evaluated area, replacing the evaluated number of areas.
+                auto const area_count = static_cast<int>(map.building_manager().debug_getBuilding(bid).areas_by_ref().count());
+                auto const door_count = map.building_manager().debug_snapshot().door_count;
+
+                if (!map.debug_expand_building(bid)) { throw std::runtime_error("A building expansion that was evaluated as possible failed."); }
+                ++expansion_count;
+
+                auto const& building = map.building_manager().debug_getBuilding(bid);
+
+                auto built = false;
+                for (auto const& [aid, area] : building.areas_by_ref())
+                {
+                    auto const vol = area.volume();
+                    if (area.type() == evaluation->selected_area && Vector3i{ vol.behind, vol.left, vol.down } == evaluation->position) { built = true; }
+                }
+                if (!built) { throw std::runtime_error("The building expansion didn't build the evaluated area."); }
+
+                if (static_cast<int>(building.areas_by_ref().count()) != area_count + 1 - evaluation->replaced_areas ||
+                    static_cast<int>(map.building_manager().debug_snapshot().door_count) - static_cast<int>(door_count) != evaluation->door_delta)
+                {
+                    throw std::runtime_error("The building expansion had different effects from the evaluated ones.");
+                }
+            }
+        }
+
+        g_log << "Expansion evaluation tests passed (" << evaluation_count << " evaluations, " << expansion_count << " expansions)." << std::endl;
+    }
+
+    void contextSettings_tests()
+    {
+        auto parameters = SimulationBatchParameters{};
+        parameters.building_count = 60u;
+        parameters.expansion_rounds = 2u;
+        parameters.expanded_buildings = 20u;
+        parameters.thread_count = 2u;
+
+        auto large_blocks = sim_settings;
+        large_blocks.map.max_cityBlockSurface = 1500;
+        auto small_blocks = sim_settings;
+        small_blocks.map.max_cityBlockSurface = 300;
+
+        auto const seed = std::vector<unsigned>{ 42u };
+        auto const large_run = SimulationBatchRunner{ parameters, large_blocks }.run(seed).front();
+        auto const small_run = SimulationBatchRunner{ parameters, small_blocks }.run(seed).front();
+
+        if (!large_run.error.empty() || !small_run.error.empty())
+        {
+            throw std::runtime_error("A run of the context settings tests failed: " + large_run.error + small_run.error);
+        }
+
+        // Smaller blocks fill up sooner, so the same buildings need more of them.
+        if (small_run.block_count <= large_run.block_count)
+        {
+            throw std::runtime_error("The maximum block surface of the SimulationContext was ignored.");
+        }
+
+        g_log << "Context settings tests passed (" << large_run.block_count << " blocks with the large surface, " 
+              << small_run.block_count << " with the small one)." << std::endl;
+    }
 }
 
 
@@ -69,6 +69,17 @@ namespace BuildingAlgorithmTests
     void blockOutline_tests(GameMap & map);
 
     void automatic_cityDevelopment(GameMap & map, std::vector<BuildingId> & created_buildings);
+
+    ////
+    //	Check that evaluate_buildingExpansion() leaves the map as it found it, and that a following expansion builds the evaluated area.
+    ////
+    void expansionEvaluation_tests(GameMap & map);
+
+    ////
+    //	Check that the block surface is read from the settings of the SimulationContext: two runs of the same seed with a
+    //	different max_cityBlockSurface must give different cities.
+    ////
+    void contextSettings_tests();
 };
 
 
@@ -21,6 +21,11 @@ class City
         bool empty() const { return m_blocks.empty(); }
         auto const& blocks() const { return m_blocks; }
 
+        ////
+        //	@return: The progressive number of the next building construction, used to derive the RandomStream of the construction.
+        ////
+        auto next_expansionStep() noexcept -> std::uint64_t { return m_expansion_step++; }
+
 
         void add_block(CityBlockId const cbid) 
         {
@@ -44,6 +49,7 @@ class City
 
     private:
         std::vector<CityBlockId> m_blocks;
+        std::uint64_t m_expansion_step = 0u;
 };
 
 
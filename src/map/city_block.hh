@@ -4,7 +4,6 @@
 
 #include <set>
 
-#include "settings/simulation/simulation_settings.hh"
 #include "system/parallelepiped.hh"
 #include "system/vector2.hh"
 
@@ -19,13 +18,18 @@ namespace tgm
 class CityBlock
 {
     public:
+        ////
+        //	@max_surface: Maximum sum of the surfaces of the areas of the block (MapSettings::max_cityBlockSurface of the simulation).
+        ////
+        explicit CityBlock(int const max_surface) noexcept : m_max_surface{ max_surface } { }
+
         auto center() const -> Vector2f { return m_center; }
 
         bool empty() const { return m_buildings.empty(); }
         bool contains(BuildingId const bid) const { return std::find(m_buildings.cbegin(), m_buildings.cend(), bid) != m_buildings.end(); }
         auto const& buildings() const { return m_buildings; }
 
-        bool has_room_for(int const newArea_surface) const { return m_surface + newArea_surface <= sim_settings.map.max_cityBlockSurface; }
+        bool has_room_for(int const newArea_surface) const { return m_surface + newArea_surface <= m_max_surface; }
         
 
         void add_building(BuildingId const bid) 
@@ -91,6 +95,7 @@ class CityBlock
     private:
         std::vector<BuildingId> m_buildings;
         
+        int m_max_surface = 0;
         int m_surface = 0;
         Vector2f m_center;
         int m_areas_count = 0;
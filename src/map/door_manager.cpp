@@ -1,7 +1,7 @@
 #include "door_manager.hh"
 
 
-#include <chrono>
+#include <algorithm>
 
 #include "utilities.hh"
 
@@ -13,13 +13,8 @@ namespace tgm
 
 void DoorManager::update()
 {
-    //Close all the doors.
-    //TODO: PERFORMANCE: Close only previously opened doors to shorten this loop.
-    /*for (auto & d : m_doors)
-    {
-        if (d.is_open())
-            try_close_door(d);
-    }*/
+    //Close the doors whose timer expired.
+    m_closing_timers.advance([this](DoorId const did) { on_closingTimer(did); });
 
 
     auto & tod_queue = m_door_events->get<TryOpenDoorEv>();
@@ -30,7 +25,7 @@ void DoorManager::update()
         auto d = m_doors.weak_get(e.door_id);
         if (d && !d->is_open()) // The door could not exist anymore.
         {
-            open_door(*d);
+            open_door(e.door_id, *d);
         }
 
         tod_queue.pop();
@@ -45,9 +40,13 @@ void DoorManager::update()
         for (auto & [did, d] : m_doors)
         {
             if (d.is_open())
-                try_close_door(d);
+            {
+                if (try_close_door(d)) { m_open_doors.erase(did); }
+            }
             else
-                open_door(d);
+            {
+                open_door(did, d);
+            }
         }
 
 
@@ -59,8 +58,15 @@ auto DoorManager::create_door(Vector3i const& pos, bool const vertical) -> DoorI
 {
     auto& el = m_doors.create(pos, vertical);
 
-    auto spid = m_dynamic_manager.create(compute_volume(pos, vertical, false), vertical ? verticalClosed_subimage : horizontalClosed_subimage);
-    el.value.set_spriteId(spid);
+    if (m_transaction)
+    {
+        m_pending_doors.push_back(el.id());
+    }
+    else
+    {
+        auto spid = m_dynamic_manager.create(compute_volume(pos, vertical, false), vertical ? verticalClosed_subimage : horizontalClosed_subimage);
+        el.value.set_spriteId(spid);
+    }
 
     return el.id();
 }
@@ -73,15 +79,64 @@ void DoorManager::destroy_door(DoorId const did)
         if(d.is_open()) { PMdeb.add_impassableTile(d.position()); }
     #endif
 
-    m_dynamic_manager.destroy(d.sprite_id());
+    if (!m_transaction)
+    {
+        m_dynamic_manager.destroy(d.sprite_id());
+    }
+    else if (auto const it = std::find(m_pending_doors.begin(), m_pending_doors.end(), did);   it != m_pending_doors.end())
+    {
+        m_pending_doors.erase(it);		// Created during the transaction: it has no sprite yet
+    }
+    else
+    {
+        m_pending_spriteRemovals.push_back(d.sprite_id());
+    }
 
     m_doors.destroy(did);
         
 }
 
-void DoorManager::open_door(Door & d)
+void DoorManager::begin_transaction()
+{
+    m_doors.begin_transaction();
+    m_transaction = true;
+}
+
+void DoorManager::commit_transaction()
+{
+    for (auto const sid : m_pending_spriteRemovals)
+    {
+        m_dynamic_manager.destroy(sid);
+    }
+
+    for (auto const did : m_pending_doors)
+    {
+        auto & d = m_doors.get_or_throw(did);
+        auto const vert = d.vertical();
+
+        d.set_spriteId(m_dynamic_manager.create(compute_volume(d.position(), vert, false), vert ? verticalClosed_subimage : horizontalClosed_subimage));
+    }
+
+    m_doors.commit_transaction();
+
+    m_pending_spriteRemovals.clear();
+    m_pending_doors.clear();
+    m_transaction = false;
+}
+
+void DoorManager::rollback_transaction()
+{
+    m_doors.rollback_transaction();
+
+    m_pending_spriteRemovals.clear();
+    m_pending_doors.clear();
+    m_transaction = false;
+}
+
+void DoorManager::open_door(DoorId const did, Door & d)
 {
     d.do_open();
+    m_open_doors[did] = m_closing_timers.schedule(did, closing_delay);
 
     auto const pos = d.position();
     auto const vert = d.vertical();
@@ -108,7 +163,27 @@ void DoorManager::open_door(Door & d)
     #endif
 }
 
-void DoorManager::try_close_door(Door & d)
+void DoorManager::on_closingTimer(DoorId const did)
+{
+    auto const it = m_open_doors.find(did);
+    if (it == m_open_doors.end() || it->second != m_closing_timers.now()) { return; }	// Stale timer
+
+    auto const d = m_doors.weak_get(did);
+    if (!d || !d->is_open())
+    {
+        m_open_doors.erase(it);		// Destroyed (or already closed) in the meantime
+    }
+    else if (try_close_door(*d))
+    {
+        m_open_doors.erase(it);
+    }
+    else
+    {
+        it->second = m_closing_timers.schedule(did, closing_delay);
+    }
+}
+
+bool DoorManager::try_close_door(Door & d)
 {
     auto const pos = d.position();
     auto const& tile = m_tiles->get_existent(pos);
@@ -129,7 +204,11 @@ void DoorManager::try_close_door(Door & d)
             PMdeb.add_impassableTile(pos);
             PMdeb.end_chapter();
         #endif
+
+        return true;
     }
+
+    return false;
 }
 
 
@@ -2,8 +2,13 @@
 #define GM_DOOR_MANAGER_HH
 
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "audio/audio_manager.hh"
 #include "data_strctures/data_array.hh"
+#include "data_strctures/timer_wheel.hh"
 #include "graphics/dynamic_subimage.hh"
 #include "graphics/dynamic_manager.hh"
 #include "map/map_forward_decl.hh"
@@ -26,12 +31,27 @@ class DoorManager
         DoorManager(DoorEventQueues & door_events, DataArray<Door> & doors, TileSet & tiles, DynamicManager & dynamic_manager, AudioManager & audio_manager) :
             m_door_events(&door_events), m_doors(doors), m_tiles(&tiles), m_dynamic_manager(dynamic_manager), m_audio_manager(audio_manager) {}
 
+        ////
+        //	Open the doors requested by the mobiles and try to close those whose timer expired in this update. A door is closed
+        //	closing_delay updates after being opened, or later if a mobile is still standing in it, so the closed doors cost nothing.
+        ////
         void update();
         auto create_door(Vector3i const& pos, bool const vertical) -> DoorId;
         void destroy_door(DoorId const did);
 
         bool is_vertical(DoorId const did);
 
+        auto door_count() const noexcept { return m_doors.count(); }
+        auto openDoor_count() const noexcept { return m_open_doors.size(); }
+
+        ////
+        //	During a transaction the changes to the doors are recorded in the undo log of their DataArray, while their sprites are
+        //	created and destroyed only by the commit, so nothing reaches the DynamicManager if the transaction is rolled back.
+        ////
+        void begin_transaction();
+        void commit_transaction();
+        void rollback_transaction();
+
     private:
         //TOOD: NOW: Perch m_door_events e m_tiles sono puntatori? Omologare l'uso di reference e pointer nei membri
         DoorEventQueues * m_door_events;
@@ -39,10 +59,29 @@ class DoorManager
         TileSet * m_tiles; 
         DynamicManager & m_dynamic_manager;
         AudioManager & m_audio_manager;
+
+        bool m_transaction = false;
+        std::vector<DoorId> m_pending_doors;			// Doors created during the transaction (they still don't have a sprite)
+        std::vector<SpriteId> m_pending_spriteRemovals;	// Sprites of the doors destroyed during the transaction
+
+        static constexpr TimerWheel<DoorId>::tick_type closing_delay = 120u;	// Updates between the opening of a door and the attempt to close it
+
+        TimerWheel<DoorId> m_closing_timers;
+        std::unordered_map<DoorId, TimerWheel<DoorId>::tick_type> m_open_doors;	// Open doors and the tick of their closing attempt.
+                                                                                // The timers not matching it (or of destroyed doors) are stale.
         
 
-        void open_door(Door & d);
-        void try_close_door(Door & d);
+        void open_door(DoorId const did, Door & d);
+
+        ////
+        //	@return: False if the door can't be closed because a mobile is standing in it.
+        ////
+        bool try_close_door(Door & d);
+
+        ////
+        //	Called when the closing timer of @did expires.
+        ////
+        void on_closingTimer(DoorId const did);
 
 
         static inline DynamicSubimage const horizontalClosed_subimage{ {   96.f,  0.f,			   192.f,  0.f },			  default_texture_dynamics };
@@ -18,15 +18,15 @@ namespace tgm
 
 
 
-GameMap::GameMap(unsigned const seed, DynamicManager & dynamic_manager, Camera & camera, 
+GameMap::GameMap(SimulationContext & context, unsigned const seed, DynamicManager & dynamic_manager, Camera & camera, 
                  TileGraphicsMediator & tg_mediator, RoofGraphicsMediator & rg_mediator, AudioManager & audio_manager, GuiEventQueues & gui_events) :
-    m_tiles(sim_settings.map.test_length, sim_settings.map.test_width, sim_settings.map.test_height, m_door_events),
-    m_random_generator(seed),
-    m_player_body{ 0.64f, {sim_settings.map.test_length / 2.f, sim_settings.map.test_width / 2.f}, sim_settings.map.ground_floor, MobileStyle::Warrior },
+    m_context{ context },
+    m_tiles(context.settings.map.test_length, context.settings.map.test_width, context.settings.map.test_height, context.settings.map.ground_floor),
+    m_player_body{ 0.64f, {context.settings.map.test_length / 2.f, context.settings.map.test_width / 2.f}, context.settings.map.ground_floor, MobileStyle::Warrior },
     player_manager{ m_input_events, m_player_body },
-    mobile_manager{m_mobile_events, m_player_body, m_npc_bodies, camera, dynamic_manager, m_tiles, m_buildings, m_door_events },
+    mobile_manager{context, m_mobile_events, m_player_body, m_npc_bodies, camera, dynamic_manager, m_tiles, m_buildings, m_door_events },
     door_manager{ m_door_events, m_doors, m_tiles, dynamic_manager, audio_manager },
-    m_building_manager{ m_random_generator, m_tiles, m_buildings, door_manager, tg_mediator, rg_mediator },
+    m_building_manager{ context, seed, m_tiles, m_buildings, door_manager, tg_mediator, rg_mediator },
     m_tgraphics_mediator{ tg_mediator },
     m_gui_events{ gui_events }
 {
@@ -105,7 +105,7 @@ void GameMap::update()
         auto & e = rcb_queue.front();
             
         auto const cb = debug_getBlock(e.cbid);
-        if (cb) { m_gui_events.push<OpenCityBlockGuiEv>(e.user_request, e.cbid, cb); }
+        if (cb) { push_guiEvent<OpenCityBlockGuiEv>(m_gui_events, e.user_request, e.cbid, cb); }
 
         rcb_queue.pop();
     }
@@ -118,7 +118,7 @@ void GameMap::update()
 #pragma warning(disable: 4702)
 void GameMap::debug_compareMoveAlgorithms() const
 {
-    g_log << "\n\n\n\nTrail algorithm comparison on the current map from the current position." << std::endl;
+    m_context.log << "\n\n\n\nTrail algorithm comparison on the current map from the current position." << std::endl;
 
     auto starting_pos = player_manager.debug_getPlayerPosition_inUnits();
     auto move_drc = m_player_body.get_moveDirection();
@@ -141,6 +141,8 @@ auto GameMap::write(flatbuffers::FlatBufferBuilder & fbb) const -> flatbuffers::
 void GameMap::read(tgmschema::GameMap const*const ms)
 {
     m_tiles.read(ms->tileset());
+    m_building_manager.reset_navigation();
+    m_building_manager.reset_outsideRegions();
     m_tgraphics_mediator.record_reset();
 }
 
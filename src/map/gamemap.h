@@ -23,6 +23,7 @@
 #include "map_graph.h"
 #include "map/buildings/building.hh"
 #include "map/buildings/building_manager.hh"
+#include "map/simulation_context.hh"
 #include "map/tiles/tile.hh"
 #include "map/tiles/tile_set.hh"
 #include "mediators/queues/door_ev.hh"
@@ -45,8 +46,9 @@ class GameMap
     public:
         ////
         //	Create an unitialized Map.
+        //	@context: State of this simulation (settings, log, statistics). It must outlive the map.
         ////
-        GameMap(unsigned seed, DynamicManager & dynamic_manager, Camera & camera, 
+        GameMap(SimulationContext & context, unsigned seed, DynamicManager & dynamic_manager, Camera & camera, 
                 TileGraphicsMediator & tgraphics_mediator, RoofGraphicsMediator & rg_mediator, AudioManager & audio_manager, GuiEventQueues & gui_events);
         ~GameMap();
     
@@ -54,17 +56,40 @@ class GameMap
         GameMap& operator=(const GameMap&) = delete;
 
 
+        ////
+        //	Send an input to the player. An input that doesn't fit in the full input queue is lost like a missed key press; the drops
+        //	are reported in input_eventStats().
+        ////
         template<typename T, typename ...Args>
-        void new_input(Args&& ...args) { m_input_events.push<T>(std::forward<Args>(args)...); }
+        void new_input(Args&& ...args) 
+        { 
+            if (!m_input_events.push<T>(std::forward<Args>(args)...)) { m_context.log << "The input queue is full: an input has been discarded.\n"; }
+        }
 
         template<typename T, typename ...Args>
         void new_mobileEvent(Args&& ...args) { m_mobile_events.push<T>(std::forward<Args>(args)...); }
 
         void update();
 
+        ////
+        //	Unbuild every building with at least a tile in @region (e.g. to reset a district of the scenario).
+        ////
+        void unbuild_region(IntParallelepiped const& region) { m_building_manager.unbuild_region(region); }
+
+        auto spawn_npc(MobileBody const& body) -> MobileId { return mobile_manager.spawn_npc(body); }
+        void despawn_npc(MobileId const id) { mobile_manager.despawn_npc(id); }
+        void set_npcMoveDirection(MobileId const id, Direction const drc) { mobile_manager.set_npcMoveDirection(id, drc); }
+
+        ////
+        //	@return: The waypoints leading from @from to @to (see MapGraph::find_path()).
+        ////
+        auto find_path(Vector3i const from, Vector3i const to) { return m_building_manager.navigation().find_path(from, to); }
+
     
 
         auto const& tiles() const { return m_tiles; }
+        auto simulation_context() noexcept -> SimulationContext & { return m_context; }
+        auto simulation_context() const noexcept -> SimulationContext const& { return m_context; }
         auto const& building_manager() const { return m_building_manager; }
         auto debug_get_buildings() -> DataArray<Building> const& { return m_building_manager.debug_get_buildings(); } //TODO: 99: Strano giro di passaggi. I buildings sono qui.
 
@@ -74,6 +99,8 @@ class GameMap
         void debug_remove_building(BuildingId const bid) { m_building_manager.unbuild_building(bid); };
         void debug_request_buildingExpansion(BuildingId const bid) { m_building_manager.request_buildingExpansion(bid); }
         void debug_expand_buildings() { m_building_manager.expand_buildings(); }
+        bool debug_expand_building(BuildingId const bid) { return m_building_manager.expand_building(bid, 0); }
+        auto debug_evaluate_buildingExpansion(BuildingId const bid) -> std::optional<ExpansionEvaluation> { return m_building_manager.evaluate_buildingExpansion(bid); }
         void debug_expand_random_building() { m_building_manager.debug_expand_random_building(); }
         auto debug_buildBuilding_inNearestCity(BuildingRecipe const& recipe) -> std::optional<BuildingId> 
         { 
@@ -87,9 +114,18 @@ class GameMap
 
         auto debug_getPlayerManager() const noexcept -> PlayerManager const& { return player_manager; }
 
+        ////
+        //	Fill level and discarded events of the door-opening and of the player-movement queues.
+        ////
+        auto door_eventStats() const noexcept -> EventQueueStats { return m_door_events.stats<TryOpenDoorEv>(); }
+        auto input_eventStats() const noexcept -> EventQueueStats { return m_input_events.stats<PlayerMovementEv>(); }
+
         void debug_compareMoveAlgorithms() const;
 
-        void debug_interactWithAllDoors() { m_door_events.push<DebugInteractWithAllDoorsEv>(); }
+        void debug_interactWithAllDoors() 
+        { 
+            if (!m_door_events.push<DebugInteractWithAllDoorsEv>()) { m_context.log << "The door queue is full: the interaction has been discarded.\n"; }
+        }
 
         //TODO: 01: This function should be refactored in order to insert it in the BuildingAlgorithm, assigning to each border the proper 
         //		   BuildingAreaId, BuildingId, CityBlockId, CityId
@@ -128,12 +164,11 @@ class GameMap
 
 
     private:
-
-        std::mt19937 m_random_generator;
+        SimulationContext & m_context;
 
         TileSet m_tiles;
     
-        DataArray<Building> m_buildings{ sim_settings.map.max_buildingCount };
+        DataArray<Building> m_buildings{ m_context.settings.map.max_buildingCount };
 
         DoorEventQueues m_door_events;
 
@@ -143,7 +178,7 @@ class GameMap
         MobileEventQueues m_mobile_events;
 
         MobileBody m_player_body; //physics and style
-        DataArray<MobileBody> m_npc_bodies{ sim_settings.map.max_npcCount };
+        DataArray<MobileBody> m_npc_bodies{ m_context.settings.map.max_npcCount };
 
 
         // Initialized in constructor because they requires external parameters
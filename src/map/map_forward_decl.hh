@@ -52,6 +52,16 @@ using RoofId = DataArrayId;
 ////
 using DoorId = DataArrayId;
 
+////
+// Uniquely identifies a NPC in the map. 0 is reserved for empty values. 
+////
+using MobileId = DataArrayId;
+
+////
+// The player body isn't stored with the NPCs, so it's identified by the only id no NPC can have.
+////
+inline constexpr MobileId player_mobileId = 0;
+
 
 
 ////
@@ -0,0 +1,758 @@
+#include "map_graph.h"
+
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+
+
+namespace tgm
+{
+
+
+
+static auto waypoint_distance(Vector3i const a, Vector3i const b) noexcept -> float
+{
+    auto const dx = static_cast<float>(a.x - b.x);
+    auto const dy = static_cast<float>(a.y - b.y);
+    auto const dz = static_cast<float>(a.z - b.z);
+
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+
+
+MapGraph::MapGraph(TileSet const& tiles, int const cluster_dim) :
+    m_tiles{ tiles },
+    m_cluster_dim{ cluster_dim }
+{
+    // Each square has at most cluster_dim^2 / 2 + 1 clusters, which must fit in m_tile_parts.
+    if (cluster_dim <= 0 || cluster_dim > 255) { throw std::runtime_error("The side of the squares of the MapGraph must be between 1 and 255."); }
+
+    reset();
+}
+
+void MapGraph::reset()
+{
+    m_areas.clear();
+    m_doors.clear();
+    m_square_doors.clear();
+
+    m_squares_x = (m_tiles.length() + m_cluster_dim - 1) / m_cluster_dim;
+    m_squares_y = (m_tiles.width() + m_cluster_dim - 1) / m_cluster_dim;
+
+    auto const square_count = static_cast<std::size_t>(m_squares_x) * m_squares_y * m_tiles.height();
+    m_squares.assign(square_count, {});
+    m_tile_parts.assign(static_cast<std::size_t>(m_tiles.length()) * m_tiles.width() * m_tiles.height(), 0u);
+
+    for (auto sq = std::uint64_t{ 0u }; sq < square_count; ++sq)
+    {
+        update_squareClusters(sq);
+    }
+    for (auto sq = std::uint64_t{ 0u }; sq < square_count; ++sq)
+    {
+        update_squareLinks(sq);
+    }
+
+    //--- Gather the areas and the doors in the tiles. The areas are added first, so that each door is linked to the areas on its sides.
+    auto area_bounds = std::unordered_map<BuildingAreaCompleteId, std::pair<Vector3i, Vector3i>>{};	// (min, max) corners of the borders
+    auto doors = std::vector<std::pair<DoorId, Vector3i>>{};
+
+    for (auto z = 0; z < m_tiles.height(); ++z)
+    {
+        for (auto y = 0; y < m_tiles.width(); ++y)
+        {
+            for (auto x = 0; x < m_tiles.length(); ++x)
+            {
+                auto const& t = m_tiles.get_existent(x, y, z);
+                if (!t.is_border()) { continue; }
+
+                if (t.is_door()) { doors.emplace_back(t.furniture_id(), Vector3i{ x, y, z }); }
+
+                for (auto const& info : t.get_borderInfos())
+                {
+                    if (info.is_empty()) { continue; }
+
+                    auto const [it, inserted] = area_bounds.try_emplace(info.acid(), Vector3i{ x, y, z }, Vector3i{ x, y, z });
+                    if (!inserted)
+                    {
+                        auto & [min, max] = it->second;
+                        min = { std::min(min.x, x), std::min(min.y, y), z };
+                        max = { std::max(max.x, x), std::max(max.y, y), z };
+                    }
+                }
+            }
+        }
+    }
+
+    for (auto const& [acid, bounds] : area_bounds)
+    {
+        auto const& [min, max] = bounds;
+        m_areas[acid] = AreaNode{ IntParallelepiped{ min.x, min.y, min.z, max.x - min.x + 1, max.y - min.y + 1, 1 }, {} };
+    }
+
+    for (auto const& [did, pos] : doors)
+    {
+        add_door(did, pos);
+    }
+
+    invalidate_cache();
+}
+
+
+void MapGraph::add_area(BuildingAreaCompleteId const acid, IntParallelepiped const& volume)
+{
+    m_areas[acid] = AreaNode{ volume, {} };
+
+    // A new node can shorten the path between any two nodes, also between those whose cached path is far from it
+    invalidate_cache();
+}
+
+void MapGraph::remove_area(BuildingAreaCompleteId const acid)
+{
+    m_areas.erase(acid);
+
+    invalidate_pathsCrossing(MapGraphNodeId{ MapGraphNodeType::area, acid.bid, acid.aid });
+}
+
+
+void MapGraph::add_door(DoorId const did, Vector3i const pos)
+{
+    auto & door = m_doors[did];
+    door.pos = pos;
+    door.links.clear();
+
+    for (auto const& info : m_tiles.get_existent(pos).get_borderInfos())
+    {
+        if (info.is_empty()) { continue; }
+
+        door.links.push_back({ MapGraphNodeType::area, info.bid(), info.aid() });
+
+        if (auto const it = m_areas.find(info.acid()); it != m_areas.end())
+        {
+            it->second.doors.push_back(did);
+        }
+    }
+
+    link_doorClusters(did, door, std::nullopt);
+
+    // A new door can shorten the path between any two nodes, also between those whose cached path is far from it
+    invalidate_cache();
+}
+
+void MapGraph::remove_door(DoorId const did)
+{
+    auto const it = m_doors.find(did);
+    if (it == m_doors.end()) { return; }
+
+    for (auto const& node : it->second.links)
+    {
+        auto * doors = static_cast<std::vector<DoorId> *>(nullptr);
+
+        if (node.type == MapGraphNodeType::area)
+        {
+            if (auto const a = m_areas.find({ node.first, node.second }); a != m_areas.end()) { doors = &a->second.doors; }
+        }
+        else if (auto const sq = m_square_doors.find(node.first); sq != m_square_doors.end())
+        {
+            doors = &sq->second;
+        }
+
+        if (doors)
+        {
+            doors->erase(std::remove(doors->begin(), doors->end(), did), doors->end());
+        }
+    }
+
+    m_doors.erase(it);
+
+    invalidate_pathsCrossing(MapGraphNodeId{ MapGraphNodeType::door, did, 0u });
+}
+
+
+void MapGraph::update_outdoor(IntParallelepiped const& volume)
+{
+    //The tiles just outside the volume belong to the squares whose clusters could have been joined or split.
+    auto const first_sx = std::max(0, (volume.behind - 1) / m_cluster_dim);
+    auto const last_sx  = std::min(m_squares_x - 1, (volume.front() + 1) / m_cluster_dim);
+    auto const first_sy = std::max(0, (volume.left - 1) / m_cluster_dim);
+    auto const last_sy  = std::min(m_squares_y - 1, (volume.right() + 1) / m_cluster_dim);
+    auto const first_z  = std::max(0, volume.down);
+    auto const last_z   = std::min(m_tiles.height() - 1, volume.up());
+
+    if (first_z > last_z) { return; }
+
+    // A tile that became outdoor can open a shortcut between any two nodes. Otherwise the routes can only get longer, and only the
+    // paths crossing the renumbered clusters are affected.
+    auto opened = false;
+    for (auto z = first_z; z <= last_z && !opened; ++z)
+    {
+        for (auto x = std::max(0, volume.behind); x <= std::min(m_tiles.length() - 1, volume.front()) && !opened; ++x)
+        {
+            for (auto y = std::max(0, volume.left); y <= std::min(m_tiles.width() - 1, volume.right()); ++y)
+            {
+                if (m_tile_parts[tile_index(x, y, z)] == 0u && is_outdoor(x, y, z)) { opened = true; break; }
+            }
+        }
+    }
+
+    auto const square_at = [this](int const z, int const sx, int const sy) { return (static_cast<std::uint64_t>(z) * m_squares_x + sx) * m_squares_y + sy; };
+
+    for (auto z = first_z; z <= last_z; ++z)
+    {
+        for (auto sx = first_sx; sx <= last_sx; ++sx)
+        {
+            for (auto sy = first_sy; sy <= last_sy; ++sy)
+            {
+                update_squareClusters(square_at(z, sx, sy));
+            }
+        }
+
+        // The squares behind and on the left link to the clusters just relabelled
+        for (auto sx = std::max(0, first_sx - 1); sx <= last_sx; ++sx)
+        {
+            for (auto sy = std::max(0, first_sy - 1); sy <= last_sy; ++sy)
+            {
+                update_squareLinks(square_at(z, sx, sy));
+            }
+        }
+
+        for (auto sx = first_sx; sx <= last_sx; ++sx)
+        {
+            for (auto sy = first_sy; sy <= last_sy; ++sy)
+            {
+                relink_squareDoors(square_at(z, sx, sy));
+            }
+        }
+    }
+
+    if (opened)
+    {
+        invalidate_cache();
+        return;
+    }
+
+    // The clusters of the updated squares were renumbered, so every path crossing them is dropped
+    invalidate_paths([&](MapGraphNodeId const& node)
+        {
+            if (node.type != MapGraphNodeType::cluster) { return false; }
+
+            auto const sq = square_coordinates(node.first);
+            return sq.z >= first_z && sq.z <= last_z && sq.x >= first_sx && sq.x <= last_sx && sq.y >= first_sy && sq.y <= last_sy;
+        });
+}
+
+
+auto MapGraph::find_path(Vector3i const from, Vector3i const to) -> std::optional<std::vector<Vector3i>>
+{
+    auto const from_node = locate(from);
+    auto const to_node = locate(to);
+
+    if (!from_node || !to_node) { return std::nullopt; }
+
+    auto path = std::vector<Vector3i>{};
+
+    if (*from_node != *to_node)
+    {
+        auto const key = std::make_pair(*from_node, *to_node);
+
+        if (auto const it = m_cache_index.find(key); it != m_cache_index.end())
+        {
+            m_cache.splice(m_cache.begin(), m_cache, it->second);
+            path = it->second->second.waypoints;
+        }
+        else
+        {
+            auto found = search(*from_node, *to_node);
+            if (!found) { return std::nullopt; }
+
+            if (m_cache.size() == max_cachedPaths)
+            {
+                m_cache_index.erase(m_cache.back().first);
+                m_cache.pop_back();
+            }
+            path = found->waypoints;
+
+            m_cache.emplace_front(key, std::move(*found));
+            m_cache_index.emplace(key, m_cache.begin());
+        }
+    }
+
+    if (path.empty() || path.back() != to)
+    {
+        path.push_back(to);
+    }
+
+    return path;
+}
+
+
+auto MapGraph::locate(Vector3i const pos) const -> std::optional<MapGraphNodeId>
+{
+    auto const t = m_tiles.get(pos);
+    if (!t) { return std::nullopt; }
+
+    if (t->is_door())
+    {
+        return MapGraphNodeId{ MapGraphNodeType::door, t->furniture_id(), 0u };
+    }
+    if (t->is_innerArea())
+    {
+        auto const info = t->get_innerAreaInfo();
+        return MapGraphNodeId{ MapGraphNodeType::area, info.bid(), info.aid() };
+    }
+    if (!t->is_built() && m_tile_parts[tile_index(pos.x, pos.y, pos.z)] > 0u)
+    {
+        return cluster_of(pos);
+    }
+
+    return std::nullopt;
+}
+
+
+bool MapGraph::is_pathCached(Vector3i const from, Vector3i const to) const
+{
+    auto const from_node = locate(from);
+    auto const to_node = locate(to);
+
+    return from_node && to_node && m_cache_index.count({ *from_node, *to_node }) > 0u;
+}
+
+
+void MapGraph::invalidate_cache() noexcept
+{
+    m_cache.clear();
+    m_cache_index.clear();
+}
+
+template <typename P>
+void MapGraph::invalidate_paths(P && is_changed)
+{
+    for (auto it = m_cache.begin(); it != m_cache.end(); )
+    {
+        auto const& nodes = it->second.nodes;
+
+        if (std::any_of(nodes.cbegin(), nodes.cend(), is_changed))
+        {
+            m_cache_index.erase(it->first);
+            it = m_cache.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void MapGraph::invalidate_pathsCrossing(MapGraphNodeId const& node)
+{
+    invalidate_paths([&node](MapGraphNodeId const& n) { return n == node; });
+}
+
+
+auto MapGraph::square_of(Vector3i const pos) const noexcept -> std::uint64_t
+{
+    return (static_cast<std::uint64_t>(pos.z) * m_squares_x + pos.x / m_cluster_dim) * m_squares_y + pos.y / m_cluster_dim;
+}
+
+auto MapGraph::square_coordinates(std::uint64_t const square) const noexcept -> Vector3i
+{
+    auto const per_floor = static_cast<std::uint64_t>(m_squares_x) * m_squares_y;
+    auto const in_floor = square % per_floor;
+
+    return { static_cast<int>(in_floor / m_squares_y), static_cast<int>(in_floor % m_squares_y), static_cast<int>(square / per_floor) };
+}
+
+auto MapGraph::cluster_of(Vector3i const pos) const noexcept -> MapGraphNodeId
+{
+    return { MapGraphNodeType::cluster, square_of(pos), m_tile_parts[tile_index(pos.x, pos.y, pos.z)] - 1u };
+}
+
+
+bool MapGraph::is_outdoor(int const x, int const y, int const z) const noexcept
+{
+    auto const t = m_tiles.get(x, y, z);
+
+    return t && !t->is_built();
+}
+
+
+void MapGraph::update_squareClusters(std::uint64_t const square)
+{
+    auto const sq = square_coordinates(square);
+    auto const x_begin = sq.x * m_cluster_dim;
+    auto const y_begin = sq.y * m_cluster_dim;
+    auto const x_end = std::min(x_begin + m_cluster_dim, m_tiles.length());
+    auto const y_end = std::min(y_begin + m_cluster_dim, m_tiles.width());
+    auto const center = Vector3i{ (x_begin + x_end) / 2, (y_begin + y_end) / 2, sq.z };
+
+    auto & parts = m_squares[square].parts;
+    parts.clear();
+
+    for (auto x = x_begin; x < x_end; ++x)
+    {
+        for (auto y = y_begin; y < y_end; ++y)
+        {
+            m_tile_parts[tile_index(x, y, sq.z)] = 0u;
+        }
+    }
+
+    for (auto x = x_begin; x < x_end; ++x)
+    {
+        for (auto y = y_begin; y < y_end; ++y)
+        {
+            if (m_tile_parts[tile_index(x, y, sq.z)] != 0u || !is_outdoor(x, y, sq.z)) { continue; }
+
+            //--- Flood fill a new cluster, without leaving the square
+            auto const label = static_cast<std::uint16_t>(parts.size() + 1u);
+            auto nearest = Vector3i{ x, y, sq.z };
+
+            m_tile_parts[tile_index(x, y, sq.z)] = label;
+            m_fill_stack.assign(1u, tile_index(x, y, sq.z));
+
+            while (!m_fill_stack.empty())
+            {
+                auto const i = m_fill_stack.back();
+                m_fill_stack.pop_back();
+
+                auto const rem = i % (static_cast<std::size_t>(m_tiles.length()) * m_tiles.width());
+                auto const p = Vector3i{ static_cast<int>(rem / m_tiles.width()), static_cast<int>(rem % m_tiles.width()), sq.z };
+
+                if (waypoint_distance(p, center) < waypoint_distance(nearest, center)) { nearest = p; }
+
+                Vector3i const sides[] = { { p.x - 1, p.y, p.z }, { p.x + 1, p.y, p.z }, { p.x, p.y - 1, p.z }, { p.x, p.y + 1, p.z } };
+                for (auto const& side : sides)
+                {
+                    if (side.x < x_begin || side.x >= x_end || side.y < y_begin || side.y >= y_end) { continue; }
+
+                    auto const j = tile_index(side.x, side.y, side.z);
+                    if (m_tile_parts[j] == 0u && is_outdoor(side.x, side.y, side.z))
+                    {
+                        m_tile_parts[j] = label;
+                        m_fill_stack.push_back(j);
+                    }
+                }
+            }
+
+            parts.push_back(nearest);
+        }
+    }
+}
+
+
+void MapGraph::update_squareLinks(std::uint64_t const square)
+{
+    auto const sq = square_coordinates(square);
+    auto const x_begin = sq.x * m_cluster_dim;
+    auto const y_begin = sq.y * m_cluster_dim;
+    auto const x_end = std::min(x_begin + m_cluster_dim, m_tiles.length());
+    auto const y_end = std::min(y_begin + m_cluster_dim, m_tiles.width());
+
+    //Each run of open tiles along the boundary links a cluster of this square to one of the next square (the tiles of a run are adjacent
+    //on both sides). If many runs link the same clusters, the longest one is kept.
+    //@tiles_at(i): The facing tiles (this square, next square) in the position @i along the boundary.
+    auto const link_boundary = [this, z = sq.z](int const begin, int const end, auto const& tiles_at, std::vector<ClusterLink> & links)
+    {
+        links.clear();
+        auto lengths = std::vector<int>{};
+
+        auto const is_open = [&](int const i) 
+        { 
+            auto const [inner, outer] = tiles_at(i);
+            return is_outdoor(inner.x, inner.y, z) && is_outdoor(outer.x, outer.y, z); 
+        };
+
+        for (auto i = begin; i < end; )
+        {
+            if (!is_open(i)) { ++i; continue; }
+
+            auto const run_begin = i;
+            while (i < end && is_open(i)) { ++i; }
+
+            auto const [inner, outer] = tiles_at(run_begin);
+            auto const link = ClusterLink{ static_cast<std::uint16_t>(cluster_of(inner).second), static_cast<std::uint16_t>(cluster_of(outer).second),
+                                           run_begin + (i - run_begin) / 2 };
+
+            auto const same = std::find_if(links.begin(), links.end(), [&link](ClusterLink const& l) { return l.part == link.part && l.next_part == link.next_part; });
+            if (same == links.end())
+            {
+                links.push_back(link);
+                lengths.push_back(i - run_begin);
+            }
+            else if (auto & length = lengths[same - links.begin()]; i - run_begin > length)
+            {
+                *same = link;
+                length = i - run_begin;
+            }
+        }
+    };
+
+    auto & s = m_squares[square];
+
+    if (sq.x + 1 < m_squares_x)
+    {
+        link_boundary(y_begin, y_end, [&](int const y) { return std::make_pair(Vector3i{ x_end - 1, y, sq.z }, Vector3i{ x_end, y, sq.z }); }, s.front_links);
+    }
+    else
+    {
+        s.front_links.clear();
+    }
+
+    if (sq.y + 1 < m_squares_y)
+    {
+        link_boundary(x_begin, x_end, [&](int const x) { return std::make_pair(Vector3i{ x, y_end - 1, sq.z }, Vector3i{ x, y_end, sq.z }); }, s.right_links);
+    }
+    else
+    {
+        s.right_links.clear();
+    }
+}
+
+
+void MapGraph::relink_squareDoors(std::uint64_t const square)
+{
+    auto const sq = square_coordinates(square);
+    auto const x_begin = sq.x * m_cluster_dim;
+    auto const y_begin = sq.y * m_cluster_dim;
+    auto const x_end = std::min(x_begin + m_cluster_dim, m_tiles.length());
+    auto const y_end = std::min(y_begin + m_cluster_dim, m_tiles.width());
+
+    //The doors already linked to the square, and those on the tiles in it or around it (their sides could have just become outdoor)
+    auto dids = std::vector<DoorId>{};
+    if (auto const it = m_square_doors.find(square); it != m_square_doors.end())
+    {
+        dids.swap(it->second);
+    }
+
+    for (auto x = x_begin - 1; x <= x_end; ++x)
+    {
+        for (auto y = y_begin - 1; y <= y_end; ++y)
+        {
+            auto const t = m_tiles.get(x, y, sq.z);
+            if (!t || !t->is_door()) { continue; }
+
+            auto const did = static_cast<DoorId>(t->furniture_id());
+            if (m_doors.count(did) && std::find(dids.cbegin(), dids.cend(), did) == dids.cend()) { dids.push_back(did); }
+        }
+    }
+
+    for (auto const did : dids)
+    {
+        auto & door = m_doors.at(did);
+
+        door.links.erase(std::remove_if(door.links.begin(), door.links.end(), [square](MapGraphNodeId const& n) 
+                                        { return n.type == MapGraphNodeType::cluster && n.first == square; }), 
+                         door.links.end());
+
+        link_doorClusters(did, door, square);
+    }
+}
+
+
+void MapGraph::link_doorClusters(DoorId const did, DoorNode & door, std::optional<std::uint64_t> const only_square)
+{
+    auto const pos = door.pos;
+
+    Vector3i const sides[] = { { pos.x - 1, pos.y, pos.z }, { pos.x + 1, pos.y, pos.z }, { pos.x, pos.y - 1, pos.z }, { pos.x, pos.y + 1, pos.z } };
+    for (auto const& side : sides)
+    {
+        if (!is_outdoor(side.x, side.y, side.z)) { continue; }
+
+        auto const node = cluster_of(side);
+        if (only_square && node.first != *only_square) { continue; }
+
+        if (std::find(door.links.cbegin(), door.links.cend(), node) == door.links.cend())
+        {
+            door.links.push_back(node);
+
+            auto & doors = m_square_doors[node.first];
+            if (std::find(doors.cbegin(), doors.cend(), did) == doors.cend()) { doors.push_back(did); }
+        }
+    }
+}
+
+
+auto MapGraph::node_position(MapGraphNodeId const& node) const -> Vector3i
+{
+    switch (node.type)
+    {
+        case MapGraphNodeType::area:
+        {
+            auto const& volume = m_areas.at({ node.first, node.second }).volume;
+            return { volume.behind + volume.length / 2, volume.left + volume.width / 2, volume.down };
+        }
+        case MapGraphNodeType::door:
+            return m_doors.at(node.first).pos;
+
+        case MapGraphNodeType::cluster:
+            return m_squares.at(node.first).parts.at(node.second);
+    }
+
+    throw std::runtime_error("Unknown MapGraph node type.");
+}
+
+
+template <typename F>
+void MapGraph::for_each_neighbor(MapGraphNodeId const& node, F && f) const
+{
+    switch (node.type)
+    {
+        case MapGraphNodeType::area:
+        {
+            if (auto const it = m_areas.find({ node.first, node.second }); it != m_areas.end())
+            {
+                for (auto const did : it->second.doors)
+                {
+                    if (auto const d = m_doors.find(did); d != m_doors.end())
+                    {
+                        f(MapGraphNodeId{ MapGraphNodeType::door, did, 0u }, d->second.pos);
+                    }
+                }
+            }
+            break;
+        }
+        case MapGraphNodeType::door:
+        {
+            if (auto const it = m_doors.find(node.first); it != m_doors.end())
+            {
+                for (auto const& linked : it->second.links)
+                {
+                    //An area removed after the door was built can't be entered anymore.
+                    if (linked.type == MapGraphNodeType::area && !m_areas.count({ linked.first, linked.second })) { continue; }
+
+                    f(linked, it->second.pos);
+                }
+            }
+            break;
+        }
+        case MapGraphNodeType::cluster:
+        {
+            auto const sq = square_coordinates(node.first);
+            auto const x_end = std::min((sq.x + 1) * m_cluster_dim, m_tiles.length());
+            auto const y_end = std::min((sq.y + 1) * m_cluster_dim, m_tiles.width());
+            auto const cluster_node = [](std::uint64_t const square, std::uint16_t const part) { return MapGraphNodeId{ MapGraphNodeType::cluster, square, part }; };
+
+            for (auto const& link : m_squares[node.first].front_links)
+            {
+                if (link.part == node.second) { f(cluster_node(node.first + m_squares_y, link.next_part), Vector3i{ x_end, link.entrance, sq.z }); }
+            }
+            for (auto const& link : m_squares[node.first].right_links)
+            {
+                if (link.part == node.second) { f(cluster_node(node.first + 1u, link.next_part), Vector3i{ link.entrance, y_end, sq.z }); }
+            }
+            if (sq.x > 0)
+            {
+                auto const behind = node.first - m_squares_y;
+                for (auto const& link : m_squares[behind].front_links)
+                {
+                    if (link.next_part == node.second) { f(cluster_node(behind, link.part), Vector3i{ sq.x * m_cluster_dim - 1, link.entrance, sq.z }); }
+                }
+            }
+            if (sq.y > 0)
+            {
+                auto const left = node.first - 1u;
+                for (auto const& link : m_squares[left].right_links)
+                {
+                    if (link.next_part == node.second) { f(cluster_node(left, link.part), Vector3i{ link.entrance, sq.y * m_cluster_dim - 1, sq.z }); }
+                }
+            }
+
+            if (auto const it = m_square_doors.find(node.first); it != m_square_doors.end())
+            {
+                for (auto const did : it->second)
+                {
+                    auto const& door = m_doors.at(did);
+                    if (std::find(door.links.cbegin(), door.links.cend(), node) != door.links.cend())
+                    {
+                        f(MapGraphNodeId{ MapGraphNodeType::door, did, 0u }, door.pos);
+                    }
+                }
+            }
+            break;
+        }
+    }
+}
+
+
+auto MapGraph::search(MapGraphNodeId const& from, MapGraphNodeId const& to) const -> std::optional<CachedPath>
+{
+    //A* over the abstract nodes. The cost of an edge is the distance between the tile where its source node was entered and its waypoint,
+    //so the cost of a path is the length of the polyline of its waypoints. The representative positions of @from and @to are used (instead
+    //of the positions of the query), so that the result can be cached for every query between the two nodes.
+    struct Visit
+    {
+        float cost;
+        Vector3i entry;
+        MapGraphNodeId parent;
+        bool closed;
+    };
+    using QueueEntry = std::tuple<float, std::uint64_t, MapGraphNodeId>;	//(estimated cost, insertion order, node)
+
+    auto const goal = node_position(to);
+    auto const later = [](QueueEntry const& lhs, QueueEntry const& rhs)
+    {
+        return std::get<0>(lhs) > std::get<0>(rhs) || (std::get<0>(lhs) == std::get<0>(rhs) && std::get<1>(lhs) > std::get<1>(rhs));
+    };
+
+    auto visits = std::unordered_map<MapGraphNodeId, Visit, NodeHash>{};
+    auto frontier = std::priority_queue<QueueEntry, std::vector<QueueEntry>, decltype(later)>{ later };
+    auto pushed = std::uint64_t{ 0u };
+
+    auto const start = node_position(from);
+    visits[from] = { 0.f, start, from, false };
+    frontier.emplace(waypoint_distance(start, goal), pushed++, from);
+
+    while (!frontier.empty())
+    {
+        auto const node = std::get<2>(frontier.top());
+        frontier.pop();
+
+        auto & visit = visits.at(node);
+        if (visit.closed) { continue; }
+        visit.closed = true;
+
+        if (node == to)
+        {
+            auto path = CachedPath{};
+            for (auto n = to; n != from; n = visits.at(n).parent)
+            {
+                auto const& entry = visits.at(n).entry;
+                if (path.waypoints.empty() || path.waypoints.back() != entry) { path.waypoints.push_back(entry); }
+
+                path.nodes.push_back(n);
+            }
+            path.nodes.push_back(from);
+
+            std::reverse(path.waypoints.begin(), path.waypoints.end());
+            std::reverse(path.nodes.begin(), path.nodes.end());
+
+            return path;
+        }
+
+        auto const cost = visit.cost;
+        auto const entry = visit.entry;
+
+        for_each_neighbor(node, [&](MapGraphNodeId const& neighbor, Vector3i const waypoint)
+        {
+            auto const new_cost = cost + waypoint_distance(entry, waypoint);
+            auto const [it, inserted] = visits.try_emplace(neighbor, Visit{ new_cost, waypoint, node, false });
+
+            if (!inserted)
+            {
+                if (it->second.closed || it->second.cost <= new_cost) { return; }
+                it->second = { new_cost, waypoint, node, false };
+            }
+
+            frontier.emplace(new_cost + waypoint_distance(waypoint, goal), pushed++, neighbor);
+        });
+    }
+
+    return std::nullopt;
+}
+
+
+
+} // namespace tgm
\ No newline at end of file
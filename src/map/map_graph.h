@@ -1,71 +1,243 @@
 #ifndef GM_MAP_GRAPH_H
 #define GM_MAP_GRAPH_H
 
-#include <vector>
-#include <unordered_set>
+
+#include <cstdint>
+#include <list>
+#include <optional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "std_extensions/hash_functions.hh"
-#include "map_forward_decl.hh"
+#include "map/map_forward_decl.hh"
+#include "map/tiles/tile_set.hh"
+#include "system/parallelepiped.hh"
 
 
-//TODO: 02: Completely wrong with 64bit BuildingId
-//struct HashBuildingInfos
-//{
-//	auto operator()(std::pair<OldBuildingId, OldBuildingAreaId> const& p) const -> std::size_t
-//	{
-//		int a = p.first;
-//		int b = p.second;
-//
-//		std::size_t seed = 0;
-//
-//		seed ^= std::hash<int>{}(a)  + 0x9e3779b9 + (seed << 6) + (seed >> 2);  //same as boost::hash_combine()
-//		seed ^= std::hash<int>{}(b) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-//
-//		return seed;
-//	}
-//};
-
-//struct NodeConnectionInfo
-//{
-//	std::unordered_set<std::pair<OldBuildingId, OldBuildingAreaId>, HashBuildingInfos> edges;
-//	DoorId did = 0;
-//
-//	void add_edge_to(OldBuildingId bid, OldBuildingAreaId aid, DoorId did_)
-//	{
-//		auto[iter, already_existent] = edges.insert({ bid, aid });
-//		if (already_existent)
-//			throw std::runtime_error("The connection was already added.");
-//		did = did_;
-//	}
-//};
-//
-//class MapGraph
-//{
-//	public:
-//		void add_connection(OldBuildingId bid1, OldBuildingAreaId aid1, OldBuildingId bid2, OldBuildingAreaId aid2, DoorId did) 
-//		{
-//			{
-//				auto[it, ex] = connections.insert({ { bid1, aid1 }, {} });
-//				it->second.add_edge_to(bid2, aid2, did);
-//			}
-//			{
-//				auto[it, ex] = connections.insert({ { bid2, aid2 }, {} });
-//				it->second.add_edge_to(bid1, aid1, did);
-//			}
-//		}
-//		void remove_connection(OldBuildingId bid1, OldBuildingAreaId aid1, OldBuildingId bid2, OldBuildingAreaId aid2)
-//		{
-//
-//		}
+namespace tgm
+{
+
+
+
+enum class MapGraphNodeType : std::uint8_t
+{
+    area,		// BuildingArea (first: BuildingId, second: BuildingAreaId)
+    door,		// Door (first: DoorId)
+    cluster,	// Connected part of the outdoor tiles of a square (first: index of the square, second: index of the part)
+};
+
+struct MapGraphNodeId
+{
+    MapGraphNodeType type = MapGraphNodeType::cluster;
+    std::uint64_t first = 0u;
+    std::uint64_t second = 0u;
+};
+inline bool operator==(MapGraphNodeId const lhs, MapGraphNodeId const rhs) { return lhs.type == rhs.type && lhs.first == rhs.first && lhs.second == rhs.second; }
+inline bool operator!=(MapGraphNodeId const lhs, MapGraphNodeId const rhs) { return !(lhs == rhs); }
+
+
+
+////
 //
-//	private:
+//	Hierarchical navigation graph of the map, used to route the NPCs without running a tile-level search over the whole map.
+//	The abstract nodes are the areas of the buildings, their doors and the clusters of outdoor tiles: each floor is split in squares, and
+//	the outdoor tiles of a square are split in its connected parts (found with a flood fill), so that a cluster can always be crossed
+//	without leaving it. A door links the areas on its sides (or its area and the clusters of the outdoor tiles next to it), two clusters
+//	of adjacent squares are linked by each run of facing outdoor tiles across the boundary (the longest run, if many link them).
+//	The graph is updated incrementally when an area or a door is built or unbuilt. The paths found for the most recent origin/destination
+//	nodes are cached. A change that can only lengthen the routes (a removal, or outdoor tiles getting built) drops only the cached paths
+//	crossing one of the nodes it touched, while an addition (that could open a shortcut anywhere) drops them all.
+//	It isn't thread-safe, since a query can update the cache.
 //
-//		std::unordered_map<std::pair<OldBuildingId, OldBuildingAreaId>, 
-//						   NodeConnectionInfo,
-//						   HashBuildingInfos> connections;
-//};
+////
+class MapGraph
+{
+    public:
+        static constexpr std::size_t max_cachedPaths = 512u;	// Paths kept in the cache of the most recent queries
+
+        ////
+        //	@cluster_dim: Side of the squares of the outdoor clusters (in tiles, at most 255).
+        ////
+        MapGraph(TileSet const& tiles, int const cluster_dim);
+
+        ////
+        //	Build the whole graph from scratch from the TileSet (e.g. after it was read): the areas (whose volume is the bounding box of 
+        //	their border tiles), the doors and the links of all the clusters.
+        ////
+        void reset();
+
+        void add_area(BuildingAreaCompleteId const acid, IntParallelepiped const& volume);
+        void remove_area(BuildingAreaCompleteId const acid);
+
+        ////
+        //	Link the door built in @pos to the areas and to the outdoor clusters on its sides, as they are in the TileSet.
+        ////
+        void add_door(DoorId const did, Vector3i const pos);
+        void remove_door(DoorId const did);
+
+        ////
+        //	Split again in clusters the squares that could have been affected by a change of the tiles in @volume, and update their links
+        //	(to the nearby squares and to the doors).
+        ////
+        void update_outdoor(IntParallelepiped const& volume);
+
+        ////
+        //	@return: The waypoints from @from to @to (both in tiles -- map reference system): the doors to cross and the tiles where the
+        //			 boundaries of the clusters are crossed, followed by @to. Nothing if @to can't be reached (or if any of the two
+        //			 positions is a wall). The path between two consecutive waypoints has to be walked by the tile-level movement.
+        ////
+        auto find_path(Vector3i const from, Vector3i const to) -> std::optional<std::vector<Vector3i>>;
+
+        ////
+        //	@return: The abstract node hosting the tile in @pos, or nothing if the tile is a wall or doesn't exist.
+        ////
+        auto locate(Vector3i const pos) const -> std::optional<MapGraphNodeId>;
+
+        auto area_count() const noexcept { return m_areas.size(); }
+        auto door_count() const noexcept { return m_doors.size(); }
+        auto square_count() const noexcept { return m_squares.size(); }
+        auto cachedPath_count() const noexcept { return m_cache.size(); }
+
+        ////
+        //	@return: True if the path between the nodes hosting @from and @to is cached.
+        ////
+        bool is_pathCached(Vector3i const from, Vector3i const to) const;
+
+    private:
+        struct NodeHash
+        {
+            auto operator()(MapGraphNodeId const& n) const -> std::size_t
+            {
+                std::size_t seed = static_cast<std::size_t>(n.type);
+
+                ::hash_combine(seed, n.first);
+                ::hash_combine(seed, n.second);
+
+                return seed;
+            }
+        };
+
+        struct PairHash
+        {
+            auto operator()(std::pair<MapGraphNodeId, MapGraphNodeId> const& p) const -> std::size_t
+            {
+                auto seed = NodeHash{}(p.first);
+                ::hash_combine(seed, NodeHash{}(p.second));
+
+                return seed;
+            }
+        };
+
+        struct AreaNode
+        {
+            IntParallelepiped volume;
+            std::vector<DoorId> doors;
+        };
+
+        struct DoorNode
+        {
+            Vector3i pos;
+            std::vector<MapGraphNodeId> links;	// Areas and clusters on the sides of the door
+        };
+
+        ////
+        //	Link between a cluster of a square and a cluster of the next square along x (front link) or along y (right link).
+        ////
+        struct ClusterLink
+        {
+            std::uint16_t part;			// Cluster of this square
+            std::uint16_t next_part;	// Cluster of the next square
+            int entrance;				// Where the boundary is crossed: the middle of the run of open tiles (y for front links, x for right links)
+        };
+
+        struct Square
+        {
+            std::vector<Vector3i> parts;			// For each cluster, its tile nearest to the center of the square
+            std::vector<ClusterLink> front_links;
+            std::vector<ClusterLink> right_links;
+        };
+
+        struct CachedPath
+        {
+            std::vector<Vector3i> waypoints;
+            std::vector<MapGraphNodeId> nodes;		// The nodes crossed, the origin and the destination included
+        };
+
+        TileSet const& m_tiles;
+        int const m_cluster_dim;
+        int m_squares_x = 0;		// Squares along x on each floor
+        int m_squares_y = 0;		// Squares along y on each floor
+
+        std::unordered_map<BuildingAreaCompleteId, AreaNode> m_areas;
+        std::unordered_map<DoorId, DoorNode> m_doors;
+
+        std::vector<Square> m_squares;
+        std::vector<std::uint16_t> m_tile_parts;		// For each tile, 1 + the cluster of its square it belongs to (0 if it isn't outdoor)
+        std::vector<std::size_t> m_fill_stack;			// Scratch of the flood fill
+        std::unordered_map<std::uint64_t, std::vector<DoorId>> m_square_doors;	// External doors reachable from the clusters of each square
+
+        // Cache of the most recent paths (between abstract nodes), from the most to the least recently used.
+        std::list<std::pair<std::pair<MapGraphNodeId, MapGraphNodeId>, CachedPath>> m_cache;
+        std::unordered_map<std::pair<MapGraphNodeId, MapGraphNodeId>, decltype(m_cache)::iterator, PairHash> m_cache_index;
+
+
+        void invalidate_cache() noexcept;
+
+        ////
+        //	Drop the cached paths crossing a node for which @is_changed returns true.
+        ////
+        template <typename P>
+        void invalidate_paths(P && is_changed);
+
+        void invalidate_pathsCrossing(MapGraphNodeId const& node);
+
+        auto tile_index(int const x, int const y, int const z) const noexcept -> std::size_t
+        {
+            return (static_cast<std::size_t>(z) * m_tiles.length() + x) * m_tiles.width() + y;
+        }
+
+        auto square_of(Vector3i const pos) const noexcept -> std::uint64_t;
+        auto square_coordinates(std::uint64_t const square) const noexcept -> Vector3i;
+
+        auto cluster_of(Vector3i const pos) const noexcept -> MapGraphNodeId;
+
+        bool is_outdoor(int const x, int const y, int const z) const noexcept;
+
+        ////
+        //	Label the outdoor tiles of @square with its clusters.
+        ////
+        void update_squareClusters(std::uint64_t const square);
+
+        ////
+        //	Link the clusters of @square to those of the next squares. Their clusters must be up to date.
+        ////
+        void update_squareLinks(std::uint64_t const square);
+
+        ////
+        //	Link again the doors next to @square to its (new) clusters.
+        ////
+        void relink_squareDoors(std::uint64_t const square);
+
+        ////
+        //	Link the door @did to the clusters on its sides (only those of @only_square, if any).
+        ////
+        void link_doorClusters(DoorId const did, DoorNode & door, std::optional<std::uint64_t> const only_square);
+
+        auto node_position(MapGraphNodeId const& node) const -> Vector3i;
+
+        ////
+        //	Call @f(neighbor, waypoint) for each node linked to @node. @waypoint is the tile to reach to move from @node to @neighbor.
+        ////
+        template <typename F>
+        void for_each_neighbor(MapGraphNodeId const& node, F && f) const;
+
+        auto search(MapGraphNodeId const& from, MapGraphNodeId const& to) const -> std::optional<CachedPath>;
+};
+
+
+
+} // namespace tgm
 
 
 #endif //GM_MAP_GRAPH_H
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "simulation_batch_runner.hh"
+
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+#include "audio/audio_manager.hh"
+#include "graphics/camera.hh"
+#include "graphics/dynamic_manager.hh"
+#include "graphics/dynamic_vertices.hh"
+#include "map/gamemap.h"
+#include "map/simulation_context.hh"
+#include "mediators/roof_graphics_mediator.hh"
+#include "mediators/tile_graphics_mediator.hh"
+#include "settings/debug/debug_settings.hh"
+#include "system/clock.hh"
+
+
+namespace tgm
+{
+
+
+
+auto SimulationBatchRunner::run(std::vector<unsigned> const& seeds) const -> std::vector<SeedMetrics>
+{
+    #if VISUALDEBUG
+        // Each worker records its own simulation in its own (thread-local) VisualDebug, but only the main thread can open a window.
+        if (visualDebug_runtime_openWindowForBuildingExpansion || visualDebug_runtime_openWindowForPlayerMovement || visualDebug_runtime_openWindowForHipRoofMatrix)
+        {
+            throw std::runtime_error("Cannot run a batch of simulations while the VisualDebug windows are enabled.");
+        }
+    #endif
+
+    auto metrics = std::vector<SeedMetrics>(seeds.size());
+
+    auto thread_count = m_parameters.thread_count != 0u ? m_parameters.thread_count : std::thread::hardware_concurrency();
+    thread_count = std::clamp(thread_count, 1u, static_cast<unsigned>(std::max<std::size_t>(seeds.size(), 1u)));
+
+    // Each worker takes the next seed not yet started, so that a slow seed doesn't leave the other threads idle.
+    auto next_seed = std::atomic<std::size_t>{ 0u };
+    auto const worker = [&]()
+    {
+        for (auto i = next_seed.fetch_add(1u); i < seeds.size(); i = next_seed.fetch_add(1u))
+        {
+            metrics[i] = run_seed(seeds[i]);
+        }
+    };
+
+    auto pool = std::vector<std::thread>{};
+    pool.reserve(thread_count);
+
+    for (auto t = 0u; t < thread_count; ++t)
+    {
+        pool.emplace_back(worker);
+    }
+
+    for (auto & thread : pool)
+    {
+        thread.join();
+    }
+
+    return metrics;
+}
+
+
+void SimulationBatchRunner::write_csv(std::ostream & os, std::vector<SeedMetrics> const& metrics)
+{
+    os << "seed,buildings,blocks,processed_expansions,successful_expansions,elapsed_ms,error\n";
+
+    for (auto const& m : metrics)
+    {
+        auto error = m.error;
+        std::replace(error.begin(), error.end(), ',', ';');
+        std::replace(error.begin(), error.end(), '\n', ' ');
+
+        os << m.seed << ',' << m.building_count << ',' << m.block_count << ',' << m.processed_expansions << ',' << m.successful_expansions << ','
+           << m.elapsed_time << ',' << error << '\n';
+    }
+}
+
+
+auto SimulationBatchRunner::run_seed(unsigned const seed) const -> SeedMetrics
+{
+    auto metrics = SeedMetrics{};
+    metrics.seed = seed;
+
+    auto clock = Clock{};
+
+    try
+    {
+        auto log = std::ostringstream{};
+        auto context = SimulationContext{ m_settings, log };
+        context.settings.map.buildingExpansion_threads = 1u;	// The seeds already run in parallel
+        context.settings.map.npcMovement_threads = 1u;
+
+        // Everything the GameMap depends on belongs to this run only.
+        auto camera = Camera{};
+        auto dynamic_vertices = DynamicVertices{ 60000u };
+        auto dynamic_manager = DynamicManager{ &camera, dynamic_vertices };
+        auto tg_mediator = TileGraphicsMediator{};
+        auto rg_mediator = RoofGraphicsMediator{};
+        auto audio_manager = AudioManager{ false };	// No audio device for a headless run
+        auto gui_events = GuiEventQueues{};
+
+        auto map = GameMap{ context, seed, dynamic_manager, camera, tg_mediator, rg_mediator, audio_manager, gui_events };
+
+        auto const& map_settings = context.settings.map;
+        auto const building_recipe = BuildingRecipe{ { map_settings.test_length / 2.f, map_settings.test_width / 2.f }, AreaType::cowshed, { 10, 10 }, "farm" };
+
+        auto created_buildings = std::vector<BuildingId>{};
+
+        for (auto i = 0u; i < m_parameters.building_count; ++i)
+        {
+            auto const building_id = map.debug_buildBuilding_inNearestCity(building_recipe);
+            if (building_id) { created_buildings.push_back(building_id.value()); }
+
+            for (auto r = 0u; r < m_parameters.expansion_rounds; ++r)
+            {
+                auto const expanded_count = std::min<std::ptrdiff_t>(created_buildings.size(), m_parameters.expanded_buildings);
+                for (auto it = created_buildings.crbegin(); it != created_buildings.crbegin() + expanded_count; ++it)
+                {
+                    map.debug_request_buildingExpansion(*it);
+                }
+
+                map.debug_expand_buildings();
+            }
+
+            // Nothing draws this map, so the changes recorded for the graphics are discarded.
+            tg_mediator.changes_acquired();
+            rg_mediator.changes_acquired();
+        }
+
+        metrics.building_count = map.debug_get_buildings().count();
+        metrics.block_count = map.building_manager().debug_get_blocks().count();
+        metrics.processed_expansions = context.stats.processed_expansions;
+        metrics.successful_expansions = context.stats.successful_expansions;
+    }
+    catch (std::exception const& e)
+    {
+        metrics.error = e.what();
+    }
+
+    metrics.elapsed_time = clock.getElapsedTime().asMilliseconds();
+
+    return metrics;
+}
+
+
+
+} //namespace tgm
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef GM_SIMULATION_BATCH_RUNNER_HH
+#define GM_SIMULATION_BATCH_RUNNER_HH
+
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "settings/simulation/simulation_settings.hh"
+
+
+namespace tgm
+{
+
+
+
+struct SimulationBatchParameters
+{
+    unsigned building_count = 300u;			// Buildings created near the center of the map
+    unsigned expansion_rounds = 4u;			// Rounds of expansions after the creation of each building
+    unsigned expanded_buildings = 100u;		// Number of the most recent buildings whose expansion is requested in each round
+    unsigned thread_count = 0u;				// Threads of the pool (0 means one per hardware thread)
+};
+
+
+struct SeedMetrics
+{
+    unsigned seed = 0u;
+    unsigned building_count = 0u;			// Buildings in the map at the end of the run
+    unsigned block_count = 0u;				// Blocks in the map at the end of the run
+    uint64_t processed_expansions = 0u;
+    uint64_t successful_expansions = 0u;
+    long long elapsed_time = 0;				// Duration of the run (in milliseconds)
+    std::string error;						// Message of the exception that stopped the run (empty if the run completed)
+};
+
+
+////
+//
+//	Run the same city development on many seeds, each one on an independent GameMap with its own SimulationContext, using a pool
+//	of threads. It's meant to sweep seeds and settings headlessly: no window or graphics context is needed.
+//
+////
+class SimulationBatchRunner
+{
+    public:
+        ////
+        //	@settings: Copied into the context of each simulation.
+        ////
+        explicit SimulationBatchRunner(SimulationBatchParameters const& parameters, SimSettings const& settings = sim_settings) :
+            m_parameters{ parameters }, m_settings{ settings } {}
+
+        ////
+        //	@return: The metrics of each seed, in the same order of @seeds. A run that throws doesn't stop the others: its exception 
+        //			 is reported in SeedMetrics::error.
+        ////
+        auto run(std::vector<unsigned> const& seeds) const -> std::vector<SeedMetrics>;
+
+        ////
+        //	Write @metrics in CSV format (one row per seed, with an header).
+        ////
+        static void write_csv(std::ostream & os, std::vector<SeedMetrics> const& metrics);
+
+    private:
+        SimulationBatchParameters m_parameters;
+        SimSettings m_settings;
+
+
+        auto run_seed(unsigned const seed) const -> SeedMetrics;
+};
+
+
+
+} //namespace tgm
+
+
+#endif //GM_SIMULATION_BATCH_RUNNER_HH
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef GM_SIMULATION_CONTEXT_HH
+#define GM_SIMULATION_CONTEXT_HH
+
+
+#include <cstdint>
+#include <ostream>
+
+#include "debug/logger/log_streams.hh"
+#include "settings/simulation/simulation_settings.hh"
+#include "system/worker_pool.hh"
+
+
+namespace tgm
+{
+
+
+
+struct SimulationStats
+{
+    uint64_t processed_expansions = 0u;		// Expansions processed by BuildingManager::expand_buildings()
+    uint64_t successful_expansions = 0u;	// Processed expansions that actually added an area to their building
+    uint64_t retried_expansions = 0u;		// Expansions proposed in parallel, but recomputed serially because of a conflict
+};
+
+
+////
+//
+//	The state that belongs to a single simulation, so that many GameMaps can run at the same time in the same process (each one on
+//	its own thread). Nothing in a GameMap should read or write mutable global state: what used to be global lives here.
+//
+////
+struct SimulationContext
+{
+    ////
+    //	@a_settings: Copied, so that each simulation can be run with its own settings.
+    //	@a_log: Stream used by the simulation for its messages. It must outlive the context and it mustn't be shared with 
+    //			simulations running on other threads.
+    ////
+    explicit SimulationContext(SimSettings const& a_settings = sim_settings, std::ostream & a_log = g_log) :
+        settings{ a_settings }, log{ a_log } {}
+
+    SimulationContext(SimulationContext const&) = delete;
+    auto operator=(SimulationContext const&) -> SimulationContext & = delete;
+
+
+    SimSettings settings;
+    std::ostream & log;
+    SimulationStats stats{};
+    WorkerPool workers;		// Shared by the parallel sections of the simulation (NPC movement, building expansion)
+};
+
+
+
+} //namespace tgm
+
+
+#endif //GM_SIMULATION_CONTEXT_HH
\ No newline at end of file
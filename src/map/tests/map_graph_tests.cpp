@@ -0,0 +1,227 @@
+#include "map_graph_tests.hh"
+
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "debug/logger/log_streams.hh"
+
+
+namespace tgm
+{
+
+
+
+namespace MapGraphTests
+{
+    static void check(bool const condition, std::string const& what)
+    {
+        if (!condition) { throw std::runtime_error("MapGraph test failed: " + what); }
+    }
+
+    static void build_area(TileSet & tiles, BuildingAreaCompleteId const acid, IntParallelepiped const& vol)
+    {
+        for (auto x = vol.behind; x <= vol.front(); ++x)
+        {
+            for (auto y = vol.left; y <= vol.right(); ++y)
+            {
+                if (x == vol.behind || x == vol.front() || y == vol.left || y == vol.right())
+                {
+                    tiles.build_border(x, y, vol.down, 1u, acid.bid, acid.aid, BorderStyle::brickWall);
+                }
+                else
+                {
+                    tiles.build_innerArea(x, y, vol.down, 1u, acid.bid, acid.aid, TileType::wooden);
+                }
+            }
+        }
+    }
+
+    static bool contains(std::vector<Vector3i> const& path, Vector3i const pos)
+    {
+        return std::find(path.cbegin(), path.cend(), pos) != path.cend();
+    }
+
+
+    ////
+    //	A wall across the map can be crossed through two doors far away. Its upper part is made of two dead-end areas, entered from the two 
+    //	sides: the cached path between the two sides never crosses them, but an internal door between them opens a shortcut.
+    ////
+    static void test_shortcutDoor()
+    {
+        auto tiles = TileSet{ 60, 50, 1, 0 };
+        auto graph = MapGraph{ tiles, 8 };
+
+        auto const far_wall = std::pair{ BuildingAreaCompleteId{ 3u, 1u }, IntParallelepiped{ 35, 25, 0, 3, 25, 1 } };
+        auto const left_wall = std::pair{ BuildingAreaCompleteId{ 4u, 1u }, IntParallelepiped{ 33, 0, 0, 3, 25, 1 } };
+        auto const right_wall = std::pair{ BuildingAreaCompleteId{ 4u, 2u }, IntParallelepiped{ 35, 0, 0, 3, 25, 1 } };
+
+        for (auto const& [acid, vol] : { far_wall, left_wall, right_wall })
+        {
+            build_area(tiles, acid, vol);
+            graph.add_area(acid, vol);
+            graph.update_outdoor(vol);
+        }
+
+        auto const external_doors = std::vector<std::pair<DoorId, Vector3i>>{ { 20u, { 35, 45, 0 } }, { 21u, { 37, 45, 0 } },
+                                                                              { 22u, { 33,  3, 0 } }, { 23u, { 37,  3, 0 } } };
+        for (auto const& [did, pos] : external_doors)
+        {
+            tiles.build_externalDoor(pos.x, pos.y, pos.z, did, TileType::wooden);
+            graph.add_door(did, pos);
+        }
+
+        auto const from = Vector3i{ 25, 5, 0 };
+        auto const to = Vector3i{ 45, 5, 0 };
+
+        auto const long_path = graph.find_path(from, to);
+        check(long_path && contains(*long_path, external_doors[0].second), "the path doesn't go around through the far doors");
+
+        //--- The shortcut links only the two dead-end areas, which the cached path never crossed
+        auto const shortcut = std::pair{ DoorId{ 24u }, Vector3i{ 35, 3, 0 } };
+        tiles.build_internalDoor(shortcut.second.x, shortcut.second.y, shortcut.second.z, shortcut.first, TileType::wooden);
+        graph.add_door(shortcut.first, shortcut.second);
+
+        auto const short_path = graph.find_path(from, to);
+        check(short_path && contains(*short_path, shortcut.second), "the cached path has been kept after a shortcut door has been opened");
+        check(!contains(*short_path, external_doors[0].second), "the shorter path still goes around through the far doors");
+    }
+
+
+    void test_pathfinding()
+    {
+        auto tiles = TileSet{ 60, 50, 1, 0 };
+        auto graph = MapGraph{ tiles, 8 };
+
+        auto const outside = Vector3i{ 5, 5, 0 };
+        auto const far_outside = Vector3i{ 55, 45, 0 };
+        auto const inside = Vector3i{ 25, 25, 0 };
+
+
+        //--- Empty map: every outdoor tile is reachable and the repeated queries are served by the cache
+        auto const path = graph.find_path(outside, far_outside);
+        check(path && path->back() == far_outside, "no path on an empty map");
+        check(graph.cachedPath_count() == 1u, "the path hasn't been cached");
+        check(graph.find_path(outside, far_outside) == path, "the cached path differs from the searched one");
+        check(graph.cachedPath_count() == 1u, "a cached path has been cached again");
+
+        //--- The cache keeps only the most recent paths, and an evicted one is searched again with the same result
+        auto cluster_tiles = std::vector<Vector3i>{};	// A tile in each cluster
+        for (auto x = 0; x < tiles.length(); x += 8)
+        {
+            for (auto y = 0; y < tiles.width(); y += 8)
+            {
+                cluster_tiles.push_back({ x, y, 0 });
+            }
+        }
+
+        auto queries = std::size_t{ 0u };
+        for (auto const from : cluster_tiles)
+        {
+            for (auto const to : cluster_tiles)
+            {
+                if (queries == MapGraph::max_cachedPaths + 16u) { break; }
+                if (from == to) { continue; }
+
+                check(graph.find_path(from, to).has_value(), "no path between two outdoor tiles");
+                ++queries;
+            }
+        }
+        check(graph.cachedPath_count() == MapGraph::max_cachedPaths, "the cache isn't bounded");
+        check(graph.find_path(outside, far_outside) == path, "an evicted path changed");
+
+
+        //--- An area without doors can't be entered. Since a new node could shorten any path, building it drops all the cached paths.
+        auto const acid = BuildingAreaCompleteId{ 1u, 1u };
+        auto const vol = IntParallelepiped{ 20, 20, 0, 10, 10, 1 };
+
+        auto const crossing_from = Vector3i{ 4, 25, 0 };
+        auto const crossing_to = Vector3i{ 45, 25, 0 };
+        auto const away_from = Vector3i{ 2, 2, 0 };
+        auto const away_to = Vector3i{ 2, 45, 0 };
+
+        build_area(tiles, acid, vol);
+        graph.add_area(acid, vol);
+        graph.update_outdoor(vol);
+
+        check(graph.cachedPath_count() == 0u, "a path is still cached after an area has been added");
+        check(!graph.find_path(outside, inside), "a closed area has been entered");
+
+        //--- Relabelling the squares without opening any tile drops only the cached paths crossing them
+        check(graph.find_path(crossing_from, crossing_to) && graph.find_path(away_from, away_to), "no path around the area");
+
+        graph.update_outdoor(vol);
+
+        check(!graph.is_pathCached(crossing_from, crossing_to), "a path crossing the relabelled squares is still cached");
+        check(graph.is_pathCached(away_from, away_to), "a path far from the relabelled squares has been dropped");
+        check(graph.find_path(outside, far_outside).has_value(), "the outdoor has been split by a single area");
+
+        //--- Its door lets the path in
+        auto const did = DoorId{ 7u };
+        auto const door_pos = Vector3i{ 20, 25, 0 };
+
+        tiles.build_externalDoor(door_pos.x, door_pos.y, door_pos.z, did, TileType::wooden);
+        graph.add_door(did, door_pos);
+
+        auto const door_path = graph.find_path(outside, inside);
+        check(door_path && contains(*door_path, door_pos), "the path into the area doesn't cross its door");
+
+        //--- A graph built from the tiles (at construction or by reset) matches the incremental one
+        auto rebuilt = MapGraph{ tiles, 8 };
+        check(rebuilt.area_count() == 1u && rebuilt.door_count() == 1u, "the areas and the doors haven't been read from the tiles");
+        check(rebuilt.find_path(outside, inside) == door_path, "the rebuilt graph finds a different path");
+
+        graph.reset();
+        check(graph.area_count() == 1u && graph.door_count() == 1u, "reset() lost the areas or the doors");
+        check(graph.find_path(outside, inside) == door_path, "the reset graph finds a different path");
+
+        //--- Without the door the area is closed again. A removal can only lengthen the paths, so only those crossing the door are dropped.
+        check(graph.find_path(away_from, away_to).has_value(), "no path far from the area");
+
+        tiles.unbuild_door(door_pos.x, door_pos.y, door_pos.z);
+        graph.remove_door(did);
+
+        check(!graph.is_pathCached(outside, inside), "a path crossing a removed door is still cached");
+        check(graph.is_pathCached(away_from, away_to), "a path far from a removed door has been dropped");
+        check(!graph.find_path(outside, inside), "the area has been entered through a removed door");
+
+
+        //--- A wall across the whole map splits the squares it crosses: their clusters on the two sides aren't linked
+        auto const wall_acid = BuildingAreaCompleteId{ 2u, 1u };
+        auto const wall = IntParallelepiped{ 35, 0, 0, 3, tiles.width(), 1 };	// Crosses the squares from x = 32 to x = 39
+
+        build_area(tiles, wall_acid, wall);
+        graph.add_area(wall_acid, wall);
+        graph.update_outdoor(wall);
+
+        check(graph.locate({ 33, 5, 0 }) != graph.locate({ 39, 5, 0 }), "the two sides of the wall are in the same cluster");
+        check(!graph.find_path(outside, far_outside), "a path crosses the wall");
+
+        //--- Two doors let the path through the wall
+        auto const wall_doors = std::vector<std::pair<DoorId, Vector3i>>{ { 8u, { 35, 30, 0 } }, { 9u, { 37, 30, 0 } } };
+        for (auto const& [wall_did, pos] : wall_doors)
+        {
+            tiles.build_externalDoor(pos.x, pos.y, pos.z, wall_did, TileType::wooden);
+            graph.add_door(wall_did, pos);
+        }
+
+        auto const wall_path = graph.find_path(outside, far_outside);
+        check(wall_path && contains(*wall_path, wall_doors[0].second) && contains(*wall_path, wall_doors[1].second), 
+              "the path through the wall doesn't cross its doors");
+
+        graph.reset();
+        check(graph.find_path(outside, far_outside) == wall_path, "the reset graph finds a different path through the wall");
+
+
+        test_shortcutDoor();
+
+
+        g_log << "MapGraph tests passed." << std::endl;
+    }
+}
+
+
+
+} //namespace tgm
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef GM_MAP_GRAPH_TESTS_HH
+#define GM_MAP_GRAPH_TESTS_HH
+
+
+#include "map/map_graph.h"
+
+
+namespace tgm
+{
+
+
+
+namespace MapGraphTests
+{
+    ////
+    //	Find paths on a small TileSet while an area and its door are built and unbuilt: the paths must follow the changes, the cache 
+    //	must keep at most MapGraph::max_cachedPaths paths, drop them all on an addition and only those crossing a removal, a wall 
+    //	splitting the squares must be crossed only through its doors (and through a shortcut door as soon as it's opened) and a graph 
+    //	built (or reset) from the tiles must match the incremental one.
+    ////
+    void test_pathfinding();
+}
+
+
+
+} //namespace tgm
+
+
+#endif //GM_MAP_GRAPH_TESTS_HH
\ No newline at end of file
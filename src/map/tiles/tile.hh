@@ -112,13 +112,14 @@ class Tile
         static auto constexpr max_borders = 4;
         static auto constexpr max_roofs = 4;
 
+        // Only the TileSet copies the tiles, to save them in its undo log.
+        Tile(const Tile&) = default;
+        Tile& operator=(const Tile&) = default;
+
     public:
         Tile(const Vector3i& coord, const TileType& typ) :
             coordinates(coord), type(typ) { }
 
-        Tile(const Tile&) = delete;
-        Tile& operator=(const Tile&) = delete;
-
         const Vector3i& get_coordinates() const { return coordinates; }
         void set_coordinates(const Vector3i& new_coordinates) { coordinates = new_coordinates; }
 
@@ -315,6 +316,7 @@ class Tile
     friend auto operator>>(std::ifstream & ifs, Tile & t) -> std::ifstream &;
     friend auto operator<<(Logger & lgr, Tile const& t) -> Logger &;
     friend class TileGui;
+    friend class TileSet;
     friend class BuildingExpansionVisualDebug;
 
     //friend void allocatedMemory_forecast();//DEBUG
@@ -4,7 +4,6 @@
 #include <bitset>
 
 #include "map/buildings/building_area.hh"
-#include "settings/simulation/simulation_settings.hh"
 
 #include "debug/visual/player_movement_stream.hh"
 
@@ -225,6 +224,34 @@ void TileSet::unbuild_door(int const x, int const y, int const z)
     get_existentMutable(x, y, z).unbuild_door();
 }
 
+
+void TileSet::begin_transaction()
+{
+    #if DYNAMIC_ASSERTS
+        if (m_transaction) { throw std::runtime_error("The TileSet is already in a transaction."); }
+    #endif
+
+    m_transaction = true;
+}
+
+void TileSet::commit_transaction() noexcept
+{
+    m_transaction = false;
+    m_undo_log.clear();
+    m_logged_tiles.clear();
+}
+
+void TileSet::rollback_transaction()
+{
+    // Each tile is logged once, with its state before the transaction
+    for (auto const& entry : m_undo_log)
+    {
+        m_tileset[entry.index] = entry.tile;
+    }
+
+    commit_transaction();
+}
+
         
 bool TileSet::is_between_twoBorders(int const x, int const y, int const z) const
 {
@@ -237,15 +264,15 @@ bool TileSet::is_between_twoBorders(int const x, int const y, int const z) const
         || (W_tile && E_tile && W_tile->is_border() && E_tile->is_border());
 }
 
-void TileSet::debug_generateDefaultTileset()
+void TileSet::debug_generateDefaultTileset(int const ground_floor)
 {
     for (int z = 0; z < m_height; ++z)
     {
         //underground
-        if (z < sim_settings.map.ground_floor)
+        if (z < ground_floor)
             debug_generateDefaultLevel(z, TileType::underground);
         //ground
-        else if (z == sim_settings.map.ground_floor)
+        else if (z == ground_floor)
             debug_generateDefaultLevel(z, TileType::ground);
         //sky
         else
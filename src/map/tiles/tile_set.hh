@@ -4,12 +4,13 @@
 
 #include <memory>
 #include <sstream>
+#include <unordered_set>
+#include <vector>
 
 #include <flatbuffers/flatbuffers.h>
 
 #include "graphics/tile_vertices.hh"
 #include "io/flatbuffers/tileset_generated.h"
-#include "mediators/queues/door_ev.hh"
 #include "mediators/tile_graphics_mediator.hh"
 #include "map/tiles/border_type.hh"
 #include "map/tiles/tile.hh"
@@ -50,15 +51,16 @@ class TileSet
         //TODO: NOW: Forse andrebbe unificato il costruttore e reset(...) permettendo solo una lazy initialization.
         ////
         //	N.B.: (@length * @width * @height) must be a multiple of GraphicsSettings::chunkSize_inTile.
+        //	@ground_floor: Floor made of ground tiles (MapSettings::ground_floor of the simulation): the ones below are underground, the ones above are sky.
         ////
-        TileSet(int const length, int const width, int const height, DoorEventQueues & door_events) : 
-            m_length(length), m_width(width), m_height(height),	m_door_events(door_events)
+        TileSet(int const length, int const width, int const height, int const ground_floor) : 
+            m_length(length), m_width(width), m_height(height)
         {
             auto const tile_count = static_cast<AT::size_type>(m_length) * static_cast<AT::size_type>(m_width) * static_cast<AT::size_type>(m_height); //cast in order to avoid overflows
 
             m_tileset = AT::allocate(m_alloc, tile_count);
 
-            debug_generateDefaultTileset();
+            debug_generateDefaultTileset(ground_floor);
         }
 
         ~TileSet()
@@ -172,6 +174,15 @@ class TileSet
         void add_mobile(Vector3i const pos) { get_existentMutable(pos.x, pos.y, pos.z).add_mobile(); }
         void remove_mobile(Vector3i const pos) { get_existentMutable(pos.x, pos.y, pos.z).remove_mobile(); }
 
+        ////
+        //	Until commit_transaction() or rollback_transaction() is called, save each tile in an undo log the first time it's changed, so 
+        //	that rollback_transaction() can revert the changes in a time proportional to the number of tiles touched.
+        ////
+        void begin_transaction();
+        void commit_transaction() noexcept;
+        void rollback_transaction();
+        bool in_transaction() const noexcept { return m_transaction; }
+
         auto write(flatbuffers::FlatBufferBuilder & fbb) const -> flatbuffers::Offset<tgmschema::TileSet>;
         void read(tgmschema::TileSet const*const ts);
 
@@ -183,8 +194,18 @@ class TileSet
         using AT = std::allocator_traits<std::allocator<Tile>>;
         std::allocator<Tile> m_alloc;
         Tile * m_tileset = nullptr;
-        
-        DoorEventQueues & m_door_events;
+
+        struct TileUndoEntry
+        {
+            TileUndoEntry(AT::size_type const a_index, Tile const& a_tile) : index{ a_index }, tile{ a_tile } {}
+
+            AT::size_type index;
+            Tile tile;		// State of the tile before the change
+        };
+
+        bool m_transaction = false;
+        std::vector<TileUndoEntry> m_undo_log;
+        std::unordered_set<AT::size_type> m_logged_tiles;	// Tiles whose state before the transaction is already in the undo log
         
         void free();
               
@@ -208,12 +229,18 @@ class TileSet
                 if (!t)	{ throw std::runtime_error("Trying to access an unexistent tile.");	}
             #endif
 
+            if (m_transaction) 
+            {
+                auto const index = static_cast<AT::size_type>(t - m_tileset);
+                if (m_logged_tiles.insert(index).second) { m_undo_log.emplace_back(index, *t); }
+            }
+
             return *t;
         }
 
         bool is_between_twoBorders(int const x, int const y, int const z) const;
 
-        void debug_generateDefaultTileset();
+        void debug_generateDefaultTileset(int const ground_floor);
         void debug_generateDefaultLevel(int const z, TileType const ttype);
 
         
@@ -0,0 +1,91 @@
+#ifndef GM_CONCURRENT_EVENT_QUEUES_IMPL_HH
+#define GM_CONCURRENT_EVENT_QUEUES_IMPL_HH
+
+
+#include <cstdint>
+#include <tuple>
+
+#include "base_event.hh"
+#include "event_queues_impl.hh"
+#include "data_strctures/mpsc_ring_buffer.hh"
+
+
+////
+//	Number of events of type T that can wait in a ConcurrentEventQueuesImpl before the pushes start to fail.
+//	Specialize it next to the declaration of an event that can be pushed in bursts.
+////
+template <typename T>
+struct EventQueueCapacity
+{
+    static std::size_t constexpr value = 256u;
+};
+
+
+struct EventQueueStats
+{
+    std::size_t capacity = 0u;
+    std::uint64_t pushed = 0u;			// Events accepted since the creation of the queue
+    std::uint64_t overflows = 0u;		// Events discarded because the queue was full
+    std::size_t high_water = 0u;		// Most events seen waiting at once
+};
+
+
+////
+//	Same interface of EventQueuesImpl, but each queue is a bounded lock-free ring (tgm::MpscRingBuffer), so the events can be pushed
+//	by any thread, while a single thread (usually the main one) consumes them. A push never allocates; it fails when the queue of
+//	that type is full, and the failure is recorded in the stats.
+////
+template <typename ...Ts>
+class ConcurrentEventQueuesImpl
+{
+    static_assert(all_base_of<BaseEvent, Ts...>(), "EventQueues has been designed only for events.");
+
+
+    public:
+        ConcurrentEventQueuesImpl() : queues{ EventQueueCapacity<Ts>::value... } {}
+        ConcurrentEventQueuesImpl(ConcurrentEventQueuesImpl const&) = delete;
+        auto operator=(ConcurrentEventQueuesImpl const&) -> ConcurrentEventQueuesImpl & = delete;
+
+        ////
+        //	Thread-safe.
+        //	@return: False if the queue of @T is full and the event has been discarded (the discarded events are counted in stats()).
+        ////
+        template<typename T, typename ...Us>
+        [[nodiscard]] bool push(Us&&... args)
+        {
+            return std::get<tgm::MpscRingBuffer<T>>(queues).try_emplace(std::forward<Us>(args)...);
+        }
+
+        ////
+        //	The queue provides empty(), front() and pop() like a std::queue, but only the consumer thread can use it.
+        ////
+        template<typename T>
+        auto get() noexcept -> tgm::MpscRingBuffer<T> &
+        {
+            return std::get<tgm::MpscRingBuffer<T>>(queues);
+        }
+
+        ////
+        //	Consume all the events of type @T that are ready, calling @fn on each of them. Only the consumer thread can call it.
+        ////
+        template<typename T, typename F>
+        auto drain(F && fn)
+        {
+            return get<T>().drain(std::forward<F>(fn));
+        }
+
+        template<typename T>
+        auto stats() const noexcept -> EventQueueStats
+        {
+            auto const& q = std::get<tgm::MpscRingBuffer<T>>(queues);
+
+            return { q.capacity(), q.pushed_count(), q.overflow_count(), q.high_water() };
+        }
+    
+
+    private:
+        std::tuple<tgm::MpscRingBuffer<Ts>...> queues;
+};
+
+
+#endif //GM_CONCURRENT_EVENT_QUEUES_IMPL_HH
\ No newline at end of file
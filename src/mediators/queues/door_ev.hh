@@ -3,7 +3,7 @@
 
 
 #include "base_event.hh"
-#include "event_queues_impl.hh"
+#include "concurrent_event_queues_impl.hh"
 #include "map/map_forward_decl.hh"
 #include "map/tiles/tile.hh"
 #include "system/vector2.hh"
@@ -27,11 +27,19 @@ class TryOpenDoorEv : public BaseEvent
 class DebugInteractWithAllDoorsEv : public BaseEvent {};
 
 
-using DoorEventQueues = EventQueuesImpl<TryOpenDoorEv, DebugInteractWithAllDoorsEv>;
+using DoorEventQueues = ConcurrentEventQueuesImpl<TryOpenDoorEv, DebugInteractWithAllDoorsEv>;
 
 
 
 } //namespace tgm
 
 
+// Every mobile walking through a door pushes an event, so a crowd can push many of them in a single frame.
+template <>
+struct EventQueueCapacity<tgm::TryOpenDoorEv>
+{
+    static std::size_t constexpr value = 4096u;
+};
+
+
 #endif //GM_DOOR_EV_HH
\ No newline at end of file
@@ -3,7 +3,9 @@
 
 
 #include "base_event.hh"
-#include "event_queues_impl.hh"
+#include "concurrent_event_queues_impl.hh"
+
+#include "debug/logger/log_streams.hh"
 
 #include "map/map_forward_decl.hh"
 #include "map/city_block.hh"
@@ -58,11 +60,25 @@ struct OpenCityBlockGuiEv : public BaseEvent
 };
 
 
-using GuiEventQueues = EventQueuesImpl< SaveWorldEv, LoadWorldEv, ExitEv, 
+using GuiEventQueues = ConcurrentEventQueuesImpl< SaveWorldEv, LoadWorldEv, ExitEv, 
                                         MainLoopAnalyzerEv, MovementAnalyzerEv, ControlPanelEv,
                                         RetrieveCityBlockEv, OpenCityBlockGuiEv >;
 
 
+////
+//	Push a GUI event. If the queue is full the event is discarded (the drop is counted in GuiEventQueues::stats()) and the
+//	user is asked in the log to repeat the command.
+////
+template<typename T, typename ...Args>
+void push_guiEvent(GuiEventQueues & gui_events, Args&& ...args)
+{
+    if (!gui_events.push<T>(std::forward<Args>(args)...))
+    {
+        g_log << "The GUI event queue is full: the last command has been discarded. Please, repeat it.\n";
+    }
+}
+
+
 
 }
 
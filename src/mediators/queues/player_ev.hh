@@ -3,7 +3,7 @@
 
 
 #include "base_event.hh"
-#include "event_queues_impl.hh"
+#include "concurrent_event_queues_impl.hh"
 #include "map/direction.h"
 
 
@@ -27,7 +27,7 @@ class DebugIncreasePlayerVelocityEv : public BaseEvent {};
 
 
 
-using PlayerEventQueues = EventQueuesImpl< PlayerMovementEv, DebugDecreasePlayerVelocityEv, DebugIncreasePlayerVelocityEv >;
+using PlayerEventQueues = ConcurrentEventQueuesImpl< PlayerMovementEv, DebugDecreasePlayerVelocityEv, DebugIncreasePlayerVelocityEv >;
 
 
 
@@ -126,8 +126,9 @@ namespace tgm
     inline bool visualDebug_runtime_openWindowForPlayerMovement = false;	    // Enable the opening of the window at each step only for PlayerMovementVisualDebug.
     inline bool visualDebug_runtime_openWindowForHipRoofMatrix = false;			// Enable the opening of the window at each step only for HipRoofMatrixVisualDebug.
 
-    inline long long debug_highlightings_count = 0;
-    inline long long debug_unhighlightings_count = 0;
+    // Thread-local like the VisualDebug instances (see BEdeb).
+    inline thread_local long long debug_highlightings_count = 0;
+    inline thread_local long long debug_unhighlightings_count = 0;
 
 } // namespace tgm
 #endif //VISUALDEBUG
@@ -65,6 +65,15 @@
 #define GSET_OCCLUSION_CULLING false
 
 
+////
+//  When enabled the tiles outside the view frustum are discarded on the CPU before being drawn. The tile buffer is split in small cells
+//  of contiguous vertices, and only the ranges of the cells intersecting the frustum are drawn with a single multi-draw call.
+//  It's ignored when GSET_OCCLUSION_CULLING is enabled.
+//  Default: true. Turning it off decreases the performance, especially when zoomed in on large maps.
+////
+#define GSET_FRUSTUM_CULLING true
+
+
 ////
 //  It allows to quickly switch from a texture atlas to another. It is used to test different texture atlases with differen tile dimensions
 //  and check that tile-dimension is really a variable and doesn't hardly affect any engine feature.
@@ -303,6 +312,11 @@ class GraphicsSettings
         ////
         static auto constexpr chunkSize_inTile = 1500; 
 
+        ////
+        //  Length of a frustum culling cell (in tiles). A cell is a run of tiles lying on the same row of the map.
+        ////
+        static auto constexpr frustumCullingCell_inTiles = 50;
+
 
         static inline Vector3f TEST_playerSpritePosition{ 0.f, 0.f, 0.f };
         static inline Vector3f TEST_cameraTargetPosition{ 0.f, 0.f, 0.f };
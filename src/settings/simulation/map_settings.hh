@@ -56,7 +56,7 @@ struct MapSettings
     ////
     //  Maximum allowed surface for a block (in tiles).
     ////
-    int const max_cityBlockSurface = 1500;
+    int max_cityBlockSurface = 1500;
 
     ////
     //  Minimum space between two blocks (in tiles).
@@ -101,6 +101,32 @@ struct MapSettings
     ////
     bool const roof_every_area = true;
 
+    ////
+    //  Number of threads searching the positions of the queued building expansions (0 means one for each core, 1 disables the parallel search).
+    //  The parallel search is disabled anyway when BUILDEXP_VISUALDEBUG is enabled.
+    ////
+    unsigned buildingExpansion_threads = 1u;
+
+    ////
+    //  Number of threads resolving the collisions of the moving NPCs (0 means one for each core). The result doesn't depend on it.
+    ////
+    unsigned npcMovement_threads = 0u;
+
+    ////
+    //  Side (in tiles) of the squares whose outdoor tiles are split in clusters by the navigation graph (see MapGraph).
+    ////
+    int navigation_clusterDim = 16;
+
+    ////
+    //  Side (in tiles) of the cells of the MobileSpatialHash.
+    ////
+    int mobileHash_cellDim = 4;
+
+    ////
+    //  Side (in tiles) of the cells of the BuildingAreaIndex.
+    ////
+    int areaIndex_cellDim = 16;
+
     unsigned const test_farm_expId = 1;
     unsigned const test_alwaysReplace_expId = 2;
 };
@@ -0,0 +1,115 @@
+#include "worker_pool.hh"
+
+
+#include <algorithm>
+
+
+namespace tgm
+{
+
+
+
+WorkerPool::~WorkerPool()
+{
+    {
+        auto lock = std::scoped_lock{ m_mutex };
+        m_stop = true;
+    }
+    m_start_cv.notify_all();
+
+    for (auto & t : m_threads)
+    {
+        t.join();
+    }
+}
+
+
+void WorkerPool::run_tasks(unsigned const task_count, TaskFn const fn, void * const ctx)
+{
+    if (task_count == 0u) { return; }
+
+    if (task_count == 1u)
+    {
+        fn(ctx, 0u);
+        return;
+    }
+
+    if (m_errors.size() < task_count) { m_errors.resize(task_count); }
+    std::fill(m_errors.begin(), m_errors.begin() + task_count, nullptr);
+
+    // A new worker skips the runs started before it, so it doesn't execute a task of a completed run.
+    while (m_threads.size() + 1u < task_count)
+    {
+        m_threads.emplace_back([this, task = static_cast<unsigned>(m_threads.size() + 1u), generation = m_generation] { work(task, generation); });
+    }
+
+    {
+        auto lock = std::scoped_lock{ m_mutex };
+        m_fn = fn;
+        m_ctx = ctx;
+        m_task_count = task_count;
+        m_pending = task_count - 1u;
+        ++m_generation;
+    }
+    m_start_cv.notify_all();
+
+    try
+    {
+        fn(ctx, 0u);
+    }
+    catch (...)
+    {
+        m_errors[0] = std::current_exception();
+    }
+
+    {
+        auto lock = std::unique_lock{ m_mutex };
+        m_done_cv.wait(lock, [this] { return m_pending == 0u; });
+    }
+
+    for (auto i = 0u; i < task_count; ++i)
+    {
+        if (m_errors[i]) { std::rethrow_exception(m_errors[i]); }
+    }
+}
+
+
+void WorkerPool::work(unsigned const task, std::uint64_t seen_generation)
+{
+    while (true)
+    {
+        auto fn = TaskFn{ nullptr };
+        auto ctx = static_cast<void *>(nullptr);
+        {
+            auto lock = std::unique_lock{ m_mutex };
+            m_start_cv.wait(lock, [this, seen_generation] { return m_stop || m_generation != seen_generation; });
+
+            if (m_stop) { return; }
+
+            seen_generation = m_generation;
+            if (task >= m_task_count) { continue; }		// Not needed by this run
+
+            fn = m_fn;
+            ctx = m_ctx;
+        }
+
+        try
+        {
+            fn(ctx, task);
+        }
+        catch (...)
+        {
+            m_errors[task] = std::current_exception();
+        }
+
+        {
+            auto lock = std::scoped_lock{ m_mutex };
+            --m_pending;
+        }
+        m_done_cv.notify_one();
+    }
+}
+
+
+
+} // namespace tgm
@@ -0,0 +1,79 @@
+#ifndef GM_WORKER_POOL_HH
+#define GM_WORKER_POOL_HH
+
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace tgm
+{
+
+
+
+////
+//
+//	Threads kept alive between the parallel sections of a simulation, so that their thread-local state (scratch buffers, log rings)
+//	survives from a tick to the next one. A run splits the work in tasks identified by their index: the task 0 is executed by the
+//	calling thread, each other task by its own worker. The workers are started the first time they are needed and joined by the 
+//	destructor. A run doesn't allocate, unless it needs more workers than any previous run.
+//	A pool must be used by a single thread at a time (the one owning the simulation).
+//
+////
+class WorkerPool
+{
+    public:
+        WorkerPool() = default;
+        WorkerPool(WorkerPool const&) = delete;
+        auto operator=(WorkerPool const&) -> WorkerPool & = delete;
+
+        ~WorkerPool();
+
+        ////
+        //	Call @task(i) for each i in [0, @task_count) and wait for all of them. If some tasks throw, the exception of the task with the
+        //	lowest index is rethrown once all the tasks are done.
+        ////
+        template <typename F>
+        void run(unsigned const task_count, F && task)
+        {
+            using Task = std::remove_reference_t<F>;
+
+            run_tasks(task_count, [](void * const ctx, unsigned const i) { (*static_cast<Task *>(ctx))(i); }, 
+                      const_cast<void *>(static_cast<void const*>(&task)));
+        }
+
+        auto worker_count() const noexcept -> std::size_t { return m_threads.size(); }
+
+    private:
+        using TaskFn = void (*)(void * ctx, unsigned i);
+
+        std::vector<std::thread> m_threads;				// The worker i executes the task i + 1
+        std::vector<std::exception_ptr> m_errors;		// One for each task
+
+        std::mutex m_mutex;
+        std::condition_variable m_start_cv;
+        std::condition_variable m_done_cv;
+        std::uint64_t m_generation = 0u;				// Incremented at the start of each run
+        TaskFn m_fn = nullptr;
+        void * m_ctx = nullptr;
+        unsigned m_task_count = 0u;
+        unsigned m_pending = 0u;						// Tasks of the current run not yet completed by the workers
+        bool m_stop = false;
+
+
+        void run_tasks(unsigned const task_count, TaskFn const fn, void * const ctx);
+
+        void work(unsigned const task, std::uint64_t seen_generation);
+};
+
+
+
+} // namespace tgm
+
+
+#endif //GM_WORKER_POOL_HH
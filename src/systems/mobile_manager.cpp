@@ -1,6 +1,11 @@
 #include "mobile_manager.h"
 
 
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
 #include "settings/gameplay_settings.hh"
 
 
@@ -9,10 +14,11 @@ namespace tgm
 
 
 
-MobileManager::MobileManager(MobileEventQueues & mobile_events, MobileBody & player_body, DataArray<MobileBody> & npc_bodies, Camera & camera,
-                             DynamicManager & dynamic_manager, TileSet & tiles, DataArray<Building> & buildings, DoorEventQueues & door_events) :
-    m_mobile_events(mobile_events), m_player_body(player_body), m_npc_bodies(npc_bodies), m_camera(camera),
-    m_dynamic_manager(dynamic_manager), m_tiles(tiles), m_buildings(buildings), m_door_events(door_events) { }
+MobileManager::MobileManager(SimulationContext & context, MobileEventQueues & mobile_events, MobileBody & player_body, DataArray<MobileBody> & npc_bodies,
+                             Camera & camera, DynamicManager & dynamic_manager, TileSet & tiles, DataArray<Building> & buildings, DoorEventQueues & door_events) :
+    m_context(context), m_mobile_events(mobile_events), m_player_body(player_body), m_npc_bodies(npc_bodies), m_camera(camera),
+    m_dynamic_manager(dynamic_manager), m_tiles(tiles), m_buildings(buildings), m_door_events(door_events),
+    m_spatial_hash(tiles.length(), tiles.width(), tiles.height(), context.settings.map.mobileHash_cellDim) { }
 
 
 void MobileManager::add_playerBody_to_map()
@@ -22,6 +28,7 @@ void MobileManager::add_playerBody_to_map()
     {
         m_tiles.add_mobile(p);
     }
+    m_spatial_hash.insert(player_mobileId, m_player_body.feet_square(), m_player_body.z_floor());
 
 
     auto const& subimage = pick_subimageSet(m_player_body.style()).pick_subimage(m_player_body.get_moveDirection());
@@ -90,6 +97,9 @@ void MobileManager::update()
 
 void MobileManager::move()
 {
+    resend_deferredDoorOpenings();
+
+
     // Trail system for the first mobile: i.e. the player
     // ---------------
 
@@ -112,7 +122,9 @@ void MobileManager::move()
             auto const velocity = m_player_body.velocity();
 
             #if GMPLSET_DETECT_COLLISIONS
-                auto const [adjusted_destSquare, doors_to_open] = TrailSystem::compute_nearestPosition(orig_square, z_floor, move_drc, velocity, m_tiles);
+                auto & doors_to_open = m_doors_toOpen;
+                doors_to_open.clear();
+                auto const adjusted_destSquare = TrailSystem::compute_nearestPosition(orig_square, z_floor, move_drc, velocity, m_tiles, doors_to_open);
                 //auto const adjusted_destSquare = TrailSystem::debug_brute_computeNearestPosition(orig_square, z_floor, move_drc, m_player_body.rounded_velocity(), m_tiles);
                 //std::vector<CompleteId> const doors_to_open;
 
@@ -146,7 +158,7 @@ void MobileManager::move()
             move_player(orig_square, z_floor, adjusted_destSquare, z_floor);
 
             for(auto did : doors_to_open)
-                m_door_events.push<TryOpenDoorEv>(did);
+                request_doorOpening(did);
 
         }
         break;
@@ -155,10 +167,206 @@ void MobileManager::move()
     
     // Move the other mobiles, i.e. the NPCs
     // ---------------
-    //for (auto & npc_body : m_npc_bodies)
-    //{
-    //	//TODO: do stuffs and collisions...
-    //}
+    move_npcs();
+}
+
+auto MobileManager::spawn_npc(MobileBody const& body) -> MobileId
+{
+    assert_feetTiles(body.feet_square(), body.z_floor(), true);
+
+    auto & [id, npc] = m_npc_bodies.create(body);
+
+    update_hostedMobiles(npc.feet_square(), npc.z_floor(), true);
+    m_spatial_hash.insert(id, npc.feet_square(), npc.z_floor());
+
+    auto const& subimage = pick_subimageSet(npc.style()).pick_subimage(npc.get_moveDirection());
+    npc.set_spriteId(m_dynamic_manager.create(npc.volume(), subimage, true));
+
+    return id;
+}
+
+void MobileManager::despawn_npc(MobileId const id)
+{
+    auto const& npc = m_npc_bodies.get_or_throw(id);
+
+    update_hostedMobiles(npc.feet_square(), npc.z_floor(), false);
+    m_spatial_hash.remove(id, npc.feet_square(), npc.z_floor());
+    m_dynamic_manager.destroy(npc.sprite_id());
+
+    m_npc_bodies.destroy(id);
+}
+
+void MobileManager::move_npcs()
+{
+    auto & batch = m_npc_batch;
+
+    // (1) Gather the moving NPCs
+    batch.ids.clear();
+    batch.squares.clear();
+    batch.z_floors.clear();
+    batch.directions.clear();
+    batch.velocities.clear();
+
+    for (auto const& [id, npc] : std::as_const(m_npc_bodies))
+    {
+        auto const drc = npc.get_moveDirection();
+        if (drc == Direction::none || drc == Direction::U || drc == Direction::L) { continue; }
+
+        batch.ids.push_back(id);
+        batch.squares.push_back(npc.feet_square());
+        batch.z_floors.push_back(npc.z_floor());
+        batch.directions.push_back(drc);
+        batch.velocities.push_back(npc.velocity());
+    }
+
+    auto const npc_count = batch.ids.size();
+    if (npc_count == 0u) { return; }
+
+    batch.dest_squares.resize(npc_count);
+
+
+    // (2) Resolve the collisions. Each worker gets a contiguous range, so its doors are already sorted by batch index.
+    auto const thread_count = npcMovement_threadCount(npc_count);
+    auto const chunk = (npc_count + thread_count - 1u) / thread_count;
+
+    if (batch.doors_toOpen.size() < thread_count) { batch.doors_toOpen.resize(thread_count); }
+
+    m_context.workers.run(thread_count, [this, npc_count, chunk](unsigned const w)
+        {
+            resolve_npcCollisions(std::min(w * chunk, npc_count), std::min((w + 1u) * chunk, npc_count), w);
+        });
+
+
+    // (3) Commit in batch order
+    for (auto i = std::size_t{ 0u }; i < npc_count; ++i)
+    {
+        commit_npcMovement(i);
+    }
+
+    for (auto w = 0u; w < thread_count; ++w)
+    {
+        for (auto const& door : batch.doors_toOpen[w])
+        {
+            request_doorOpening(door.second);
+        }
+    }
+}
+
+void MobileManager::request_doorOpening(DoorId const did)
+{
+    if (!m_door_events.push<TryOpenDoorEv>(did))
+    {
+        m_deferred_doorOpenings.push_back(did);
+    }
+}
+
+void MobileManager::resend_deferredDoorOpenings()
+{
+    if (m_deferred_doorOpenings.empty()) { return; }
+
+    auto deferred = std::vector<DoorId>{};
+    deferred.swap(m_deferred_doorOpenings);
+
+    for (auto const did : deferred)
+    {
+        request_doorOpening(did);
+    }
+}
+
+void MobileManager::resolve_npcCollisions(std::size_t const first, std::size_t const last, unsigned const worker)
+{
+    auto & batch = m_npc_batch;
+    auto & doors = batch.doors_toOpen[worker];
+    doors.clear();
+
+    thread_local std::vector<DoorId> npc_doors;
+    for (auto i = first; i < last; ++i)
+    {
+        #if GMPLSET_DETECT_COLLISIONS
+            npc_doors.clear();
+            batch.dest_squares[i] = TrailSystem::compute_nearestPosition(batch.squares[i], batch.z_floors[i], batch.directions[i], batch.velocities[i], 
+                                                                         m_tiles, npc_doors);
+
+            for (auto const did : npc_doors)
+            {
+                doors.emplace_back(i, did);
+            }
+        #else
+            batch.dest_squares[i] = DirectionUtil::compute_newRect(batch.squares[i], batch.directions[i], batch.velocities[i]);
+        #endif
+    }
+}
+
+void MobileManager::commit_npcMovement(std::size_t const i)
+{
+    auto const& batch = m_npc_batch;
+    auto & npc = m_npc_bodies.get_or_throw(batch.ids[i]);
+
+    auto const orig_square = batch.squares[i];
+    auto const dest_square = batch.dest_squares[i];
+    auto const z_floor = batch.z_floors[i];
+
+    // Checked before anything is changed. Without collision detection the NPCs walk through the borders, but not off the map.
+    assert_feetTiles(dest_square, z_floor, GMPLSET_DETECT_COLLISIONS);
+
+    // Most of the movements don't leave the tiles already occupied.
+    if (!(TrailSystem::compute_tilesRect(orig_square) == TrailSystem::compute_tilesRect(dest_square)))
+    {
+        update_hostedMobiles(orig_square, z_floor, false);
+        update_hostedMobiles(dest_square, z_floor, true);
+    }
+
+    m_spatial_hash.move(batch.ids[i], orig_square, z_floor, dest_square, z_floor);
+    npc.set_feetPosition(dest_square.top, dest_square.left);
+
+    auto const drc = batch.directions[i];
+    m_dynamic_manager.modify(npc.sprite_id(), npc.volume(), pick_subimageSet(npc.style()).pick_subimage(drc), drc, true);
+}
+
+auto MobileManager::npcMovement_threadCount(std::size_t const npc_count) const -> unsigned
+{
+    // Below this number of NPCs per thread, waking the workers costs more than the work they do.
+    auto constexpr min_npcsPerThread = std::size_t{ 256u };
+
+    auto const setting = m_context.settings.map.npcMovement_threads;
+    auto const thread_count = setting == 0u ? std::max(std::thread::hardware_concurrency(), 1u) : setting;
+
+    return static_cast<unsigned>(std::clamp<std::size_t>(npc_count / min_npcsPerThread, 1u, thread_count));
+}
+
+void MobileManager::update_hostedMobiles(FloatRect const feet_square, int const z_floor, bool const add)
+{
+    assert_feetTiles(feet_square, z_floor, false);
+
+    auto const rect = TrailSystem::compute_tilesRect(feet_square);
+
+    for (auto x = rect.top; x <= rect.bottom(); ++x)
+    {
+        for (auto y = rect.left; y <= rect.right(); ++y)
+        {
+            if (add) { m_tiles.add_mobile({ x, y, z_floor }); }
+            else	 { m_tiles.remove_mobile({ x, y, z_floor }); }
+        }
+    }
+}
+
+void MobileManager::assert_feetTiles(FloatRect const feet_square, int const z_floor, bool const passable) const
+{
+    auto const rect = TrailSystem::compute_tilesRect(feet_square);
+
+    for (auto x = rect.top; x <= rect.bottom(); ++x)
+    {
+        for (auto y = rect.left; y <= rect.right(); ++y)
+        {
+            auto const tile = m_tiles.get(x, y, z_floor);
+            if (!tile || (passable && tile->is_impassable()))
+            {
+                auto oss = std::ostringstream{};
+                oss << "The feet of a mobile lie on the " << (tile ? "impassable" : "unexistent") << " tile " << Vector3i{ x, y, z_floor } << ".";
+                throw std::runtime_error(oss.str());
+            }
+        }
+    }
 }
 
 
@@ -180,6 +388,7 @@ void MobileManager::move_player(FloatRect const orig_square, int const orig_zFlo
         m_tiles.remove_mobile(p);
     }
 
+    m_spatial_hash.move(player_mobileId, orig_square, orig_zFloor, dest_square, dest_zFloor);
     m_player_body.set_feetPosition(dest_square.top, dest_square.left);
     m_player_body.set_zFloor(dest_zFloor);
 
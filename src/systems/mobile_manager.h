@@ -2,17 +2,25 @@
 #define GM_MOBILE_MANAGER_H
 
 
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "characters/mobile.h"
 #include "data_strctures/data_array.hh"
+#include "mediators/queues/door_ev.hh"
 #include "mediators/queues/mobile_ev.hh"
 #include "graphics/camera.hh"
 #include "graphics/dynamic_manager.hh"
 #include "graphics/mobile_subimage_set.hh"
 #include "map/buildings/building.hh"
 #include "map/map_forward_decl.hh"
+#include "map/simulation_context.hh"
 #include "map/tiles/tile_set.hh"
 #include "settings/graphics_settings.hh"
 #include "system/parallelepiped.hh"
+#include "systems/mobile_spatial_hash.hh"
 #include "systems/trail_system.hh"
 #include "utilities.hh"
 
@@ -28,15 +36,47 @@ namespace tgm
 class MobileManager
 {
     public:
-        MobileManager(MobileEventQueues & mobile_events, MobileBody & player_body, DataArray<MobileBody> & npc_bodies, Camera & camera,
-                      DynamicManager & dynamic_manager, TileSet & tiles, DataArray<Building> & buildings, DoorEventQueues & door_events);
+        MobileManager(SimulationContext & context, MobileEventQueues & mobile_events, MobileBody & player_body, DataArray<MobileBody> & npc_bodies,
+                      Camera & camera, DynamicManager & dynamic_manager, TileSet & tiles, DataArray<Building> & buildings, DoorEventQueues & door_events);
         
         void add_playerBody_to_map();
         void update();
         void move();
 
+        ////
+        //	Add a NPC to the map: it occupies the tiles under its feet and gets its own sprite. Throws if those tiles don't exist or are
+        //	impassable.
+        ////
+        auto spawn_npc(MobileBody const& body) -> MobileId;
+        void despawn_npc(MobileId const id);
+        void set_npcMoveDirection(MobileId const id, Direction const drc) { m_npc_bodies.get_or_throw(id).set_moveDirection(drc); }
+        auto npc_count() const noexcept { return m_npc_bodies.count(); }
+
+        ////
+        //	Positions of the player (as player_mobileId) and of the NPCs, for the proximity queries.
+        ////
+        auto spatial_hash() const noexcept -> MobileSpatialHash const& { return m_spatial_hash; }
+
 
     private:
+        ////
+        //	Structure-of-arrays copy of the moving NPCs, refilled at each movement. The vectors are reused, so they don't allocate
+        //	once they have grown.
+        ////
+        struct NpcMovementBatch
+        {
+            std::vector<MobileId> ids;
+            std::vector<FloatRect> squares;			// Feet squares before the movement (in units -- map reference system)
+            std::vector<int> z_floors;
+            std::vector<Direction> directions;
+            std::vector<float> velocities;
+            std::vector<FloatRect> dest_squares;	// Feet squares after the collision resolution
+
+            // For each worker, the doors reached by its NPCs (batch index, door), in increasing batch index.
+            std::vector<std::vector<std::pair<std::size_t, DoorId>>> doors_toOpen;
+        };
+
+        SimulationContext & m_context;
         MobileEventQueues & m_mobile_events;
         MobileBody & m_player_body;
         DataArray<MobileBody> & m_npc_bodies;
@@ -46,6 +86,12 @@ class MobileManager
         DataArray<Building> & m_buildings;
         DoorEventQueues & m_door_events;
 
+        MobileSpatialHash m_spatial_hash;
+
+        std::vector<DoorId> m_doors_toOpen;		// Reused by the trail system at each movement, to avoid an allocation per frame
+        std::vector<DoorId> m_deferred_doorOpenings;	// Doors that didn't fit in the full door queue, sent again at the next movement
+        NpcMovementBatch m_npc_batch;
+
         
         #if GSET_ALTERNATIVE_ASSETS
             static inline MobileSubimageSet const test_character_subimage_set{ {0.f, 432.f, 0.f, 432.f}, default_texture_dynamics };
@@ -63,6 +109,43 @@ class MobileManager
         ////
         void move_player(FloatRect const orig_square, int const orig_zPos, FloatRect const dest_square, int const dest_zPos);
 
+        ////
+        //	Move all the NPCs in three phases: (1) copy the moving NPCs in the NpcMovementBatch, (2) resolve their collisions in parallel,
+        //	on the WorkerPool of the SimulationContext, against the TileSet, which nobody changes in the meantime, (3) apply the movements,
+        //	in batch order, to the tiles, to the sprites and to the doors. The NPCs don't block each other, so the result doesn't depend on the number of threads.
+        ////
+        void move_npcs();
+
+        ////
+        //	Ask to open the door @did. If the door queue is full the request is kept and sent again at the next movement, so a mobile
+        //	never walks into a door that doesn't open.
+        ////
+        void request_doorOpening(DoorId const did);
+
+        ////
+        //	Send again the door openings that didn't fit in the door queue.
+        ////
+        void resend_deferredDoorOpenings();
+
+        ////
+        //	Resolve the collisions of the NPCs in [@first, @last) of the batch.
+        ////
+        void resolve_npcCollisions(std::size_t const first, std::size_t const last, unsigned const worker);
+
+        void commit_npcMovement(std::size_t const i);
+
+        auto npcMovement_threadCount(std::size_t const npc_count) const -> unsigned;
+
+        ////
+        //	Add (or remove, if @add is false) a mobile in every tile under @feet_square. Throws if one of them doesn't exist.
+        ////
+        void update_hostedMobiles(FloatRect const feet_square, int const z_floor, bool const add);
+
+        ////
+        //	Throw if a tile under @feet_square doesn't exist or, when @passable is true, if it's impassable.
+        ////
+        void assert_feetTiles(FloatRect const feet_square, int const z_floor, bool const passable) const;
+
 
         static auto pick_subimageSet(MobileStyle const style) -> MobileSubimageSet const&;
 };
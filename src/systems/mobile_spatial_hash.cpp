@@ -0,0 +1,147 @@
+#include "mobile_spatial_hash.hh"
+
+
+#include <stdexcept>
+
+
+namespace tgm
+{
+
+
+
+MobileSpatialHash::MobileSpatialHash(int const length, int const width, int const height, int const cell_dim) :
+    m_cell_dim{ cell_dim },
+    m_cells_x{ cell_dim > 0 ? (length + cell_dim - 1) / cell_dim : 0 },
+    m_cells_y{ cell_dim > 0 ? (width + cell_dim - 1) / cell_dim : 0 },
+    m_floors{ height }
+{
+    if (cell_dim <= 0) { throw std::runtime_error("The side of the cells of the MobileSpatialHash must be positive."); }
+
+    m_cells.resize(static_cast<std::size_t>(m_cells_x) * m_cells_y * m_floors);
+}
+
+
+void MobileSpatialHash::insert(MobileId const id, FloatRect const& feet_square, int const z_floor)
+{
+    if (z_floor < 0 || z_floor >= m_floors) { throw std::runtime_error("Cannot insert in the MobileSpatialHash a mobile lying outside the map."); }
+
+    auto const cells = compute_cellsRect(feet_square);
+
+    for (auto cx = cells.top; cx <= cells.bottom(); ++cx)
+    {
+        for (auto cy = cells.left; cy <= cells.right(); ++cy)
+        {
+            m_cells[cell_index(cx, cy, z_floor)].push_back({ id, feet_square });
+        }
+    }
+
+    ++m_size;
+}
+
+void MobileSpatialHash::remove(MobileId const id, FloatRect const& feet_square, int const z_floor)
+{
+    if (z_floor < 0 || z_floor >= m_floors) { throw std::runtime_error("Cannot remove from the MobileSpatialHash a mobile lying outside the map."); }
+
+    auto const cells = compute_cellsRect(feet_square);
+    auto found = false;
+
+    for (auto cx = cells.top; cx <= cells.bottom(); ++cx)
+    {
+        for (auto cy = cells.left; cy <= cells.right(); ++cy)
+        {
+            auto & cell = m_cells[cell_index(cx, cy, z_floor)];
+            auto const it = std::find_if(cell.begin(), cell.end(), [id](Entry const& e) { return e.id == id; });
+
+            if (it != cell.end())
+            {
+                // The order inside a cell doesn't matter
+                *it = cell.back();
+                cell.pop_back();
+                found = true;
+            }
+        }
+    }
+
+    if (!found) { throw std::runtime_error("The mobile isn't in the MobileSpatialHash at the given position."); }
+
+    --m_size;
+}
+
+void MobileSpatialHash::move(MobileId const id, FloatRect const& orig_square, int const orig_zFloor, FloatRect const& dest_square, int const dest_zFloor)
+{
+    auto const orig_cells = compute_cellsRect(orig_square);
+    auto const dest_cells = compute_cellsRect(dest_square);
+
+    // Most of the movements don't leave the cells already occupied: only the stored square has to be updated.
+    if (orig_zFloor == dest_zFloor && orig_cells.top == dest_cells.top && orig_cells.left == dest_cells.left
+        && orig_cells.length == dest_cells.length && orig_cells.width == dest_cells.width)
+    {
+        for (auto cx = orig_cells.top; cx <= orig_cells.bottom(); ++cx)
+        {
+            for (auto cy = orig_cells.left; cy <= orig_cells.right(); ++cy)
+            {
+                for (auto & e : m_cells[cell_index(cx, cy, orig_zFloor)])
+                {
+                    if (e.id == id) { e.feet_square = dest_square; break; }
+                }
+            }
+        }
+    }
+    else
+    {
+        remove(id, orig_square, orig_zFloor);
+        insert(id, dest_square, dest_zFloor);
+    }
+}
+
+
+void MobileSpatialHash::query_rect(FloatRect const& rect, int const z_floor, std::vector<MobileId> & ids) const
+{
+    for_each_inRect(rect, z_floor, [&ids](MobileId const id, FloatRect const&) { ids.push_back(id); });
+}
+
+void MobileSpatialHash::query_range(Vector2f const center, float const radius, int const z_floor, std::vector<MobileId> & ids) const
+{
+    FloatRect const bounds{ center.x - radius, center.y - radius, 2.f * radius, 2.f * radius };
+
+    for_each_inRect(bounds, z_floor, [&ids, center, radius](MobileId const id, FloatRect const& sq)
+    {
+        // Distance from the center to the nearest point of the feet square
+        auto const dx = std::max({ sq.top - center.x, 0.f, center.x - sq.bottom() });
+        auto const dy = std::max({ sq.left - center.y, 0.f, center.y - sq.right() });
+
+        if (dx * dx + dy * dy <= radius * radius) { ids.push_back(id); }
+    });
+}
+
+bool MobileSpatialHash::is_tileOccupied(Vector3i const pos) const
+{
+    if (pos.x < 0 || pos.y < 0 || pos.z < 0 || pos.x / m_cell_dim >= m_cells_x || pos.y / m_cell_dim >= m_cells_y || pos.z >= m_floors) { return false; }
+
+    // A mobile occupies the same tiles counted by Tile::hosted_mobiles, i.e. those of TrailSystem::compute_tilesRect(), so it's listed
+    // in the cell of each of them.
+    auto const& cell = m_cells[cell_index(pos.x / m_cell_dim, pos.y / m_cell_dim, pos.z)];
+
+    return std::any_of(cell.cbegin(), cell.cend(), [pos](Entry const& e)
+    {
+        auto const tiles = TrailSystem::compute_tilesRect(e.feet_square);
+        return pos.x >= tiles.top && pos.x <= tiles.bottom() && pos.y >= tiles.left && pos.y <= tiles.right();
+    });
+}
+
+
+auto MobileSpatialHash::compute_cellsRect(FloatRect const& feet_square) const noexcept -> IntRect
+{
+    auto const tiles = TrailSystem::compute_tilesRect(feet_square);
+
+    auto const top    = std::clamp(tiles.top / m_cell_dim, 0, m_cells_x - 1);
+    auto const left   = std::clamp(tiles.left / m_cell_dim, 0, m_cells_y - 1);
+    auto const bottom = std::clamp(tiles.bottom() / m_cell_dim, 0, m_cells_x - 1);
+    auto const right  = std::clamp(tiles.right() / m_cell_dim, 0, m_cells_y - 1);
+
+    return { top, left, bottom - top + 1, right - left + 1 };
+}
+
+
+
+} // namespace tgm
\ No newline at end of file
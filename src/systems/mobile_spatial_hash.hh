@@ -0,0 +1,136 @@
+#ifndef GM_MOBILE_SPATIAL_HASH_HH
+#define GM_MOBILE_SPATIAL_HASH_HH
+
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "map/map_forward_decl.hh"
+#include "system/rect.hh"
+#include "system/vector2.hh"
+#include "systems/trail_system.hh"
+
+
+namespace tgm
+{
+
+
+
+////
+//
+//	Uniform grid of the mobiles on the map. Each cell is a square of tiles of a floor and lists the mobiles whose feet square overlaps it,
+//	so the mobiles near a position are found by visiting only the few cells around it. A mobile lying on many cells is reported once
+//	per query, by the first of its cells visited, so the queries never allocate: they either call a function for each mobile or append
+//	the ids to a vector provided (and reused) by the caller.
+//	The queries can run concurrently, but not during an update.
+//
+////
+class MobileSpatialHash
+{
+    public:
+        ////
+        //	@length, @width, @height: Dimensions of the map (in tiles).
+        //	@cell_dim: Side of a cell (in tiles).
+        ////
+        MobileSpatialHash(int const length, int const width, int const height, int const cell_dim);
+
+        ////
+        //	@feet_square: (in units -- map reference system).
+        ////
+        void insert(MobileId const id, FloatRect const& feet_square, int const z_floor);
+        void remove(MobileId const id, FloatRect const& feet_square, int const z_floor);
+
+        ////
+        //	Move the mobile @id from the position where it was inserted to the new one.
+        ////
+        void move(MobileId const id, FloatRect const& orig_square, int const orig_zFloor, FloatRect const& dest_square, int const dest_zFloor);
+
+        ////
+        //	Call @f(id, feet_square) for each mobile whose feet square intersects @rect (in units -- map reference system).
+        ////
+        template <typename F>
+        void for_each_inRect(FloatRect const& rect, int const z_floor, F && f) const;
+
+        ////
+        //	Append to @ids the mobiles whose feet square intersects @rect (in units -- map reference system).
+        ////
+        void query_rect(FloatRect const& rect, int const z_floor, std::vector<MobileId> & ids) const;
+
+        ////
+        //	Append to @ids the mobiles whose feet square is at most @radius far from @center (both in units -- map reference system).
+        ////
+        void query_range(Vector2f const center, float const radius, int const z_floor, std::vector<MobileId> & ids) const;
+
+        ////
+        //	@return: True if any mobile stands on the tile @pos (in tiles -- map reference system).
+        ////
+        bool is_tileOccupied(Vector3i const pos) const;
+
+        auto size() const noexcept { return m_size; }
+
+    private:
+        struct Entry
+        {
+            MobileId id;
+            FloatRect feet_square;
+        };
+
+        int const m_cell_dim;
+        int const m_cells_x;		// Cells along x on each floor
+        int const m_cells_y;		// Cells along y on each floor
+        int const m_floors;
+
+        std::vector<std::vector<Entry>> m_cells;
+        std::size_t m_size = 0u;
+
+
+        ////
+        //	@return: The cells overlapped by @feet_square, clamped to the map (in cells).
+        ////
+        auto compute_cellsRect(FloatRect const& feet_square) const noexcept -> IntRect;
+
+        auto cell_index(int const cx, int const cy, int const z_floor) const noexcept -> std::size_t
+        {
+            return (static_cast<std::size_t>(z_floor) * m_cells_x + cx) * m_cells_y + cy;
+        }
+
+        static bool intersect(FloatRect const& lhs, FloatRect const& rhs) noexcept
+        {
+            return lhs.top < rhs.bottom() && rhs.top < lhs.bottom() && lhs.left < rhs.right() && rhs.left < lhs.right();
+        }
+};
+
+
+template <typename F>
+void MobileSpatialHash::for_each_inRect(FloatRect const& rect, int const z_floor, F && f) const
+{
+    if (z_floor < 0 || z_floor >= m_floors) { return; }
+
+    auto const query = compute_cellsRect(rect);
+
+    for (auto cx = query.top; cx <= query.bottom(); ++cx)
+    {
+        for (auto cy = query.left; cy <= query.right(); ++cy)
+        {
+            for (auto const& e : m_cells[cell_index(cx, cy, z_floor)])
+            {
+                if (!intersect(e.feet_square, rect)) { continue; }
+
+                // Report the mobile only from the first cell shared by the query and by the mobile
+                auto const cells = compute_cellsRect(e.feet_square);
+                if (cx == std::max(cells.top, query.top) && cy == std::max(cells.left, query.left))
+                {
+                    f(e.id, e.feet_square);
+                }
+            }
+        }
+    }
+}
+
+
+
+} // namespace tgm
+
+
+#endif //GM_MOBILE_SPATIAL_HASH_HH
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "trail_system_tests.hh"
+
+
+#include <array>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "debug/logger/log_streams.hh"
+
+
+namespace tgm
+{
+
+
+
+namespace TrailSystemTests
+{
+    static void check(bool const condition, std::string const& what)
+    {
+        if (!condition) { throw std::runtime_error("TrailSystem test failed: " + what); }
+    }
+
+    ////
+    //	@return: A float in [@min, @min + @range) built only from the raw numbers of @rng, so that it's the same with every standard library.
+    //	It isn't rounded to a grid, otherwise a diagonal trail would often graze the corner of a tile, where the brute steps are too coarse.
+    ////
+    static auto random_units(std::mt19937 & rng, float const min, float const range) -> float
+    {
+        return min + range * static_cast<float>(rng() >> 8u) / 16777216.f;
+    }
+
+    static bool is_passable(TileSet const& tiles, FloatRect const& square, int const z)
+    {
+        auto const rect = TrailSystem::compute_tilesRect(square);
+        for (auto x = rect.top; x <= rect.bottom(); ++x)
+        {
+            for (auto y = rect.left; y <= rect.right(); ++y)
+            {
+                auto const tile = tiles.get(x, y, z);
+                if (!tile || tile->is_impassable()) { return false; }
+            }
+        }
+
+        return true;
+    }
+
+
+    void test_nearestPosition()
+    {
+        auto constexpr z = 0;
+        auto constexpr moves = 20000;
+        auto const tolerance = 2.f * GSet::mu;	// The brute algorithm stops up to a step before, plus the rounding of its steps
+
+        auto tiles = TileSet{ 60, 60, 1, z };
+        auto rng = std::mt19937{ 42u };
+
+        //--- About 12% of walls and 10% of doors, a third of which open
+        auto door_id = DoorId{ 1u };
+        for (auto x = 0; x < tiles.length(); ++x)
+        {
+            for (auto y = 0; y < tiles.width(); ++y)
+            {
+                auto const roll = rng() % 100u;
+                if (roll >= 22u) { continue; }
+
+                tiles.build_border(x, y, z, 1u, 1u, 1u, BorderStyle::brickWall);
+                if (roll >= 12u)
+                {
+                    tiles.build_externalDoor(x, y, z, door_id++, TileType::wooden);
+                    if (rng() % 3u == 0u) { tiles.open_door({ x, y, z }); }
+                }
+            }
+        }
+
+
+        auto constexpr directions = std::array{ Direction::N, Direction::NE, Direction::E, Direction::SE, 
+                                                Direction::S, Direction::SW, Direction::W, Direction::NW };
+        auto doors = std::vector<DoorId>{};
+        auto checked = 0;
+
+        for (auto m = 0; m < moves; ++m)
+        {
+            auto const size = random_units(rng, 0.2f, 3.3f);
+            auto const orig_square = FloatRect{ random_units(rng, 3.f, 53.f), random_units(rng, 3.f, 53.f), size, size };
+            auto const drc = directions[rng() % directions.size()];
+            auto const velocity = random_units(rng, 0.05f, 5.95f);
+
+            if (!is_passable(tiles, orig_square, z)) { continue; }
+            ++checked;
+
+            auto const [trail_square, trail_doors] = TrailSystem::compute_nearestPosition(orig_square, z, drc, velocity, tiles);
+            auto const brute_square = TrailSystem::debug_brute_computeNearestPosition(orig_square, z, drc, velocity, tiles);
+
+            std::ostringstream oss;
+            oss << "orig_square: " << orig_square << ", direction: " << drc << ", velocity: " << velocity 
+                << ", trail: " << trail_square << ", brute: " << brute_square;
+
+            if (DirectionUtil::is_diagonal(drc))
+            {
+                auto const uv = DirectionUtil::planeUnitVector(drc);
+                check((trail_square.top - brute_square.top) * uv.x <= tolerance && (trail_square.left - brute_square.left) * uv.y <= tolerance,
+                      "the diagonal trail goes farther than the brute movement (" + oss.str() + ")");
+            }
+            else
+            {
+                check(std::fabs(trail_square.top - brute_square.top) <= tolerance && std::fabs(trail_square.left - brute_square.left) <= tolerance,
+                      "the straight trail doesn't end where the brute movement does (" + oss.str() + ")");
+            }
+
+            doors.clear();
+            auto const reused_square = TrailSystem::compute_nearestPosition(orig_square, z, drc, velocity, tiles, doors);
+            check(reused_square.top == trail_square.top && reused_square.left == trail_square.left && doors == trail_doors,
+                  "the two overloads of compute_nearestPosition() differ (" + oss.str() + ")");
+        }
+
+        check(checked > moves / 4, "too few squares start on passable tiles");
+
+
+        g_log << "TrailSystem tests passed." << std::endl;
+    }
+}
+
+
+
+} //namespace tgm
@@ -0,0 +1,29 @@
+#ifndef GM_TRAIL_SYSTEM_TESTS_HH
+#define GM_TRAIL_SYSTEM_TESTS_HH
+
+
+#include "systems/trail_system.hh"
+
+
+namespace tgm
+{
+
+
+
+namespace TrailSystemTests
+{
+    ////
+    //	Move random feet squares in the 8 planar directions over a TileSet with random walls and (open or closed) doors, and compare 
+    //	TrailSystem::compute_nearestPosition() with TrailSystem::debug_brute_computeNearestPosition(), which moves the square by GSet::mu 
+    //	at a time: the straight movements must end in the same position (up to the brute step), while the diagonal ones may stop earlier
+    //	but never farther. Both the overloads of compute_nearestPosition() must give the same square and the same doors.
+    ////
+    void test_nearestPosition();
+}
+
+
+
+} //namespace tgm
+
+
+#endif //GM_TRAIL_SYSTEM_TESTS_HH
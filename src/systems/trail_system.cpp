@@ -1,7 +1,10 @@
 #include "trail_system.hh"
 
 
+#include <algorithm>
+#include <cstddef>
 #include <iomanip>
+#include <memory_resource>
 
 #include "std_extensions/hash_functions.hh"
 #include "system/clock.hh"
@@ -106,47 +109,89 @@ static auto check_frontPos(FloatRect const& dest_square, int const z_pos, Direct
 
 
 ////
-//	Check, substep by substep, if the trail contains impassable tiles or non-openable doors.
+//	Buffers reused by every collision check of the same thread, so that once they have grown the checks don't allocate anymore.
+//	The front is still a hash set built anew by each check, so its tiles are visited in the same order as before, but its nodes and
+//	buckets are carved out of @front_buffer (only a front bigger than the buffer would reach the heap).
+////
+struct TrailScratch
+{
+    alignas(std::max_align_t) std::byte front_buffer[4096];
+    std::vector<std::pair<float, Vector2i>> closed_doors;	// Closed doors of the current front and the associated units backward
+};
+
+static auto trail_scratch() -> TrailScratch &
+{
+    thread_local TrailScratch scratch;
+    return scratch;
+}
+
+
+////
+//	Check, front by front, if the trail contains impassable tiles or non-openable doors. The trail is made of @beg_front shifted 
+//	by 0, 1, ..., @traversed_tiles times @unit_vector, and the positions of each front are computed on the fly.
+//	The positions of the last front that would surpass the @dest_tilesRect are skipped.
 //
+//	@doors_to_open: The ids of the closed doors reached by the trail are appended to it.
 //	@return: If there's no impassable tile return @dest_square. Otherwise return the nearest square to the first impassable tile touched by the trail.
 ////
-static auto check_trail(FloatRect const& dest_square, int const z_pos, Direction const move_drc, std::vector<std::vector<Vector2i>> const& trail, TileSet const& tiles,
-                        std::unordered_set<Vector2i> ignored_tiles, float const debug_velocity)
-    -> std::pair< FloatRect, std::vector<DoorId> >
+static auto check_trail(FloatRect const& dest_square, int const z_pos, Direction const move_drc, 
+                        std::pmr::unordered_set<Vector2i> const& beg_front, Vector2i const unit_vector, IntRect const dest_tilesRect, int const traversed_tiles,
+                        TileSet const& tiles, std::vector<DoorId> & doors_to_open, std::vector<std::pair<float, Vector2i>> & closedDoors_in_front,
+                        float const debug_velocity)
+    -> FloatRect
 {
-    std::pair< FloatRect, std::vector<DoorId> > ret;
-    auto & [adjusted_destSquare, doors_to_open] = ret;
-    adjusted_destSquare = dest_square;
+    auto adjusted_destSquare = dest_square;
 
+    // Limits of the last front: both the sides are multiplied by unit_vector, so that in case of a negative direction it's as if the 
+    // comparison became ">="
+    auto const rhX = unit_vector.x == 1 ? dest_tilesRect.bottom() : dest_tilesRect.top,
+               rhY = unit_vector.y == 1 ? dest_tilesRect.right()  : dest_tilesRect.left;
 
-    // For each "front" of the trail
-    for (auto const& front : trail)
+    #if PLAYERMOVEMENT_VISUALDEBUG
+        PMdeb.new_step("Trail");
+        std::vector<Vector2i> debug_trail;
+        for (auto i = 0; i < std::max(traversed_tiles, 1); ++i)
+        {
+            for (auto const pos : beg_front) { debug_trail.push_back(pos + i * unit_vector); }
+        }
+        PMdeb.highlight_tiles(debug_trail.cbegin(), debug_trail.cend(), z_pos, Color(75, 75, 125, 125));
+    #endif
+
+
+    // For each "front" of the trail. The first one isn't shifted, the last one is shifted by traversed_tiles (whatever its value).
+    auto const front_count = std::max(traversed_tiles, 1) + 1;
+    for (auto f = 0; f < front_count; ++f)
     {
+        auto const is_last = f == front_count - 1;
+        auto const shift = is_last ? traversed_tiles : f;
+
         auto max_unitsBackward = 0.f;
         //If there is a non-door tile that block the movement before a door can be reached, then that door mustn't be opened.
         auto max_unitsBackward_forNonDoorTile = 0.f; 
-        std::vector<std::pair<float, Vector2i>> closedDoors_in_front; //closed door and the associated units backwards
+        closedDoors_in_front.clear();
 
         // For each tile in the "front"
-        for (auto const pos : front)
+        for (auto const beg_pos : beg_front)
         {
-            // Skip if this is an ignored tile
-            if (ignored_tiles.find(pos) != ignored_tiles.cend())
+            auto const pos = beg_pos + shift * unit_vector;
+
+            // Special behavior for the last front. It must be prevented that the trail surpass the dest_tilesRect.
+            if (is_last && !(pos.x * unit_vector.x <= rhX * unit_vector.x && pos.y * unit_vector.y <= rhY * unit_vector.y))
+            {
                 continue;
+            }
 
 
             auto const [units_back, closed_door] = check_frontPos(adjusted_destSquare, z_pos, move_drc, pos, tiles);
             if (units_back != 0.f && units_back >= max_unitsBackward)
             {
                 max_unitsBackward = units_back;
-                if (!closed_door) //can't open a door farther than this position, since this impassable tile would block the movement
-                    max_unitsBackward_forNonDoorTile = units_back;			
 
 
                 #if PLAYERMOVEMENT_DEBUGLOG
                     auto debug1_adjDestSquare = DirectionUtil::compute_newRect(dest_square, DirectionUtil::invert(move_drc), units_back);
 
-                    PMlog << Logger::nltb << "Impassable tile - It'd require " << units_back << "units backward. Related adjusted_destSquare:" << debug1_adjDestSquare << std::endl;
+                    ASYNC_LOG(player_movement, "Impassable tile - It'd require {} units backward. Related adjusted_destSquare: {}", units_back, debug1_adjDestSquare);
 
                     if (units_back > debug_velocity)
                         PMlog << bug_bigNotification() << std::endl;
@@ -160,6 +205,10 @@ static auto check_trail(FloatRect const& dest_square, int const z_pos, Direction
                 #endif
             }
 
+            //can't open a door farther than this position, since this impassable tile would block the movement
+            if (!closed_door)
+                max_unitsBackward_forNonDoorTile = std::max(max_unitsBackward_forNonDoorTile, units_back);
+
             if (closed_door)
                 closedDoors_in_front.push_back({ units_back, pos });
         }
@@ -186,7 +235,7 @@ static auto check_trail(FloatRect const& dest_square, int const z_pos, Direction
             }
 
             #if PLAYERMOVEMENT_DEBUGLOG
-                PMlog << Logger::nltb << "max_unitsBackward: " << max_unitsBackward << "  -  Definitive adjusted_destSquare: " << adjusted_destSquare << std::endl;
+                ASYNC_LOG(player_movement, "max_unitsBackward: {}  -  Definitive adjusted_destSquare: {}", max_unitsBackward, adjusted_destSquare);
             #endif
 
             #if PLAYERMOVEMENT_VISUALDEBUG
@@ -209,66 +258,23 @@ static auto check_trail(FloatRect const& dest_square, int const z_pos, Direction
         PMlog << Logger::remt;
     #endif
 
-    return ret;
-}
-
-////
-//	Moves the front tracing the whole trail in @trail.
-////
-static void trace_trail(std::unordered_set<Vector2i> const& beg_front, Vector2i const unit_vector,
-                        IntRect const dest_tilesRect, int const traversed_tiles, std::vector<std::vector<Vector2i>>& trail, int const debug_zPos)
-{
-    for (int i = 1; i < traversed_tiles; ++i)
-    {
-        auto & shifted_front = trail.emplace_back();
-        for (auto const pos : beg_front)
-            shifted_front.push_back(pos + i * unit_vector);
-    }
-
-
-    // Special behavior for the last front movement. It must be prevented that the trail surpass the dest_tilesRect.
-
-    auto & last_front = trail.emplace_back();
-
-    auto const rhX = unit_vector.x == 1 ? dest_tilesRect.bottom() : dest_tilesRect.top,
-               rhY = unit_vector.y == 1 ? dest_tilesRect.right()  : dest_tilesRect.left;
-
-
-    for (auto const pos : beg_front)
-    {
-        auto const new_pos = pos + traversed_tiles * unit_vector;
-        //both the sides are multiplied by unit_vector, so that in case of a negative direction it's as if the comparison became ">="
-        if (   new_pos.x * unit_vector.x <= rhX * unit_vector.x
-            && new_pos.y * unit_vector.y <= rhY * unit_vector.y)
-        {
-            last_front.push_back(new_pos);
-        }
-    }
-
-
-    #if PLAYERMOVEMENT_DEBUGLOG
-        PMlog << Logger::nltb << "trail positions: " << trail << std::endl;
-    #endif
-    #if PLAYERMOVEMENT_VISUALDEBUG
-        PMdeb.new_step("Trail");
-        std::vector<Vector2i> debug_trail;
-        for (auto const& front : trail)
-            debug_trail.insert(debug_trail.cend(), front.cbegin(), front.cend());
-        PMdeb.highlight_tiles(debug_trail.cbegin(), debug_trail.cend(), debug_zPos, Color(75, 75, 125, 125));
-    #endif
+    return adjusted_destSquare;
 }
 
 ////
 //  Computes the set of tiles that moving will generate the entire trail. Also computes how many times the front have to move
 //	to trace the whole trail.
 //	@uv: The unit vector associated to @drc.
+//	@front: Filled with the tiles of the front (its previous content is discarded).
+//	@return: How many times the front has to move.
 ////
 static auto compute_trailFrontAndShiftings(FloatRect const& orig_square, IntRect const& orig_tilesRect, IntRect const& dest_tilesRect, 
-                                           Direction const drc, Vector2i const uv, float const velocity, int const debug_zPos)
-    -> std::pair<std::unordered_set<Vector2i>, int>
+                                           Direction const drc, Vector2i const uv, float const velocity, std::pmr::unordered_set<Vector2i> & front, 
+                                           int const debug_zPos)
+    -> int
 {
-    std::pair<std::unordered_set<Vector2i>, int> ret; //declaring it here pave the way to NRVO
-    auto & [front, traversed_tiles] = ret;
+    front.clear();
+    auto traversed_tiles = 0;
 
     // Distances of the borders of the orig_square from the respective borders of the orig_tilesRect (in units)
     auto const d_top    = orig_square.top - GSet::tiles_to_units(orig_tilesRect.top) + 0.0001f,			//Here d_top and d_left require an additional 0.0001f because otherwise
@@ -469,7 +475,7 @@ static auto compute_trailFrontAndShiftings(FloatRect const& orig_square, IntRect
         PMdeb.new_step(oss.str());
     #endif
 
-    return ret;
+    return traversed_tiles;
 }
     
 ////
@@ -521,6 +527,16 @@ namespace TrailSystem
     //TODO: Thoroughly test the trail system (especially after floatization)
     auto compute_nearestPosition(FloatRect const orig_square, int const z_pos, Direction const drc, float const velocity, TileSet const& tiles) 
         -> std::pair< FloatRect, std::vector<DoorId> >
+    {
+        std::pair< FloatRect, std::vector<DoorId> > ret;
+        ret.first = compute_nearestPosition(orig_square, z_pos, drc, velocity, tiles, ret.second);
+
+        return ret;
+    }
+
+    auto compute_nearestPosition(FloatRect const orig_square, int const z_pos, Direction const drc, float const velocity, TileSet const& tiles,
+                                 std::vector<DoorId> & doors_to_open)
+        -> FloatRect
     {
         auto const dest_square = DirectionUtil::compute_newRect(orig_square, drc, velocity);
 
@@ -553,20 +569,21 @@ namespace TrailSystem
 
 
 
-        std::vector<std::vector<Vector2i>> trail;
+        auto & scratch = trail_scratch();
+        std::pmr::monotonic_buffer_resource front_arena{ scratch.front_buffer, sizeof(scratch.front_buffer) };
+        std::pmr::unordered_set<Vector2i> front{ &front_arena };
         auto const unit_vector = DirectionUtil::planeUnitVector(drc);
 
-        auto const [front, traversed_tiles] = compute_trailFrontAndShiftings(orig_square, orig_tilesRect, dest_tilesRect, drc, unit_vector, velocity, z_pos);
-
-
-        trail.emplace_back(front.cbegin(), front.cend());
-        trace_trail(front, unit_vector, dest_tilesRect, traversed_tiles, trail, z_pos);
+        auto const traversed_tiles = compute_trailFrontAndShiftings(orig_square, orig_tilesRect, dest_tilesRect, drc, unit_vector, velocity, 
+                                                                    front, z_pos);
 
 
         #if !PLAYERMOVEMENT_DEBUGLOG && !PLAYERMOVEMENT_VISUALDEBUG
-            return check_trail(dest_square, z_pos, drc, trail, tiles, {}, velocity);
+            return check_trail(dest_square, z_pos, drc, front, unit_vector, dest_tilesRect, traversed_tiles, tiles, 
+                               doors_to_open, scratch.closed_doors, velocity);
         #else
-            auto ret = check_trail(dest_square, z_pos, drc, trail, tiles, {}, velocity);
+            auto ret = check_trail(dest_square, z_pos, drc, front, unit_vector, dest_tilesRect, traversed_tiles, tiles, 
+                                   doors_to_open, scratch.closed_doors, velocity);
 
             #if PLAYERMOVEMENT_DEBUGLOG
                 PMlog << "\n\n";
@@ -685,6 +702,11 @@ namespace TrailSystem
 
         return ret;
     }
+
+    auto compute_tilesRect(FloatRect const volume_base) noexcept -> IntRect
+    {
+        return compute_tileSquareCircumscribedToFeetSquare(volume_base);
+    }
 } // namespace TrailSystem
 
 
@@ -3,6 +3,7 @@
 
 
 #include <unordered_set>
+#include <vector>
 
 #include "map/direction.h"
 #include "map/tiles/tile_set.hh"
@@ -30,6 +31,15 @@ namespace TrailSystem
     auto compute_nearestPosition(FloatRect const orig_square, int const z_pos, Direction const drc, float const velocity, TileSet const& tiles)
         -> std::pair< FloatRect, std::vector<DoorId> >;
 
+    ////
+    //	Same as above, but the ids of the closed doors are appended to @doors_to_open. The trail is walked front by front without being 
+    //	stored, and the few buffers needed are reused by each call on the same thread, so a caller that reuses @doors_to_open doesn't 
+    //	allocate at all. It can be called concurrently from different threads.
+    ////
+    auto compute_nearestPosition(FloatRect const orig_square, int const z_pos, Direction const drc, float const velocity, TileSet const& tiles,
+                                 std::vector<DoorId> & doors_to_open)
+        -> FloatRect;
+
 
     ////
     //	Brute collision algorithm that makes a check moving feet_dim pixel by pixel. 
@@ -49,11 +59,15 @@ namespace TrailSystem
 
     inline void debug_compareMoveAlgorithms() 
     { 
-        DoorEventQueues door_evcont_mock;
-        debug_compareMoveAlgorithms(50.f, 50.f, 23, Direction::SE, TileSet{ 100, 150, 50, door_evcont_mock });
+        debug_compareMoveAlgorithms(50.f, 50.f, 23, Direction::SE, TileSet{ 100, 150, 50, 0 });
     }
     
     auto compute_tilesFromVolume(FloatRect const volume_base, int const z_pos) -> std::vector<Vector3i>;
+
+    ////
+    //	@return: The smallest rectangle of tiles containing @volume_base, i.e. the tiles returned by compute_tilesFromVolume() (in tiles -- map reference system).
+    ////
+    auto compute_tilesRect(FloatRect const volume_base) noexcept -> IntRect;
 };
 
 
@@ -0,0 +1,126 @@
+#ifndef GM_RANDOM_STREAM_HH
+#define GM_RANDOM_STREAM_HH
+
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+
+namespace tgm
+{
+
+
+
+////
+//	Independent families of streams, so that two streams derived from the same id in different contexts never coincide.
+////
+enum class RandomDomain : std::uint64_t
+{
+    building_expansion = 1u,
+    city_expansion = 2u,
+};
+
+
+////
+//
+//	Counter-based random generator (SplitMix64 finalizer applied to "key + counter"). The n-th number of a stream depends only on its key
+//	and on n, so a stream can be derived from (seed, id, step) anywhere and at any time, and the results don't depend on how many other
+//	streams were used before it, on the order of evaluation or on the number of threads.
+//	It satisfies UniformRandomBitGenerator, but bounded() and shuffle() should be preferred to the std distributions, since their
+//	results are the same with every standard library.
+//
+////
+class RandomStream
+{
+    public:
+        using result_type = std::uint64_t;
+
+        ////
+        //	@seed: Seed of the whole simulation.
+        //	@domain, @id: Entity owning the stream (e.g. the BuildingId of an expanding building).
+        //	@step: Progressive number of the operation of the entity (e.g. the expansion attempt), so that each one gets a fresh stream.
+        ////
+        RandomStream(std::uint64_t const seed, RandomDomain const domain, std::uint64_t const id, std::uint64_t const step) noexcept :
+            m_key{ combine(combine(combine(mix(seed), static_cast<std::uint64_t>(domain)), id), step) }
+        {}
+
+        static constexpr auto min() noexcept -> result_type { return std::numeric_limits<result_type>::min(); }
+        static constexpr auto max() noexcept -> result_type { return std::numeric_limits<result_type>::max(); }
+
+        auto operator()() noexcept -> result_type { return mix(m_key + (++m_counter) * golden_gamma); }
+
+        void discard(std::uint64_t const n) noexcept { m_counter += n; }
+
+        ////
+        //	@return: A child stream, independent both from this one and from the children with a different @sub_id.
+        ////
+        auto split(std::uint64_t const sub_id) const noexcept -> RandomStream { return RandomStream{ combine(m_key, sub_id) }; }
+
+        ////
+        //	@return: An unbiased number in [0, @bound) (Lemire's multiply-and-reject method on 32 bits). @bound must be positive.
+        ////
+        auto bounded(std::uint32_t const bound) noexcept -> std::uint32_t
+        {
+            auto m = std::uint64_t{ next_u32() } * bound;
+            auto low = static_cast<std::uint32_t>(m);
+
+            if (low < bound)
+            {
+                auto const threshold = static_cast<std::uint32_t>(-bound) % bound;
+                while (low < threshold)
+                {
+                    m = std::uint64_t{ next_u32() } * bound;
+                    low = static_cast<std::uint32_t>(m);
+                }
+            }
+
+            return static_cast<std::uint32_t>(m >> 32);
+        }
+
+        ////
+        //	Fisher-Yates shuffle of [@first, @last).
+        ////
+        template<typename RandomIt>
+        void shuffle(RandomIt const first, RandomIt const last) noexcept
+        {
+            auto const count = static_cast<std::uint32_t>(std::distance(first, last));
+
+            for (auto i = count; i > 1u; --i)
+            {
+                using std::swap;
+                swap(first[i - 1u], first[bounded(i)]);
+            }
+        }
+
+    private:
+        static constexpr auto golden_gamma = std::uint64_t{ 0x9E3779B97F4A7C15u };
+
+        std::uint64_t m_key;
+        std::uint64_t m_counter = 0u;
+
+
+        explicit RandomStream(std::uint64_t const key) noexcept : m_key{ key } {}
+
+        auto next_u32() noexcept -> std::uint32_t { return static_cast<std::uint32_t>((*this)() >> 32); }
+
+        static constexpr auto mix(std::uint64_t z) noexcept -> std::uint64_t
+        {
+            z = (z ^ (z >> 30)) * std::uint64_t{ 0xBF58476D1CE4E5B9u };
+            z = (z ^ (z >> 27)) * std::uint64_t{ 0x94D049BB133111EBu };
+            return z ^ (z >> 31);
+        }
+
+        static constexpr auto combine(std::uint64_t const key, std::uint64_t const value) noexcept -> std::uint64_t
+        {
+            return mix(key ^ mix(value + golden_gamma));
+        }
+};
+
+
+
+} // namespace tgm
+
+
+#endif //GM_RANDOM_STREAM_HH
\ No newline at end of file